@@ -0,0 +1,205 @@
+#include "ArrearsIndex.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include "ExistenceCache.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+ArrearsIndex& ArrearsIndex::getInstance() {
+    static ArrearsIndex instance;
+    return instance;
+}
+
+int ArrearsIndex::toMonthCode(const std::string& feeMonth) {
+    std::string trimmed = Common::trim(feeMonth);
+    int year = 0, month = 0;
+    if (trimmed.size() < 7) return 0;
+    Common::stringToInt(trimmed.substr(0, 4), year);
+    Common::stringToInt(trimmed.substr(5, 2), month);
+    return year * 100 + month;
+}
+
+ArrearsEntry ArrearsIndex::makeEntry(const std::string& studentId, const StudentArrears& arrears) {
+    ArrearsEntry entry;
+    entry.studentId = studentId;
+    entry.balanceCents = arrears.balanceCents;
+    entry.unpaidMonths = static_cast<int>(arrears.months.size());
+    if (!arrears.months.empty()) {
+        int code = arrears.months.front().monthCode;
+        std::ostringstream monthStream;
+        monthStream << code / 100 << "-" << std::setw(2) << std::setfill('0') << code % 100;
+        entry.oldestUnpaidMonth = monthStream.str();
+    }
+    return entry;
+}
+
+void ArrearsIndex::applyDue(const std::string& studentId, const std::string& dormId, const std::string& building,
+    int monthCode, int64_t cents, int count) {
+    StudentArrears& arrears = students[studentId];
+    byBalance.erase(std::make_pair(arrears.balanceCents, studentId));
+    byMonths.erase(std::make_pair(static_cast<int>(arrears.months.size()), studentId));
+
+    auto it = std::lower_bound(arrears.months.begin(), arrears.months.end(), monthCode,
+        [](const MonthDue& due, int code) { return due.monthCode < code; });
+    if (it == arrears.months.end() || it->monthCode != monthCode) {
+        it = arrears.months.insert(it, MonthDue{ monthCode, 0, 0 });
+    }
+    it->cents += cents;
+    it->count += count;
+    if (it->count <= 0) arrears.months.erase(it);
+    arrears.balanceCents += cents;
+
+    //宿舍欠费清零前一直计入首次记入的楼栋，改楼栋时整体挪动
+    DormDue& dormDue = dormOutstanding[dormId];
+    if (dormDue.cents == 0) dormDue.building = building;
+    dormDue.cents += cents;
+    buildingOutstanding[dormDue.building] += cents;
+    if (dormDue.cents == 0) dormOutstanding.erase(dormId);
+
+    if (arrears.months.empty()) {
+        students.erase(studentId);
+        return;
+    }
+    byBalance.insert(std::make_pair(arrears.balanceCents, studentId));
+    byMonths.insert(std::make_pair(static_cast<int>(arrears.months.size()), studentId));
+}
+
+int ArrearsIndex::commitChanges(const std::vector<FeeChange>& changes, const std::function<int()>& commit) {
+    //先在锁外查出楼栋，避免与存在性缓存的锁嵌套
+    std::vector<std::string> buildings;
+    buildings.reserve(changes.size());
+    for (const auto& change : changes) {
+        buildings.push_back(change.fee.payStatus == PayStatus::UNPAID
+            ? ExistenceCache::getInstance().getBuildingOfDorm(change.fee.dormId) : "");
+    }
+
+    //重建持同一把锁扫描fee表，写入期间持锁，提交的费用不会被扫描和增量重复计入
+    std::lock_guard<std::mutex> lock(indexMutex);
+    int affectedRows = commit();
+    if (affectedRows == -1 || !loaded) return affectedRows;
+    for (size_t i = 0; i < changes.size(); ++i) {
+        const Fee& fee = changes[i].fee;
+        if (fee.payStatus != PayStatus::UNPAID) continue;
+        int64_t cents = std::llround((fee.waterFee + fee.electricFee) * 100);
+        applyDue(Common::trim(fee.studentId), Common::trim(fee.dormId), buildings[i], toMonthCode(fee.feeMonth),
+            changes[i].sign * cents, changes[i].sign);
+    }
+    return affectedRows;
+}
+
+bool ArrearsIndex::ensureLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (loaded) return true;
+    }
+    return rebuild();
+}
+
+bool ArrearsIndex::rebuild() {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    students.clear();
+    byBalance.clear();
+    byMonths.clear();
+    dormOutstanding.clear();
+    buildingOutstanding.clear();
+
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT f.student_id, f.fee_month, f.total_fee, f.dorm_id, IFNULL(d.building, '') "
+        "FROM fee f LEFT JOIN dorm d ON d.dorm_id = f.dorm_id WHERE f.pay_status = 0",
+        [this](const DBRowView& row) {
+            int64_t cents = 0;
+            Common::parseCents(row.getString(2), cents);
+            applyDue(row.getString(0), row.getString(3), row.getString(4), toMonthCode(row.getString(1)), cents, 1);
+        });
+    if (rowCount < 0) return false;
+
+    loaded = true;
+    return true;
+}
+
+std::vector<ArrearsEntry> ArrearsIndex::getTopDebtors(int limit) {
+    std::vector<ArrearsEntry> resultList;
+    if (limit <= 0 || !ensureLoaded()) return resultList;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    for (const auto& item : byBalance) {
+        if (static_cast<int>(resultList.size()) >= limit) break;
+        resultList.push_back(makeEntry(item.second, students[item.second]));
+    }
+    return resultList;
+}
+
+std::vector<ArrearsEntry> ArrearsIndex::getStudentsWithUnpaidMonthsOver(int minMonths) {
+    std::vector<ArrearsEntry> resultList;
+    if (!ensureLoaded()) return resultList;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    for (const auto& item : byMonths) {
+        if (item.first <= minMonths) break;
+        resultList.push_back(makeEntry(item.second, students[item.second]));
+    }
+    return resultList;
+}
+
+std::map<std::string, int64_t> ArrearsIndex::getOutstandingByBuilding() {
+    std::map<std::string, int64_t> resultMap;
+    if (!ensureLoaded()) return resultMap;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    for (const auto& item : buildingOutstanding) {
+        if (item.second != 0) resultMap.insert(item);
+    }
+    return resultMap;
+}
+
+void ArrearsIndex::onDormBuildingChanged(const std::string& dormId, const std::string& building) {
+    std::string trimmedId = Common::trim(dormId);
+    std::string trimmedBuilding = Common::trim(building);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    auto it = dormOutstanding.find(trimmedId);
+    if (it == dormOutstanding.end() || it->second.building == trimmedBuilding) return;
+    buildingOutstanding[it->second.building] -= it->second.cents;
+    buildingOutstanding[trimmedBuilding] += it->second.cents;
+    it->second.building = trimmedBuilding;
+}
+
+bool ArrearsIndex::getStudentArrears(const std::string& studentId, ArrearsEntry& entry) {
+    if (!ensureLoaded()) return false;
+
+    std::string trimmedId = Common::trim(studentId);
+    std::lock_guard<std::mutex> lock(indexMutex);
+    auto it = students.find(trimmedId);
+    if (it == students.end()) return false;
+    entry = makeEntry(trimmedId, it->second);
+    return true;
+}
+
+void ArrearsIndex::exportArrears(const std::function<void(const ArrearsEntry&)>& onEntry) {
+    if (!ensureLoaded()) return;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    for (const auto& item : byBalance) {
+        onEntry(makeEntry(item.second, students[item.second]));
+    }
+}
+
+bool ArrearsIndex::exportCsv(const std::string& filePath, TextEncoding encoding) {
+    std::ofstream file(filePath, std::ios::binary);
+    if (!file.is_open()) return false;
+
+    {
+        TranscodeWriter writer(file, encoding);
+        writer.writeBom();
+        writer << "student_id,balance,oldest_unpaid_month,unpaid_months\r\n";
+        exportArrears([&writer](const ArrearsEntry& entry) {
+            writer << entry.studentId << "," << Common::centsToString(entry.balanceCents) << ","
+                << entry.oldestUnpaidMonth << "," << entry.unpaidMonths << "\r\n";
+        });
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,110 @@
+#ifndef ARREARSINDEX_H
+#define ARREARSINDEX_H
+
+#include "FeeRollup.h"
+#include "Transcode.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+
+// 一名学生的欠费情况
+struct ArrearsEntry {
+    std::string studentId;          // 学号
+    int64_t balanceCents;           // 未缴总额（分）
+    std::string oldestUnpaidMonth;  // 最早未缴月份（YYYY-MM）
+    int unpaidMonths;               // 未缴月份数
+
+    ArrearsEntry() : balanceCents(0), unpaidMonths(0) {}
+};
+
+// --------------- 学生欠费索引（单例）---------------
+// 每名学生只保存按月份排序的未缴金额，另按欠费金额、未缴月数各维护一个有序集合，
+// "欠费最多的前N名""未缴超过k个月"只需遍历结果本身；楼栋欠费总额增量维护。
+// 由FeeManager的写操作在提交时同步更新，宿舍改楼栋时由DormManager通知。
+class ArrearsIndex {
+public:
+    static ArrearsIndex& getInstance();
+
+    // 持索引锁执行commit（费用写入，返回影响行数，-1失败），成功后应用费用变化（只统计未缴记录）；
+    // 与重建互斥，返回commit的结果
+    int commitChanges(const std::vector<FeeChange>& changes, const std::function<int()>& commit);
+
+    // 欠费金额最多的前limit名学生
+    std::vector<ArrearsEntry> getTopDebtors(int limit);
+
+    // 未缴月份数大于minMonths的学生（按未缴月数从多到少）
+    std::vector<ArrearsEntry> getStudentsWithUnpaidMonthsOver(int minMonths);
+
+    // 各楼栋欠费总额（分）
+    std::map<std::string, int64_t> getOutstandingByBuilding();
+
+    // 宿舍改楼栋后把该宿舍的欠费挪到新楼栋
+    void onDormBuildingChanged(const std::string& dormId, const std::string& building);
+
+    // 查询单个学生，无欠费返回false
+    bool getStudentArrears(const std::string& studentId, ArrearsEntry& entry);
+
+    // 按欠费金额从高到低逐条输出全部欠费记录（回调期间持有索引锁，回调内不可再调用本类）
+    void exportArrears(const std::function<void(const ArrearsEntry&)>& onEntry);
+
+    // 导出为CSV文件（encoding为UTF8时转码并写BOM）
+    bool exportCsv(const std::string& filePath, TextEncoding encoding = TextEncoding::GBK);
+
+    // 首次使用时加载
+    bool ensureLoaded();
+
+    // 从fee表重建
+    bool rebuild();
+
+private:
+    ArrearsIndex() : loaded(false) {}
+    ArrearsIndex(const ArrearsIndex&) = delete;
+    ArrearsIndex& operator=(const ArrearsIndex&) = delete;
+
+    // 某月未缴
+    struct MonthDue {
+        int monthCode;   // 年*100+月
+        int64_t cents;   // 未缴金额
+        int count;       // 未缴记录数
+    };
+
+    // 一名学生的未缴明细（按月份排序）
+    struct StudentArrears {
+        int64_t balanceCents;
+        std::vector<MonthDue> months;
+
+        StudentArrears() : balanceCents(0) {}
+    };
+
+    std::mutex indexMutex;
+    std::unordered_map<std::string, StudentArrears> students;
+    std::set<std::pair<int64_t, std::string>, std::greater<std::pair<int64_t, std::string>>> byBalance;
+    std::set<std::pair<int, std::string>, std::greater<std::pair<int, std::string>>> byMonths;
+    // 一间宿舍的欠费及其计入的楼栋
+    struct DormDue {
+        std::string building;
+        int64_t cents;
+
+        DormDue() : cents(0) {}
+    };
+
+    std::unordered_map<std::string, DormDue> dormOutstanding;   // 宿舍号 → 欠费，改楼栋时据此挪动楼栋总额
+    std::map<std::string, int64_t> buildingOutstanding;
+    bool loaded;
+
+    // 记一笔未缴变化（已持有indexMutex）
+    void applyDue(const std::string& studentId, const std::string& dormId, const std::string& building,
+        int monthCode, int64_t cents, int count);
+
+    // 生成对外结果（已持有indexMutex）
+    static ArrearsEntry makeEntry(const std::string& studentId, const StudentArrears& arrears);
+
+    static int toMonthCode(const std::string& feeMonth);
+};
+
+#endif // ARREARSINDEX_H
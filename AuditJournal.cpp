@@ -0,0 +1,514 @@
+#include "AuditJournal.h"
+#include <chrono>
+#include <cstring>
+#include <ctime>
+
+#if defined(_MSC_VER)
+#include <io.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+static const char AUDIT_MAGIC[8] = { 'D', 'M', 'S', 'A', 'U', 'D', 'I', 'T' };
+static const uint32_t AUDIT_VERSION = 1;
+static const size_t AUDIT_FILE_HEADER = 12;         // 魔数 + 版本号
+static const size_t AUDIT_RECORD_HEADER = 8;        // 长度 + CRC32
+static const size_t AUDIT_FIXED_PAYLOAD = 20;       // 序号、时间、操作、实体、字段数
+static const size_t AUDIT_SEQUENCE_OFFSET = AUDIT_RECORD_HEADER;
+static const size_t AUDIT_COUNT_OFFSET = AUDIT_RECORD_HEADER + 18;
+static const uint32_t AUDIT_MAX_RECORD = 16u * 1024 * 1024;
+static const size_t AUDIT_BATCH_BYTES = 64 * 1024;  // 缓冲区达到该大小时立即写出
+
+//CRC32（IEEE 802.3多项式）
+static uint32_t crc32(const char* data, size_t len) {
+    static const struct Table {
+        uint32_t entries[256];
+        Table() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; ++k) c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                entries[i] = c;
+            }
+        }
+    } table;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i) {
+        crc = table.entries[(crc ^ static_cast<unsigned char>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+//小端序读写
+static inline void putU16(std::string& out, uint16_t v) {
+    out += static_cast<char>(v & 0xFF);
+    out += static_cast<char>(v >> 8);
+}
+
+static inline void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+static inline void putU64(std::string& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out += static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+static inline void patchU16(std::string& out, size_t pos, uint16_t v) {
+    out[pos] = static_cast<char>(v & 0xFF);
+    out[pos + 1] = static_cast<char>(v >> 8);
+}
+
+static inline void patchU32(std::string& out, size_t pos, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out[pos + i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+static inline void patchU64(std::string& out, size_t pos, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out[pos + i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+}
+
+//字符串：2字节长度 + 内容，超长部分截断
+static inline void putStr(std::string& out, const char* data, size_t len) {
+    if (len > 0xFFFF) len = 0xFFFF;
+    putU16(out, static_cast<uint16_t>(len));
+    out.append(data, len);
+}
+
+static inline void putStr(std::string& out, const std::string& str) {
+    putStr(out, str.data(), str.size());
+}
+
+//按顺序解析记录内容，越界时ok置为false
+struct PayloadReader {
+    const unsigned char* p;
+    size_t len;
+    size_t pos;
+    bool ok;
+
+    PayloadReader(const char* data, size_t size)
+        : p(reinterpret_cast<const unsigned char*>(data)), len(size), pos(0), ok(true) {}
+
+    uint64_t readUInt(int bytes) {
+        if (!ok || pos + bytes > len) {
+            ok = false;
+            return 0;
+        }
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; ++i) v |= static_cast<uint64_t>(p[pos + i]) << (8 * i);
+        pos += bytes;
+        return v;
+    }
+
+    std::string readStr() {
+        size_t n = static_cast<size_t>(readUInt(2));
+        if (!ok || pos + n > len) {
+            ok = false;
+            return std::string();
+        }
+        std::string s(reinterpret_cast<const char*>(p + pos), n);
+        pos += n;
+        return s;
+    }
+};
+
+static bool decodeRecord(const char* data, size_t len, AuditRecord& record) {
+    PayloadReader reader(data, len);
+    record.sequence = reader.readUInt(8);
+    record.timestampMs = static_cast<int64_t>(reader.readUInt(8));
+    record.op = static_cast<AuditOp>(reader.readUInt(1));
+    record.entity = static_cast<AuditEntity>(reader.readUInt(1));
+    size_t fieldCount = static_cast<size_t>(reader.readUInt(2));
+    record.entityId = reader.readStr();
+    record.adminId = reader.readStr();
+    record.fields.clear();
+    for (size_t i = 0; i < fieldCount && reader.ok; ++i) {
+        AuditField field;
+        field.name = reader.readStr();
+        field.before = reader.readStr();
+        field.after = reader.readStr();
+        record.fields.push_back(std::move(field));
+    }
+    return reader.ok && reader.pos == len;
+}
+
+//逐条读取已打开的日志文件；validEnd返回最后一条完整记录之后的位置，lastSequence返回最大序号
+static bool scanJournal(std::FILE* fp, const std::function<void(const AuditRecord&)>* onRecord,
+    std::string& error, long& validEnd, uint64_t& lastSequence) {
+    validEnd = 0;
+    lastSequence = 0;
+    std::fseek(fp, 0, SEEK_END);
+    long fileSize = std::ftell(fp);
+    std::fseek(fp, 0, SEEK_SET);
+    if (fileSize <= 0) return true;
+
+    char header[AUDIT_FILE_HEADER];
+    if (std::fread(header, 1, sizeof(header), fp) != sizeof(header)) {
+        error = "审计日志文件头不完整";
+        return false;
+    }
+    uint32_t version = 0;
+    for (int i = 0; i < 4; ++i) version |= static_cast<uint32_t>(static_cast<unsigned char>(header[8 + i])) << (8 * i);
+    if (std::memcmp(header, AUDIT_MAGIC, sizeof(AUDIT_MAGIC)) != 0 || version != AUDIT_VERSION) {
+        error = "不是审计日志文件或版本不支持";
+        return false;
+    }
+    validEnd = static_cast<long>(AUDIT_FILE_HEADER);
+
+    std::string payload;
+    AuditRecord record;
+    while (true) {
+        unsigned char head[AUDIT_RECORD_HEADER];
+        size_t got = std::fread(head, 1, sizeof(head), fp);
+        if (got < sizeof(head)) break;      //文件结束或末尾记录头不完整
+        uint32_t len = 0, crc = 0;
+        for (int i = 0; i < 4; ++i) {
+            len |= static_cast<uint32_t>(head[i]) << (8 * i);
+            crc |= static_cast<uint32_t>(head[4 + i]) << (8 * i);
+        }
+        if (len == 0) break;                //异常断电后文件末尾可能是补零的块
+        if (len < AUDIT_FIXED_PAYLOAD || len > AUDIT_MAX_RECORD) {
+            error = "审计日志记录长度异常，位置" + std::to_string(validEnd);
+            return false;
+        }
+        if (validEnd + static_cast<long>(AUDIT_RECORD_HEADER + len) > fileSize) break;     //末尾记录不完整
+        payload.resize(len);
+        if (std::fread(&payload[0], 1, len, fp) != len) break;
+        bool atEnd = validEnd + static_cast<long>(AUDIT_RECORD_HEADER + len) == fileSize;
+        if (crc32(payload.data(), len) != crc || !decodeRecord(payload.data(), len, record)) {
+            if (atEnd) break;               //末尾写了一半
+            error = "审计日志记录校验失败，位置" + std::to_string(validEnd);
+            return false;
+        }
+        validEnd += static_cast<long>(AUDIT_RECORD_HEADER + len);
+        if (record.sequence > lastSequence) lastSequence = record.sequence;
+        if (onRecord) (*onRecord)(record);
+    }
+    return true;
+}
+
+//把缓冲区写入系统并同步到磁盘
+static bool syncFile(std::FILE* fp) {
+    if (std::fflush(fp) != 0) return false;
+#if defined(_MSC_VER)
+    return _commit(_fileno(fp)) == 0;
+#elif defined(__unix__) || defined(__APPLE__)
+    return fsync(fileno(fp)) == 0;
+#else
+    return true;
+#endif
+}
+
+static bool truncateFile(std::FILE* fp, long size) {
+#if defined(_MSC_VER)
+    return _chsize_s(_fileno(fp), size) == 0;
+#elif defined(__unix__) || defined(__APPLE__)
+    return ftruncate(fileno(fp), static_cast<off_t>(size)) == 0;
+#else
+    (void)fp;
+    (void)size;
+    return false;
+#endif
+}
+
+static int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+AuditJournal& AuditJournal::getInstance() {
+    static AuditJournal instance;
+    return instance;
+}
+
+AuditJournal::AuditJournal() : running(false), nextSequence(1), stopRequested(false), file(nullptr), groupCommitMs(5) {
+}
+
+AuditJournal::~AuditJournal() {
+    stop();
+}
+
+bool AuditJournal::start(const std::string& path, int groupCommitMs) {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (running) return true;
+
+    //检查已有文件：接续序号，截掉上次异常退出时写了一半的记录
+    long validEnd = 0;
+    uint64_t lastSequence = 0;
+    std::FILE* fp = std::fopen(path.c_str(), "r+b");
+    if (fp) {
+        std::string error;
+        if (!scanJournal(fp, nullptr, error, validEnd, lastSequence)) {
+            std::fclose(fp);
+            lastError = error;
+            return false;
+        }
+        std::fseek(fp, 0, SEEK_END);
+        long fileSize = std::ftell(fp);
+        if (validEnd < fileSize && !truncateFile(fp, validEnd)) {
+            std::fclose(fp);
+            lastError = "无法截断审计日志末尾的不完整记录";
+            return false;
+        }
+        std::fclose(fp);
+    }
+
+    fp = std::fopen(path.c_str(), "ab");
+    if (!fp) {
+        lastError = "无法打开审计日志文件：" + path;
+        return false;
+    }
+    if (validEnd == 0) {
+        std::string header(AUDIT_MAGIC, sizeof(AUDIT_MAGIC));
+        putU32(header, AUDIT_VERSION);
+        if (std::fwrite(header.data(), 1, header.size(), fp) != header.size() || !syncFile(fp)) {
+            std::fclose(fp);
+            lastError = "写入审计日志文件头失败";
+            return false;
+        }
+    }
+
+    file = fp;
+    this->groupCommitMs = groupCommitMs > 0 ? groupCommitMs : 1;
+    nextSequence = lastSequence + 1;
+    stopRequested = false;
+    pending.clear();
+    pending.reserve(AUDIT_BATCH_BYTES * 2);
+    running = true;
+    writer = std::thread(&AuditJournal::writerLoop, this);
+    return true;
+}
+
+void AuditJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (!running) return;
+        running = false;
+        stopRequested = true;
+    }
+    bufferCv.notify_all();
+    if (writer.joinable()) writer.join();
+
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+    durableCv.notify_all();
+}
+
+void AuditJournal::setAdmin(const std::string& adminId) {
+    std::lock_guard<std::mutex> lock(adminMutex);
+    this->adminId = adminId;
+}
+
+void AuditJournal::beginRecord(std::string& record, AuditOp op, AuditEntity entity, const std::string& entityId) {
+    record.clear();
+    putU32(record, 0);          //长度，提交时回填
+    putU32(record, 0);          //CRC32，提交时回填
+    putU64(record, 0);          //序号，提交时回填
+    putU64(record, static_cast<uint64_t>(nowMs()));
+    record += static_cast<char>(op);
+    record += static_cast<char>(entity);
+    putU16(record, 0);          //字段数，提交时回填
+    putStr(record, entityId);
+    std::lock_guard<std::mutex> lock(adminMutex);
+    putStr(record, adminId);
+}
+
+void AuditJournal::commitRecord(std::string& record, size_t fieldCount) {
+    size_t payloadLen = record.size() - AUDIT_RECORD_HEADER;
+    patchU16(record, AUDIT_COUNT_OFFSET, static_cast<uint16_t>(fieldCount));
+    patchU32(record, 0, static_cast<uint32_t>(payloadLen));
+
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        if (!running) return;
+        //序号在锁内分配，多线程写入时文件中也按序号排列
+        patchU64(record, AUDIT_SEQUENCE_OFFSET, nextSequence++);
+        patchU32(record, 4, crc32(record.data() + AUDIT_RECORD_HEADER, payloadLen));
+        //只在新一批的第一条和缓冲区满时唤醒写线程
+        wake = pending.empty() || pending.size() + record.size() >= AUDIT_BATCH_BYTES;
+        pending.append(record);
+        ++stats.records;
+    }
+    if (wake) bufferCv.notify_one();
+}
+
+//每个线程复用一个序列化缓冲区，写路径上不分配内存
+static std::string& scratchRecord() {
+    static thread_local std::string buffer;
+    return buffer;
+}
+
+void AuditJournal::recordInsert(AuditEntity entity, const std::string& entityId, const AuditValues& after) {
+    if (!running) return;
+    std::string& record = scratchRecord();
+    beginRecord(record, AuditOp::INSERT, entity, entityId);
+    size_t count = 0;
+    for (const auto& value : after) {
+        if (value.second.empty()) continue;
+        putStr(record, value.first, std::strlen(value.first));
+        putStr(record, "", 0);
+        putStr(record, value.second);
+        ++count;
+    }
+    commitRecord(record, count);
+}
+
+void AuditJournal::recordUpdate(AuditEntity entity, const std::string& entityId, const AuditValues& before, const AuditValues& after) {
+    recordChanges(AuditOp::UPDATE, entity, entityId, before, after);
+}
+
+void AuditJournal::recordStatus(AuditEntity entity, const std::string& entityId, const AuditValues& before, const AuditValues& after) {
+    recordChanges(AuditOp::STATUS, entity, entityId, before, after);
+}
+
+void AuditJournal::recordChanges(AuditOp op, AuditEntity entity, const std::string& entityId, const AuditValues& before, const AuditValues& after) {
+    if (!running) return;
+    std::string& record = scratchRecord();
+    beginRecord(record, op, entity, entityId);
+    //before与after由同一函数生成，字段顺序一致
+    size_t count = 0;
+    size_t n = before.size() < after.size() ? before.size() : after.size();
+    for (size_t i = 0; i < n; ++i) {
+        if (before[i].second == after[i].second) continue;
+        putStr(record, after[i].first, std::strlen(after[i].first));
+        putStr(record, before[i].second);
+        putStr(record, after[i].second);
+        ++count;
+    }
+    commitRecord(record, count);
+}
+
+void AuditJournal::recordRemove(AuditEntity entity, const std::string& entityId, const AuditValues& before) {
+    if (!running) return;
+    std::string& record = scratchRecord();
+    beginRecord(record, AuditOp::REMOVE, entity, entityId);
+    size_t count = 0;
+    for (const auto& value : before) {
+        if (value.second.empty()) continue;
+        putStr(record, value.first, std::strlen(value.first));
+        putStr(record, value.second);
+        putStr(record, "", 0);
+        ++count;
+    }
+    commitRecord(record, count);
+}
+
+void AuditJournal::writerLoop() {
+    std::string batch;
+    batch.reserve(AUDIT_BATCH_BYTES * 2);
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    while (true) {
+        bufferCv.wait(lock, [this] { return stopRequested || !pending.empty(); });
+        if (pending.empty()) break;
+        //成组提交：等一小段时间让同一批的记录一起落盘
+        if (!stopRequested && pending.size() < AUDIT_BATCH_BYTES) {
+            bufferCv.wait_for(lock, std::chrono::milliseconds(groupCommitMs),
+                [this] { return stopRequested || pending.size() >= AUDIT_BATCH_BYTES; });
+        }
+        batch.swap(pending);
+        uint64_t target = stats.records;
+        lock.unlock();
+
+        bool ok = std::fwrite(batch.data(), 1, batch.size(), file) == batch.size() && syncFile(file);
+
+        lock.lock();
+        if (ok) {
+            stats.bytes += batch.size();
+        }
+        else {
+            ++stats.writeErrors;
+            lastError = "写入审计日志失败";
+        }
+        ++stats.batches;
+        stats.durableRecords = target;
+        batch.clear();
+        durableCv.notify_all();
+    }
+}
+
+bool AuditJournal::flush(int timeoutMs) {
+    std::unique_lock<std::mutex> lock(bufferMutex);
+    uint64_t target = stats.records;
+    uint64_t errors = stats.writeErrors;
+    if (running) bufferCv.notify_one();
+    bool done = durableCv.wait_for(lock, std::chrono::milliseconds(timeoutMs),
+        [this, target] { return stats.durableRecords >= target || !running; });
+    return done && stats.durableRecords >= target && stats.writeErrors == errors;
+}
+
+AuditStats AuditJournal::getStats() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return stats;
+}
+
+std::string AuditJournal::getLastError() {
+    std::lock_guard<std::mutex> lock(bufferMutex);
+    return lastError;
+}
+
+bool AuditJournal::readJournal(const std::string& path, const std::function<void(const AuditRecord&)>& onRecord, std::string& error) {
+    std::FILE* fp = std::fopen(path.c_str(), "rb");
+    if (!fp) {
+        error = "无法打开审计日志文件：" + path;
+        return false;
+    }
+    long validEnd = 0;
+    uint64_t lastSequence = 0;
+    bool ok = scanJournal(fp, &onRecord, error, validEnd, lastSequence);
+    std::fclose(fp);
+    return ok;
+}
+
+const char* AuditJournal::opName(AuditOp op) {
+    switch (op) {
+    case AuditOp::INSERT: return "新增";
+    case AuditOp::UPDATE: return "修改";
+    case AuditOp::REMOVE: return "删除";
+    case AuditOp::STATUS: return "状态";
+    }
+    return "未知";
+}
+
+const char* AuditJournal::entityName(AuditEntity entity) {
+    switch (entity) {
+    case AuditEntity::STUDENT: return "学生";
+    case AuditEntity::DORM: return "宿舍";
+    case AuditEntity::FEE: return "费用";
+    case AuditEntity::REPAIR: return "报修";
+    case AuditEntity::VISITOR: return "访客";
+    case AuditEntity::BLACKLIST: return "黑名单";
+    }
+    return "未知";
+}
+
+std::string AuditJournal::formatRecord(const AuditRecord& record) {
+    std::time_t seconds = static_cast<std::time_t>(record.timestampMs / 1000);
+    std::tm tm_at;
+    std::memset(&tm_at, 0, sizeof(tm_at));
+#if defined(_MSC_VER)
+    localtime_s(&tm_at, &seconds);
+#elif defined(__unix__) || defined(__APPLE__)
+    localtime_r(&seconds, &tm_at);
+#else
+    std::tm* p = std::localtime(&seconds);
+    if (p) tm_at = *p;
+#endif
+    char stamp[64];
+    std::snprintf(stamp, sizeof(stamp), "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+        tm_at.tm_year + 1900, tm_at.tm_mon + 1, tm_at.tm_mday,
+        tm_at.tm_hour, tm_at.tm_min, tm_at.tm_sec, static_cast<int>(record.timestampMs % 1000));
+
+    std::string line = "#" + std::to_string(record.sequence) + " " + stamp + " ";
+    line += record.adminId.empty() ? "-" : record.adminId;
+    line += " ";
+    line += opName(record.op);
+    line += entityName(record.entity);
+    line += " " + record.entityId;
+    for (const auto& field : record.fields) {
+        line += " " + field.name + "=";
+        if (record.op == AuditOp::UPDATE || record.op == AuditOp::STATUS) line += field.before + "->" + field.after;
+        else line += record.op == AuditOp::REMOVE ? field.before : field.after;
+    }
+    return line;
+}
@@ -0,0 +1,145 @@
+#ifndef AUDITJOURNAL_H
+#define AUDITJOURNAL_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+
+// 审计日志默认文件（程序目录下）
+const char* const AUDIT_DEFAULT_PATH = "audit.log";
+
+// 操作类型
+enum class AuditOp : uint8_t {
+    INSERT = 1,     // 新增
+    UPDATE = 2,     // 修改
+    REMOVE = 3,     // 删除
+    STATUS = 4      // 状态变更（缴费、报修处理、访客离开等）
+};
+
+// 实体类型
+enum class AuditEntity : uint8_t {
+    STUDENT = 1,
+    DORM = 2,
+    FEE = 3,
+    REPAIR = 4,
+    VISITOR = 5,
+    BLACKLIST = 6
+};
+
+// 一个字段的修改前后值（新增时before为空，删除时after为空）
+struct AuditField {
+    std::string name;
+    std::string before;
+    std::string after;
+};
+
+// 读出的一条审计记录
+struct AuditRecord {
+    uint64_t sequence;          // 序号（重启后接着文件中最后一条继续递增）
+    int64_t timestampMs;        // 记录时间（自1970-01-01起的毫秒数）
+    AuditOp op;
+    AuditEntity entity;
+    std::string entityId;       // 主键
+    std::string adminId;        // 操作的管理员（未登录时为空）
+    std::vector<AuditField> fields;
+
+    AuditRecord() : sequence(0), timestampMs(0), op(AuditOp::INSERT), entity(AuditEntity::STUDENT) {}
+};
+
+// 实体的字段名和值，由各管理类生成
+typedef std::vector<std::pair<const char*, std::string>> AuditValues;
+
+// 运行统计
+struct AuditStats {
+    uint64_t records;           // 已追加的记录数
+    uint64_t durableRecords;    // 已落盘的记录数
+    uint64_t batches;           // 成组提交次数（每次一次fsync）
+    uint64_t bytes;             // 已写入字节数
+    uint64_t writeErrors;       // 写入或同步失败次数
+
+    AuditStats() : records(0), durableRecords(0), batches(0), bytes(0), writeErrors(0) {}
+};
+
+// --------------- 审计日志（单例）---------------
+// 只追加的二进制日志：文件头"DMSAUDIT"+版本号，之后每条记录为[长度][CRC32][内容]。
+// 写路径只在调用线程序列化记录并追加到内存缓冲区；后台线程每隔几毫秒（或缓冲区较大时立即）
+// 把缓冲区一次写入文件并fsync，多条记录共用一次同步。文件末尾写了一半的记录在读取时忽略，
+// 下次启动时截掉。
+class AuditJournal {
+public:
+    static AuditJournal& getInstance();
+
+    // 打开日志文件并启动后台写线程；groupCommitMs为成组提交的最长等待时间
+    bool start(const std::string& path = AUDIT_DEFAULT_PATH, int groupCommitMs = 5);
+
+    // 写出剩余记录并停止后台线程
+    void stop();
+
+    // 登录成功后设置当前管理员，之后的记录都带上该账号
+    void setAdmin(const std::string& adminId);
+
+    // 记录新增、删除（跳过空字段）、修改和状态变更（只记录变化的字段）；未启动时忽略
+    void recordInsert(AuditEntity entity, const std::string& entityId, const AuditValues& after);
+    void recordUpdate(AuditEntity entity, const std::string& entityId, const AuditValues& before, const AuditValues& after);
+    void recordRemove(AuditEntity entity, const std::string& entityId, const AuditValues& before);
+    void recordStatus(AuditEntity entity, const std::string& entityId, const AuditValues& before, const AuditValues& after);
+
+    // 等待此前追加的记录全部落盘，超时返回false
+    bool flush(int timeoutMs = 2000);
+
+    AuditStats getStats();
+    std::string getLastError();
+
+    // 读取日志文件，逐条回调；遇到损坏的记录返回false并写入error（末尾未写完的记录不算错误）
+    static bool readJournal(const std::string& path, const std::function<void(const AuditRecord&)>& onRecord, std::string& error);
+
+    // 一条记录的文本形式（用于导出和查看）
+    static std::string formatRecord(const AuditRecord& record);
+
+    static const char* opName(AuditOp op);
+    static const char* entityName(AuditEntity entity);
+
+private:
+    AuditJournal();
+    ~AuditJournal();
+    AuditJournal(const AuditJournal&) = delete;
+    AuditJournal& operator=(const AuditJournal&) = delete;
+
+    // 写入记录头（序号和字段数先占位，由commitRecord回填）
+    void beginRecord(std::string& record, AuditOp op, AuditEntity entity, const std::string& entityId);
+
+    // 回填序号、字段数、长度和校验后放入缓冲区
+    void commitRecord(std::string& record, size_t fieldCount);
+
+    // 修改和状态变更：比较前后值，写入变化的字段
+    void recordChanges(AuditOp op, AuditEntity entity, const std::string& entityId, const AuditValues& before, const AuditValues& after);
+
+    void writerLoop();
+
+    std::atomic<bool> running;
+
+    std::mutex adminMutex;
+    std::string adminId;
+
+    std::mutex bufferMutex;
+    std::condition_variable bufferCv;       // 唤醒写线程
+    std::condition_variable durableCv;      // 通知flush等待者
+    std::string pending;                    // 待写入的记录
+    uint64_t nextSequence;                  // 在缓冲区锁内分配，文件中的记录按序号排列
+    bool stopRequested;
+
+    std::thread writer;
+    std::FILE* file;
+    int groupCommitMs;
+    AuditStats stats;
+    std::string lastError;
+};
+
+#endif // AUDITJOURNAL_H
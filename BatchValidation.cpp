@@ -0,0 +1,214 @@
+#include "BatchValidation.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BATCH_VALIDATION_SSE2 1
+#include <emmintrin.h>
+#endif
+
+//与std::isspace在"C"区域设置下一致
+static inline bool isSpace(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool isAsciiLetter(unsigned char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+//去掉首尾空白（不复制）
+static inline StrRef trimRef(const StrRef& str) {
+    const char* begin = str.data;
+    const char* end = str.data + str.size;
+    while (begin < end && isSpace(static_cast<unsigned char>(*begin))) ++begin;
+    while (end > begin && isSpace(static_cast<unsigned char>(end[-1]))) --end;
+    return StrRef(begin, static_cast<size_t>(end - begin));
+}
+
+//定长字段复制到32字节对齐缓冲区，末尾补0，便于整块加载
+struct FieldBuffer {
+#if defined(_MSC_VER)
+    __declspec(align(16)) unsigned char bytes[32];
+#else
+    unsigned char bytes[32] __attribute__((aligned(16)));
+#endif
+
+    explicit FieldBuffer(const StrRef& field) {
+        std::memset(bytes, 0, sizeof(bytes));
+        std::memcpy(bytes, field.data, field.size < sizeof(bytes) ? field.size : sizeof(bytes));
+    }
+};
+
+//缓冲区中各字节是否为数字，第i位对应第i个字节
+static inline uint32_t digitMask(const FieldBuffer& buf) {
+#ifdef BATCH_VALIDATION_SSE2
+    const __m128i below = _mm_set1_epi8('0' - 1);
+    const __m128i above = _mm_set1_epi8('9' + 1);
+    __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(buf.bytes));
+    __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(buf.bytes + 16));
+    //有符号比较：0x80以上的字节为负数，不会落入数字区间
+    __m128i digitLo = _mm_and_si128(_mm_cmpgt_epi8(lo, below), _mm_cmplt_epi8(lo, above));
+    __m128i digitHi = _mm_and_si128(_mm_cmpgt_epi8(hi, below), _mm_cmplt_epi8(hi, above));
+    return static_cast<uint32_t>(_mm_movemask_epi8(digitLo)) | (static_cast<uint32_t>(_mm_movemask_epi8(digitHi)) << 16);
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < 32; ++i) {
+        if (buf.bytes[i] >= '0' && buf.bytes[i] <= '9') mask |= 1u << i;
+    }
+    return mask;
+#endif
+}
+
+//身份证前17位加权和（GB 11643，权重为2^(17-i) mod 11）
+static inline int idCardWeightedSum(const FieldBuffer& buf) {
+#ifdef BATCH_VALIDATION_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    __m128i digits = _mm_sub_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(buf.bytes)), _mm_set1_epi8('0'));
+    __m128i lo = _mm_unpacklo_epi8(digits, zero);
+    __m128i hi = _mm_unpackhi_epi8(digits, zero);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(lo, _mm_setr_epi16(7, 9, 10, 5, 8, 4, 2, 1)),
+                                _mm_madd_epi16(hi, _mm_setr_epi16(6, 3, 7, 9, 10, 5, 8, 4)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum) + (buf.bytes[16] - '0') * 2;
+#else
+    static const int weights[17] = { 7, 9, 10, 5, 8, 4, 2, 1, 6, 3, 7, 9, 10, 5, 8, 4, 2 };
+    int sum = 0;
+    for (int i = 0; i < 17; ++i) sum += (buf.bytes[i] - '0') * weights[i];
+    return sum;
+#endif
+}
+
+//对每行执行判断，结果写入位图
+template <typename Check>
+static void runColumn(const StrRef* column, size_t count, RowBitmap& bitmap, Check check) {
+    bitmap.assign((count + 63) / 64, 0);
+    for (size_t word = 0; word * 64 < count; ++word) {
+        uint64_t bits = 0;
+        size_t end = (word + 1) * 64 < count ? (word + 1) * 64 : count;
+        for (size_t row = word * 64; row < end; ++row) {
+            if (check(column[row])) bits |= 1ull << (row - word * 64);
+        }
+        bitmap[word] = bits;
+    }
+}
+
+static inline bool checkStudentId(const StrRef& raw) {
+    StrRef field = trimRef(raw);
+    if (field.size != 7) return false;
+    FieldBuffer buf(field);
+    if ((digitMask(buf) & 0x7F) != 0x7F) return false;
+    int year = (buf.bytes[0] - '0') * 1000 + (buf.bytes[1] - '0') * 100 + (buf.bytes[2] - '0') * 10 + (buf.bytes[3] - '0');
+    return year >= 2020 && year <= 2030;
+}
+
+static inline bool checkPhone(const StrRef& raw) {
+    StrRef field = trimRef(raw);
+    if (field.size != 11) return false;
+    FieldBuffer buf(field);
+    if ((digitMask(buf) & 0x7FF) != 0x7FF) return false;
+    unsigned char second = buf.bytes[1];
+    return buf.bytes[0] == '1' && (second == '3' || second == '4' || second == '5' || second == '7' || second == '8' || second == '9');
+}
+
+static inline bool checkIDCard(const StrRef& raw, bool verifyChecksum) {
+    StrRef field = trimRef(raw);
+    if (field.size != 18) return false;
+    FieldBuffer buf(field);
+    if ((digitMask(buf) & 0x1FFFF) != 0x1FFFF) return false;
+    unsigned char last = buf.bytes[17];
+    if (!(last >= '0' && last <= '9') && last != 'X' && last != 'x') return false;
+    if (!verifyChecksum) return true;
+
+    static const char checkCodes[] = "10X98765432";
+    char expected = checkCodes[idCardWeightedSum(buf) % 11];
+    return (last == 'x' ? 'X' : static_cast<char>(last)) == expected;
+}
+
+static inline bool checkName(const StrRef& raw) {
+    StrRef field = trimRef(raw);
+    if (field.size < 2 || field.size > 20) return false;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(field.data);
+    for (size_t i = 0; i < field.size; i++) {
+        unsigned char uc = p[i];
+        if (isAsciiLetter(uc)) continue;
+        //GB2312汉字：首字节A1~F7，次字节A1~FE
+        if (uc >= 0xA1 && uc <= 0xF7 && i + 1 < field.size && p[i + 1] >= 0xA1 && p[i + 1] <= 0xFE) {
+            i++;
+            continue;
+        }
+        return false;
+    }
+    return true;
+}
+
+static inline bool checkDate(const StrRef& raw) {
+    //参考实现比较的是未去空白的原串，必须恰好是YYYY-MM-DD
+    if (raw.size != 10) return false;
+    FieldBuffer buf(raw);
+    if ((digitMask(buf) & 0x3FF) != 0x36F || buf.bytes[4] != '-' || buf.bytes[7] != '-') return false;
+    int year = (buf.bytes[0] - '0') * 1000 + (buf.bytes[1] - '0') * 100 + (buf.bytes[2] - '0') * 10 + (buf.bytes[3] - '0');
+    int month = (buf.bytes[5] - '0') * 10 + (buf.bytes[6] - '0');
+    int day = (buf.bytes[8] - '0') * 10 + (buf.bytes[9] - '0');
+    if (year < 2000 || year > 2100 || month < 1 || month > 12 || day < 1 || day > 31) return false;
+    if ((month == 4 || month == 6 || month == 9 || month == 11) && day > 30) return false;
+    if (month == 2) {
+        bool isLeap = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
+        if (day > (isLeap ? 29 : 28)) return false;
+    }
+    return true;
+}
+
+namespace BatchValidation {
+
+void validateStudentIds(const StrRef* column, size_t count, RowBitmap& bitmap) {
+    runColumn(column, count, bitmap, checkStudentId);
+}
+
+void validatePhones(const StrRef* column, size_t count, RowBitmap& bitmap, bool allowEmpty) {
+    runColumn(column, count, bitmap, [allowEmpty](const StrRef& raw) {
+        if (allowEmpty && trimRef(raw).size == 0) return true;
+        return checkPhone(raw);
+    });
+}
+
+void validateIDCards(const StrRef* column, size_t count, RowBitmap& bitmap, bool verifyChecksum) {
+    runColumn(column, count, bitmap, [verifyChecksum](const StrRef& raw) {
+        return checkIDCard(raw, verifyChecksum);
+    });
+}
+
+void validateNames(const StrRef* column, size_t count, RowBitmap& bitmap) {
+    runColumn(column, count, bitmap, checkName);
+}
+
+void validateDates(const StrRef* column, size_t count, RowBitmap& bitmap) {
+    runColumn(column, count, bitmap, checkDate);
+}
+
+void intersect(RowBitmap& dest, const RowBitmap& other) {
+    size_t n = dest.size() < other.size() ? dest.size() : other.size();
+    for (size_t i = 0; i < n; ++i) dest[i] &= other[i];
+    for (size_t i = n; i < dest.size(); ++i) dest[i] = 0;
+}
+
+size_t firstInvalid(const RowBitmap& bitmap, size_t count) {
+    for (size_t word = 0; word < bitmap.size(); ++word) {
+        uint64_t invalid = ~bitmap[word];
+        if (invalid == 0) continue;
+        size_t bit = 0;
+        while (((invalid >> bit) & 1) == 0) ++bit;
+        size_t row = word * 64 + bit;
+        return row < count ? row : count;
+    }
+    return count;
+}
+
+size_t countValid(const RowBitmap& bitmap, size_t count) {
+    size_t total = 0;
+    for (size_t row = 0; row < count; ++row) {
+        if (isValid(bitmap, row)) ++total;
+    }
+    return total;
+}
+
+}
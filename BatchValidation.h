@@ -0,0 +1,57 @@
+#ifndef BATCHVALIDATION_H
+#define BATCHVALIDATION_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+// 字符串引用（不拥有数据，引用的字符串在校验期间必须有效）
+struct StrRef {
+    const char* data;
+    size_t size;
+
+    StrRef() : data(""), size(0) {}
+    StrRef(const char* d, size_t n) : data(d), size(n) {}
+    StrRef(const std::string& str) : data(str.data()), size(str.size()) {}
+};
+
+// 行位图：第i行合法时第(i % 64)位为1（位于第i / 64个字）
+typedef std::vector<uint64_t> RowBitmap;
+
+// --------------- 批量格式校验 ---------------
+// 对一列字符串做与Common::isValidXxx完全相同的判断，结果写入行位图；
+// 首尾空白的跳过和长度检查不分配内存，定长字段的数字位检查和身份证校验码使用SSE2。
+// Common中的逐个校验函数保留为参考实现。
+namespace BatchValidation {
+    // 与Common::isValidStudentID一致
+    void validateStudentIds(const StrRef* column, size_t count, RowBitmap& bitmap);
+
+    // 与Common::isValidPhone一致；allowEmpty为true时空白串也视为合法（手机号选填）
+    void validatePhones(const StrRef* column, size_t count, RowBitmap& bitmap, bool allowEmpty = false);
+
+    // 与Common::isValidIDCard一致；verifyChecksum为true时还要求通过GB 11643校验码
+    void validateIDCards(const StrRef* column, size_t count, RowBitmap& bitmap, bool verifyChecksum = false);
+
+    // 与Common::isValidName一致（GB2312汉字或字母）
+    void validateNames(const StrRef* column, size_t count, RowBitmap& bitmap);
+
+    // 与Common::isValidDate一致（YYYY-MM-DD）
+    void validateDates(const StrRef* column, size_t count, RowBitmap& bitmap);
+
+    // 两个位图按位与（结果写入dest）
+    void intersect(RowBitmap& dest, const RowBitmap& other);
+
+    // 某行是否合法
+    inline bool isValid(const RowBitmap& bitmap, size_t row) {
+        return (bitmap[row / 64] >> (row % 64)) & 1;
+    }
+
+    // 第一个不合法的行号，全部合法返回count
+    size_t firstInvalid(const RowBitmap& bitmap, size_t count);
+
+    // 合法行数
+    size_t countValid(const RowBitmap& bitmap, size_t count);
+}
+
+#endif // BATCHVALIDATION_H
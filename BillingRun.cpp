@@ -0,0 +1,137 @@
+#include "BillingRun.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <sstream>
+#include <thread>
+
+//每个事务写入的费用记录数
+static const size_t BILLING_CHUNK_SIZE = 1000;
+
+bool BillingRun::ensureTable() {
+    std::string sql =
+        "CREATE TABLE IF NOT EXISTS billing_run ("
+        "fee_month VARCHAR(7) NOT NULL PRIMARY KEY, "
+        "total_count INT NOT NULL DEFAULT 0, "
+        "done_count INT NOT NULL DEFAULT 0, "
+        "finished TINYINT NOT NULL DEFAULT 0, "
+        "updated_at DATETIME NULL)";
+    if (DBHelper::getInstance().executeUpdate(sql) == -1) {
+        lastError = "创建出账检查点表失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+    return true;
+}
+
+//按分计算均摊，余下的分依次加给前几位住户
+void BillingRun::billDorm(const DormOccupants& dorm, const BillingParams& params,
+    const std::unordered_set<std::string>& billed, std::vector<Fee>& fees) {
+    long long count = static_cast<long long>(dorm.studentIds.size());
+    if (count == 0) return;
+    long long waterCents = std::llround(params.dormWaterFee * 100);
+    long long electricCents = std::llround(params.dormElectricFee * 100);
+
+    for (long long i = 0; i < count; ++i) {
+        const std::string& studentId = dorm.studentIds[static_cast<size_t>(i)];
+        if (billed.count(studentId)) continue;
+
+        long long water = waterCents / count + (i < waterCents % count ? 1 : 0);
+        long long electric = electricCents / count + (i < electricCents % count ? 1 : 0);
+        fees.push_back(Fee("", studentId, dorm.dormId, params.feeMonth, water / 100.0, electric / 100.0));
+    }
+}
+
+bool BillingRun::run(const BillingParams& params, const BillingProgressCallback& onProgress) {
+    lastError.clear();
+    createdCount = 0;
+    skippedCount = 0;
+
+    BillingParams runParams = params;
+    runParams.feeMonth = Common::trim(params.feeMonth);
+    if (!Common::isValidFeeMonth(runParams.feeMonth)) {
+        lastError = "费用月份格式不正确，应为YYYY-MM格式";
+        return false;
+    }
+    if (runParams.dormWaterFee < 0.0 || runParams.dormElectricFee < 0.0) {
+        lastError = "费用金额不能为负数";
+        return false;
+    }
+    if (!ensureTable()) return false;
+
+    //1. 一次扫描在住学生（按宿舍排序，便于分组）
+    std::vector<DormOccupants> dorms;
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT student_id, dorm_id FROM student WHERE dorm_id IS NOT NULL AND dorm_id <> '' "
+        "ORDER BY dorm_id, student_id",
+        [&dorms](const DBRowView& row) {
+            std::string dormId = row.getString(1);
+            if (dorms.empty() || dorms.back().dormId != dormId) {
+                dorms.push_back(DormOccupants());
+                dorms.back().dormId = dormId;
+            }
+            dorms.back().studentIds.push_back(row.getString(0));
+        });
+    if (rowCount < 0) {
+        lastError = "读取在住学生失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    //2. 一次集合查询取出已出账学生（断点续跑时跳过）
+    FeeManager feeMgr;
+    std::unordered_set<std::string> billed;
+    if (!feeMgr.getBilledStudents(runParams.feeMonth, billed)) {
+        lastError = feeMgr.getLastError();
+        return false;
+    }
+
+    //3. 多线程按宿舍计算费用，结果按宿舍顺序保存
+    std::vector<std::vector<Fee>> feesOfDorm(dorms.size());
+    int threadCount = runParams.threadCount > 0 ? runParams.threadCount
+        : static_cast<int>(std::thread::hardware_concurrency());
+    if (threadCount < 1) threadCount = 1;
+    threadCount = std::min(threadCount, std::max(1, static_cast<int>(dorms.size())));
+
+    std::atomic<size_t> nextDorm(0);
+    auto worker = [&]() {
+        for (size_t i = nextDorm.fetch_add(1); i < dorms.size(); i = nextDorm.fetch_add(1)) {
+            billDorm(dorms[i], runParams, billed, feesOfDorm[i]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threadCount; ++i) workers.emplace_back(worker);
+    worker();
+    for (auto& t : workers) t.join();
+
+    std::vector<Fee> fees;
+    for (auto& list : feesOfDorm) {
+        fees.insert(fees.end(), list.begin(), list.end());
+    }
+    skippedCount = static_cast<int>(rowCount) - static_cast<int>(fees.size());
+    int total = static_cast<int>(rowCount);
+    if (onProgress) onProgress(skippedCount, total);
+
+    //4. 分块写入，每块与检查点在同一事务内提交（没有新记录时也写一次检查点）
+    size_t chunkCount = std::max<size_t>(1, (fees.size() + BILLING_CHUNK_SIZE - 1) / BILLING_CHUNK_SIZE);
+    for (size_t c = 0; c < chunkCount; ++c) {
+        size_t begin = c * BILLING_CHUNK_SIZE;
+        size_t end = std::min(fees.size(), begin + BILLING_CHUNK_SIZE);
+        std::vector<Fee> chunk(fees.begin() + begin, fees.begin() + end);
+        int done = skippedCount + static_cast<int>(end);
+
+        std::ostringstream checkpoint;
+        checkpoint << "INSERT INTO billing_run (fee_month, total_count, done_count, finished, updated_at) VALUES ('"
+            << runParams.feeMonth << "', " << total << ", " << done << ", " << (end == fees.size() ? 1 : 0) << ", NOW()) "
+            << "ON DUPLICATE KEY UPDATE total_count = VALUES(total_count), done_count = VALUES(done_count), "
+            << "finished = VALUES(finished), updated_at = VALUES(updated_at)";
+
+        if (!feeMgr.addFeesBulk(chunk, std::vector<std::string>(1, checkpoint.str()))) {
+            lastError = feeMgr.getLastError() + "（已完成" + std::to_string(createdCount) + "条，重新运行可继续）";
+            return false;
+        }
+        createdCount += static_cast<int>(chunk.size());
+        if (onProgress) onProgress(done, total);
+    }
+    return true;
+}
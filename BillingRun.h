@@ -0,0 +1,58 @@
+#ifndef BILLINGRUN_H
+#define BILLINGRUN_H
+
+#include "FeeManager.h"
+#include <string>
+#include <vector>
+#include <functional>
+
+// 月度出账参数
+struct BillingParams {
+    std::string feeMonth;   // 费用月份（YYYY-MM）
+    double dormWaterFee;    // 每间宿舍本月水费（由住户均摊）
+    double dormElectricFee; // 每间宿舍本月电费（由住户均摊）
+    int threadCount;        // 计算线程数，0表示按CPU核数
+
+    BillingParams() : dormWaterFee(0.0), dormElectricFee(0.0), threadCount(0) {}
+};
+
+// 进度回调：已完成学生数、需出账学生总数
+typedef std::function<void(int done, int total)> BillingProgressCallback;
+
+// --------------- 月度批量出账 ---------------
+// 一次扫描在住学生、一次集合查询去重，多线程计算各宿舍费用，
+// 按块在事务内批量写入并记录检查点；中断后重新运行会跳过已出账学生继续完成。
+class BillingRun {
+public:
+    // 执行出账（返回true成功）
+    bool run(const BillingParams& params, const BillingProgressCallback& onProgress = BillingProgressCallback());
+
+    // 本次新生成的记录数
+    int getCreatedCount() const { return createdCount; }
+
+    // 因已出账而跳过的学生数
+    int getSkippedCount() const { return skippedCount; }
+
+    // 获取最近一次错误信息
+    std::string getLastError() const { return lastError; }
+
+private:
+    std::string lastError;
+    int createdCount = 0;
+    int skippedCount = 0;
+
+    // 一间宿舍的住户
+    struct DormOccupants {
+        std::string dormId;
+        std::vector<std::string> studentIds; // 全部住户（含已出账的，保证均摊金额一致）
+    };
+
+    // 确保检查点表存在
+    bool ensureTable();
+
+    // 计算一间宿舍中未出账住户的费用
+    static void billDorm(const DormOccupants& dorm, const BillingParams& params,
+        const std::unordered_set<std::string>& billed, std::vector<Fee>& fees);
+};
+
+#endif // BILLINGRUN_H
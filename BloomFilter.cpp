@@ -0,0 +1,60 @@
+#include "BloomFilter.h"
+#include <algorithm>
+
+//最小位数组大小，避免元素很少时误判率过高
+static const size_t BLOOM_MIN_BITS = 1 << 12;
+
+BloomFilter::BloomFilter(size_t expectedCount, int bitsPerKeyValue)
+    : bitCount(0), hashCount(0), bitsPerKey(bitsPerKeyValue < 1 ? 1 : bitsPerKeyValue), keyCount(0) {
+    reset(expectedCount);
+}
+
+void BloomFilter::reset(size_t expectedCount) {
+    bitCount = std::max(BLOOM_MIN_BITS, expectedCount * static_cast<size_t>(bitsPerKey));
+    bitCount = (bitCount + 63) / 64 * 64;
+    bits.assign(bitCount / 64, 0);
+
+    //最优哈希个数 k = bitsPerKey * ln2
+    hashCount = static_cast<int>(bitsPerKey * 0.69);
+    if (hashCount < 1) hashCount = 1;
+    if (hashCount > 16) hashCount = 16;
+    keyCount = 0;
+}
+
+void BloomFilter::hashPair(const std::string& key, uint64_t& h1, uint64_t& h2) {
+    //FNV-1a
+    uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : key) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    h1 = h;
+
+    //对h1再做一次混合得到第二个独立哈希
+    uint64_t x = h ^ (h >> 33);
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    h2 = x | 1;
+}
+
+void BloomFilter::add(const std::string& key) {
+    uint64_t h1, h2;
+    hashPair(key, h1, h2);
+    for (int i = 0; i < hashCount; ++i) {
+        uint64_t pos = (h1 + static_cast<uint64_t>(i) * h2) % bitCount;
+        bits[pos >> 6] |= (1ull << (pos & 63));
+    }
+    ++keyCount;
+}
+
+bool BloomFilter::mayContain(const std::string& key) const {
+    uint64_t h1, h2;
+    hashPair(key, h1, h2);
+    for (int i = 0; i < hashCount; ++i) {
+        uint64_t pos = (h1 + static_cast<uint64_t>(i) * h2) % bitCount;
+        if ((bits[pos >> 6] & (1ull << (pos & 63))) == 0) return false;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// --------------- 布隆过滤器（判定"一定不存在"，不支持删除）---------------
+class BloomFilter {
+public:
+    // expectedCount：预计元素数量；bitsPerKey：每个元素占用的位数（约10位对应1%误判率）
+    explicit BloomFilter(size_t expectedCount = 1024, int bitsPerKey = 10);
+
+    // 按新的预计数量重新分配并清空
+    void reset(size_t expectedCount);
+
+    // 加入一个键
+    void add(const std::string& key);
+
+    // 可能存在返回true；返回false表示一定不存在
+    bool mayContain(const std::string& key) const;
+
+    // 当前已加入的键数量
+    size_t size() const { return keyCount; }
+
+private:
+    std::vector<uint64_t> bits; // 位数组
+    size_t bitCount;            // 位数
+    int hashCount;              // 哈希函数个数
+    int bitsPerKey;             // 每个元素的位数
+    size_t keyCount;            // 已加入的键数量
+
+    // 计算两个基础哈希值（双重哈希派生出hashCount个位置）
+    static void hashPair(const std::string& key, uint64_t& h1, uint64_t& h2);
+};
+
+#endif // BLOOMFILTER_H
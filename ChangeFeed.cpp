@@ -0,0 +1,283 @@
+#include "ChangeFeed.h"
+#include <chrono>
+#include <cstring>
+
+const size_t ChangeFeed::CAPACITY;
+const size_t ChangeFeed::MAX_SUBSCRIBERS;
+
+static const uint64_t SLOT_MASK = ChangeFeed::CAPACITY - 1;
+static const size_t PUBLISH_CHUNK = ChangeFeed::CAPACITY / 2;  // 一次分配的序号数上限，避免单批占满缓冲区
+
+const ChangeColumn* ChangeEvent::find(const char* name) const {
+    for (const ChangeColumn& column : columns) {
+        if (column.name == name || std::strcmp(column.name, name) == 0) return &column;
+    }
+    return nullptr;
+}
+
+const std::string& ChangeEvent::value(const char* name) const {
+    static const std::string empty;
+    const ChangeColumn* column = find(name);
+    return column ? column->value : empty;
+}
+
+bool ChangeEvent::isChanged(const char* name) const {
+    const ChangeColumn* column = find(name);
+    return column != nullptr && column->changed;
+}
+
+ChangeFeed& ChangeFeed::getInstance() {
+    static ChangeFeed instance;
+    return instance;
+}
+
+ChangeFeed::ChangeFeed()
+    : slots(new Slot[CAPACITY]), claimed(0), stalls(0), stallMicros(0), subscriberCount(0),
+      hasBackground(false), dispatcherIdle(false), running(false) {
+    for (size_t i = 0; i < CAPACITY; ++i) slots[i].stamp.store(0);
+    for (Subscriber& sub : subscribers) {
+        sub.delivery = ChangeDelivery::INLINE;
+        sub.start = 0;
+        sub.cursor.store(0);
+        sub.applied.store(0);
+        sub.maxLag.store(0);
+    }
+}
+
+ChangeFeed::~ChangeFeed() {
+    stop();
+}
+
+bool ChangeFeed::subscribe(const char* name, ChangeDelivery delivery, ChangeHandler onEvent, ChangeBatchEnd onBatchEnd) {
+    std::lock_guard<std::mutex> lock(subscribeMutex);
+    size_t index = subscriberCount.load();
+    if (index >= MAX_SUBSCRIBERS || !onEvent) return false;
+
+    Subscriber& sub = subscribers[index];
+    sub.name = name;
+    sub.delivery = delivery;
+    sub.onEvent = std::move(onEvent);
+    sub.onBatchEnd = std::move(onBatchEnd);
+    sub.start = claimed.load();
+    sub.cursor.store(sub.start);
+    sub.applied.store(sub.start);
+    sub.maxLag.store(0);
+    if (delivery == ChangeDelivery::BACKGROUND) hasBackground = true;
+    //订阅者初始化完成后才对发布方可见
+    subscriberCount.store(index + 1);
+    return true;
+}
+
+void ChangeFeed::start() {
+    std::lock_guard<std::mutex> lock(dispatchMutex);
+    if (running) return;
+    running = true;
+    dispatcher = std::thread(&ChangeFeed::dispatchLoop, this);
+}
+
+void ChangeFeed::stop() {
+    {
+        std::lock_guard<std::mutex> lock(dispatchMutex);
+        if (!running) return;
+        running = false;
+    }
+    dispatchCv.notify_all();
+    if (dispatcher.joinable()) dispatcher.join();
+
+    //处理剩余积压
+    size_t count = subscriberCount.load();
+    for (size_t i = 0; i < count; ++i) {
+        std::lock_guard<std::mutex> lock(subscribers[i].drainMutex);
+        drain(subscribers[i], UINT64_MAX);
+    }
+}
+
+ChangeEvent ChangeFeed::makeInsert(ChangeTable table, const std::string& key, const ChangeValues& values) {
+    ChangeEvent event;
+    event.kind = ChangeKind::INSERT;
+    event.table = table;
+    event.key = key;
+    event.columns.reserve(values.size());
+    for (const auto& value : values) {
+        event.columns.push_back(ChangeColumn{ value.first, value.second, std::string(), true });
+    }
+    return event;
+}
+
+void ChangeFeed::publishInsert(ChangeTable table, const std::string& key, const ChangeValues& values) {
+    std::vector<ChangeEvent> events(1, makeInsert(table, key, values));
+    publish(events);
+}
+
+void ChangeFeed::publishUpdate(ChangeTable table, const std::string& key, const ChangeValues& before, const ChangeValues& after) {
+    //before与after由同一函数生成，列顺序一致
+    ChangeEvent event;
+    event.kind = ChangeKind::UPDATE;
+    event.table = table;
+    event.key = key;
+    event.columns.reserve(after.size());
+    bool anyChanged = false;
+    for (size_t i = 0; i < after.size(); ++i) {
+        const std::string& previous = i < before.size() ? before[i].second : after[i].second;
+        bool changed = previous != after[i].second;
+        anyChanged = anyChanged || changed;
+        event.columns.push_back(ChangeColumn{ after[i].first, after[i].second, previous, changed });
+    }
+    if (!anyChanged) return;
+    std::vector<ChangeEvent> events(1, std::move(event));
+    publish(events);
+}
+
+void ChangeFeed::publishRemove(ChangeTable table, const std::string& key, const ChangeValues& values) {
+    std::vector<ChangeEvent> events(1, makeInsert(table, key, values));
+    events[0].kind = ChangeKind::REMOVE;
+    publish(events);
+}
+
+void ChangeFeed::publish(std::vector<ChangeEvent>& events) {
+    for (size_t begin = 0; begin < events.size(); begin += PUBLISH_CHUNK) {
+        size_t count = events.size() - begin < PUBLISH_CHUNK ? events.size() - begin : PUBLISH_CHUNK;
+        uint64_t last = publishRange(&events[begin], count);
+
+        //INLINE订阅者处理完本批再返回，调用方之后读到的缓存和计数已包含这次写入
+        size_t subCount = subscriberCount.load();
+        for (size_t i = 0; i < subCount; ++i) {
+            if (subscribers[i].delivery == ChangeDelivery::INLINE) drainUntil(subscribers[i], last);
+        }
+        if (hasBackground) notifyDispatcher();
+    }
+}
+
+uint64_t ChangeFeed::publishRange(ChangeEvent* events, size_t count) {
+    uint64_t first = claimed.fetch_add(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t sequence = first + i;
+        waitForSlot(sequence);
+        Slot& slot = slots[sequence & SLOT_MASK];
+        slot.event = std::move(events[i]);
+        slot.event.sequence = sequence;
+        slot.stamp.store(sequence + 1, std::memory_order_release);
+    }
+    return first + count - 1;
+}
+
+void ChangeFeed::waitForSlot(uint64_t sequence) {
+    if (sequence < CAPACITY) return;   //第一轮，槽位从未使用
+
+    uint64_t previous = sequence - CAPACITY;
+    Slot& slot = slots[sequence & SLOT_MASK];
+    auto ready = [&]() {
+        if (slot.stamp.load(std::memory_order_acquire) != previous + 1) return false;
+        size_t subCount = subscriberCount.load();
+        for (size_t i = 0; i < subCount; ++i) {
+            if (subscribers[i].cursor.load(std::memory_order_acquire) <= previous) return false;
+        }
+        return true;
+    };
+    if (ready()) return;
+
+    //背压：协助处理落后的订阅者（拿不到处理权说明已有线程在处理）
+    stalls.fetch_add(1);
+    auto begin = std::chrono::steady_clock::now();
+    while (!ready()) {
+        size_t subCount = subscriberCount.load();
+        for (size_t i = 0; i < subCount; ++i) {
+            Subscriber& sub = subscribers[i];
+            if (sub.cursor.load(std::memory_order_acquire) > previous) continue;
+            if (sub.drainMutex.try_lock()) {
+                drain(sub, sequence - 1);
+                sub.drainMutex.unlock();
+            }
+        }
+        if (hasBackground) notifyDispatcher();
+        std::this_thread::yield();
+    }
+    stallMicros.fetch_add(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - begin).count()));
+}
+
+size_t ChangeFeed::drain(Subscriber& sub, uint64_t limit) {
+    uint64_t cursor = sub.cursor.load(std::memory_order_relaxed);
+    uint64_t frontier = claimed.load();
+    if (frontier > cursor && frontier - cursor > sub.maxLag.load(std::memory_order_relaxed)) {
+        sub.maxLag.store(frontier - cursor, std::memory_order_relaxed);
+    }
+
+    size_t handled = 0;
+    while (cursor <= limit) {
+        Slot& slot = slots[cursor & SLOT_MASK];
+        if (slot.stamp.load(std::memory_order_acquire) != cursor + 1) break;   //尚未发布
+        sub.onEvent(slot.event);
+        ++cursor;
+        ++handled;
+        sub.cursor.store(cursor, std::memory_order_release);
+    }
+    if (handled > 0 && sub.onBatchEnd) sub.onBatchEnd();
+    sub.applied.store(cursor, std::memory_order_release);
+    return handled;
+}
+
+void ChangeFeed::drainUntil(Subscriber& sub, uint64_t sequence) {
+    while (sub.applied.load(std::memory_order_acquire) <= sequence) {
+        if (sub.drainMutex.try_lock()) {
+            drain(sub, sequence);
+            sub.drainMutex.unlock();
+        }
+        else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ChangeFeed::notifyDispatcher() {
+    if (!dispatcherIdle.load()) return;
+    std::lock_guard<std::mutex> lock(dispatchMutex);
+    dispatchCv.notify_one();
+}
+
+void ChangeFeed::dispatchLoop() {
+    std::unique_lock<std::mutex> lock(dispatchMutex);
+    while (running) {
+        lock.unlock();
+        size_t handled = 0;
+        size_t subCount = subscriberCount.load();
+        for (size_t i = 0; i < subCount; ++i) {
+            Subscriber& sub = subscribers[i];
+            if (sub.delivery != ChangeDelivery::BACKGROUND) continue;
+            std::lock_guard<std::mutex> drainLock(sub.drainMutex);
+            handled += drain(sub, UINT64_MAX);
+        }
+        lock.lock();
+        if (handled > 0) continue;
+
+        //先标记空闲再检查积压，发布方看到空闲标记后会加锁唤醒，不会丢失通知
+        dispatcherIdle = true;
+        bool pending = false;
+        for (size_t i = 0; i < subCount; ++i) {
+            if (subscribers[i].delivery == ChangeDelivery::BACKGROUND && subscribers[i].cursor.load() < claimed.load()) pending = true;
+        }
+        if (!pending && running) dispatchCv.wait_for(lock, std::chrono::milliseconds(50));
+        dispatcherIdle = false;
+    }
+}
+
+ChangeFeedStats ChangeFeed::getStats() {
+    ChangeFeedStats stats;
+    stats.capacity = CAPACITY;
+    stats.published = claimed.load();
+    stats.producerStalls = stalls.load();
+    stats.stallMicros = stallMicros.load();
+    size_t subCount = subscriberCount.load();
+    for (size_t i = 0; i < subCount; ++i) {
+        const Subscriber& sub = subscribers[i];
+        ChangeSubscriberStats item;
+        item.name = sub.name;
+        item.delivery = sub.delivery;
+        uint64_t cursor = sub.cursor.load();
+        item.consumed = cursor - sub.start;
+        item.lag = stats.published > cursor ? stats.published - cursor : 0;
+        item.maxLag = sub.maxLag.load();
+        stats.subscribers.push_back(item);
+    }
+    return stats;
+}
@@ -0,0 +1,182 @@
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+// 变更所属的表
+enum class ChangeTable : uint8_t {
+    STUDENT = 0,
+    DORM,
+    FEE,
+    REPAIR,
+    VISITOR,
+    BLACKLIST,
+    COUNT
+};
+
+// 变更类型
+enum class ChangeKind : uint8_t {
+    INSERT = 0,
+    UPDATE,
+    REMOVE
+};
+
+// 一行的列名和值，由各管理类生成（列名为静态字符串）
+typedef std::vector<std::pair<const char*, std::string>> ChangeValues;
+
+// 一列的变更
+struct ChangeColumn {
+    const char* name;       // 列名
+    std::string value;      // 新值（删除时为被删除行的值）
+    std::string previous;   // 修改前的值（仅UPDATE）
+    bool changed;           // 本次是否修改（INSERT和REMOVE均为true）
+};
+
+// 一次提交后的行变更；UPDATE带整行新值，changed标出实际修改的列
+struct ChangeEvent {
+    uint64_t sequence;
+    ChangeKind kind;
+    ChangeTable table;
+    std::string key;                    // 主键
+    std::vector<ChangeColumn> columns;
+
+    ChangeEvent() : sequence(0), kind(ChangeKind::INSERT), table(ChangeTable::STUDENT) {}
+
+    // 按列名查找，不存在返回nullptr
+    const ChangeColumn* find(const char* name) const;
+
+    // 某列的新值（不存在时为空串）
+    const std::string& value(const char* name) const;
+
+    // 某列本次是否修改
+    bool isChanged(const char* name) const;
+};
+
+// 订阅者的投递方式
+enum class ChangeDelivery {
+    INLINE,         // 在发布线程内处理完再返回（缓存失效、计数等必须立即可见的订阅者）
+    BACKGROUND      // 由后台线程处理（可以稍有滞后的索引）
+};
+
+typedef std::function<void(const ChangeEvent&)> ChangeHandler;
+typedef std::function<void()> ChangeBatchEnd;
+
+// 订阅者统计
+struct ChangeSubscriberStats {
+    std::string name;
+    ChangeDelivery delivery;
+    uint64_t consumed;      // 已处理的事件数
+    uint64_t lag;           // 尚未处理的事件数
+    uint64_t maxLag;        // 观察到的最大积压
+
+    ChangeSubscriberStats() : delivery(ChangeDelivery::INLINE), consumed(0), lag(0), maxLag(0) {}
+};
+
+// 运行统计（背压：环形缓冲区满时发布方等待最慢的订阅者）
+struct ChangeFeedStats {
+    size_t capacity;
+    uint64_t published;         // 已发布的事件数
+    uint64_t producerStalls;    // 发布时因缓冲区满而等待的次数
+    uint64_t stallMicros;       // 等待的总时长（微秒）
+    std::vector<ChangeSubscriberStats> subscribers;
+
+    ChangeFeedStats() : capacity(0), published(0), producerStalls(0), stallMicros(0) {}
+};
+
+// --------------- 数据变更通知（单例）---------------
+// 各管理类写库提交后发布行变更，缓存、统计和索引订阅后自行更新，不必在每个管理类中逐个调用。
+// 事件放入定长环形缓冲区：发布方用原子序号分配槽位，写完后设置槽位的序号标记；每个订阅者有
+// 自己的读取位置，全部订阅者都会收到每个事件。槽位只有在所有订阅者读过上一轮后才会被覆盖，
+// 缓冲区满时发布方协助处理积压并计入背压统计。
+// 订阅需在启动时完成；处理函数中不能再发布事件。
+class ChangeFeed {
+public:
+    static const size_t CAPACITY = 4096;        // 必须是2的幂
+    static const size_t MAX_SUBSCRIBERS = 16;
+
+    static ChangeFeed& getInstance();
+
+    // 注册订阅者，从当前位置开始接收；onBatchEnd在每批事件处理完后调用（可为空）
+    bool subscribe(const char* name, ChangeDelivery delivery, ChangeHandler onEvent, ChangeBatchEnd onBatchEnd = nullptr);
+
+    // 启动/停止后台投递线程（停止前处理完积压事件）
+    void start();
+    void stop();
+
+    // 发布新增、修改（没有列变化时不发布）和删除
+    void publishInsert(ChangeTable table, const std::string& key, const ChangeValues& values);
+    void publishUpdate(ChangeTable table, const std::string& key, const ChangeValues& before, const ChangeValues& after);
+    void publishRemove(ChangeTable table, const std::string& key, const ChangeValues& values);
+
+    // 发布一批事件（批量写入时使用，INLINE订阅者每批只收尾一次）
+    void publish(std::vector<ChangeEvent>& events);
+
+    ChangeFeedStats getStats();
+
+    static ChangeEvent makeInsert(ChangeTable table, const std::string& key, const ChangeValues& values);
+
+private:
+    ChangeFeed();
+    ~ChangeFeed();
+    ChangeFeed(const ChangeFeed&) = delete;
+    ChangeFeed& operator=(const ChangeFeed&) = delete;
+
+    struct Slot {
+        std::atomic<uint64_t> stamp;    // 已写入事件的序号+1，0表示从未写入
+        ChangeEvent event;
+    };
+
+    struct Subscriber {
+        std::string name;
+        ChangeDelivery delivery;
+        ChangeHandler onEvent;
+        ChangeBatchEnd onBatchEnd;
+        uint64_t start;                 // 注册时的序号
+        std::atomic<uint64_t> cursor;   // 下一个要读取的序号（之前的槽位可以覆盖）
+        std::atomic<uint64_t> applied;  // 已处理完（含onBatchEnd）的序号上界
+        std::atomic<uint64_t> maxLag;
+        std::mutex drainMutex;          // 同一订阅者同时只有一个线程在处理
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> claimed;      // 已分配的序号数
+    std::atomic<uint64_t> stalls;
+    std::atomic<uint64_t> stallMicros;
+
+    Subscriber subscribers[MAX_SUBSCRIBERS];
+    std::atomic<size_t> subscriberCount;
+    std::mutex subscribeMutex;
+    std::atomic<bool> hasBackground;
+
+    std::thread dispatcher;
+    std::mutex dispatchMutex;
+    std::condition_variable dispatchCv;
+    std::atomic<bool> dispatcherIdle;
+    bool running;
+
+    // 分配count个连续序号并写入，返回最后一个序号
+    uint64_t publishRange(ChangeEvent* events, size_t count);
+
+    // 等待槽位可写（上一轮已写完且所有订阅者已读过），期间协助处理积压
+    void waitForSlot(uint64_t sequence);
+
+    // 处理订阅者到limit（含）为止已发布的事件，返回处理的个数
+    size_t drain(Subscriber& sub, uint64_t limit);
+
+    // 确保订阅者已处理完sequence（含）之前的事件
+    void drainUntil(Subscriber& sub, uint64_t sequence);
+
+    void notifyDispatcher();
+    void dispatchLoop();
+};
+
+#endif // CHANGEFEED_H
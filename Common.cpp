@@ -4,6 +4,7 @@
 #include <sstream>
 #include <iomanip>
 #include <locale>
+#include <atomic>
 
 bool Common::isGB2312Chinese(unsigned char c1, unsigned char c2) {
     return (c1 >= 0xA1 && c1 <= 0xF7) && (c2 >= 0xA1 && c2 <= 0xFE);
@@ -66,6 +67,58 @@ bool Common::stringToDouble(const std::string& str, double& result) {
     return (iss >> result) && (iss.eof());
 }
 
+//按十进制直接解析金额为分（如"12.345"→1235），不经过double避免累计误差
+bool Common::parseCents(const std::string& str, int64_t& cents) {
+    std::string trimmed = Common::trim(str);
+    if (trimmed.empty()) return false;
+
+    size_t pos = 0;
+    bool negative = false;
+    if (trimmed[pos] == '-' || trimmed[pos] == '+') {
+        negative = (trimmed[pos] == '-');
+        ++pos;
+    }
+
+    int64_t whole = 0;
+    size_t digits = 0;
+    while (pos < trimmed.size() && std::isdigit(static_cast<unsigned char>(trimmed[pos]))) {
+        whole = whole * 10 + (trimmed[pos] - '0');
+        ++pos;
+        ++digits;
+    }
+
+    int64_t fraction = 0;
+    if (pos < trimmed.size() && trimmed[pos] == '.') {
+        ++pos;
+        int fractionDigits = 0;
+        bool roundUp = false;
+        while (pos < trimmed.size() && std::isdigit(static_cast<unsigned char>(trimmed[pos]))) {
+            if (fractionDigits < 2) fraction = fraction * 10 + (trimmed[pos] - '0');
+            else if (fractionDigits == 2) roundUp = (trimmed[pos] >= '5');
+            ++fractionDigits;
+            ++pos;
+            ++digits;
+        }
+        if (fractionDigits == 1) fraction *= 10;
+        if (roundUp) ++fraction;
+    }
+    if (digits == 0 || pos != trimmed.size()) return false;
+
+    cents = whole * 100 + fraction;
+    if (negative) cents = -cents;
+    return true;
+}
+
+std::string Common::centsToString(int64_t cents) {
+    std::ostringstream oss;
+    if (cents < 0) {
+        oss << "-";
+        cents = -cents;
+    }
+    oss << cents / 100 << "." << std::setw(2) << std::setfill('0') << cents % 100;
+    return oss.str();
+}
+
 std::string Common::intToString(int value) {
     std::ostringstream oss;
     oss << value;
@@ -79,43 +132,73 @@ std::string Common::doubleToString(double value, int precision) {
 }
 
 std::string Common::dateToString(const Date& date, const std::string& sep) {
-    std::ostringstream oss;
-    oss << std::setfill('0') << std::setw(4) << date.year
-        << sep << std::setw(2) << date.month
-        << sep << std::setw(2) << date.day;
-    return oss.str();
+    char buf[10];
+    date.format(buf, sep.size() == 1 ? sep[0] : '-');
+    if (sep.size() == 1) return std::string(buf, 10);
+
+    //多字符或空分隔符
+    std::string result;
+    result.reserve(8 + sep.size() * 2);
+    result.append(buf, 4).append(sep).append(buf + 5, 2).append(sep).append(buf + 8, 2);
+    return result;
 }
 
-Date Common::stringToDate(const std::string& str, const std::string& sep) {
-    Date date;
-    std::string trimmed = Common::trim(str);
-    if (trimmed.empty()) return date;
+int Common::dateToDays(const Date& date) {
+    return date.days;
+}
 
-    size_t firstSep = trimmed.find(sep);
-    size_t secondSep = trimmed.rfind(sep);
-    if (firstSep == std::string::npos || secondSep == std::string::npos || firstSep == secondSep) return date;
+Date Common::daysToDate(int days) {
+    return Date::fromDays(days);
+}
 
-    std::string yearStr = trimmed.substr(0, firstSep);
-    std::string monthStr = trimmed.substr(firstSep + 1, secondSep - firstSep - 1);
-    std::string dayStr = trimmed.substr(secondSep + 1);
+//解析日期中的一段数字（允许首尾空白和正号），不分配内存
+static bool parseDatePart(const char* begin, const char* end, int& value) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(end[-1]))) --end;
+    if (begin < end && *begin == '+') ++begin;
+    if (begin == end || end - begin > 9) return false;
+    value = 0;
+    for (; begin < end; ++begin) {
+        unsigned digit = static_cast<unsigned>(static_cast<unsigned char>(*begin)) - '0';
+        if (digit > 9) return false;
+        value = value * 10 + static_cast<int>(digit);
+    }
+    return true;
+}
 
-    int year, month, day;
-    if (Common::stringToInt(yearStr, year) && Common::stringToInt(monthStr, month) && Common::stringToInt(dayStr, day)) {
-        if (year >= 2000 && year <= 2100 && month >= 1 && month <= 12 && day >= 1 && day <= 31) {
-            if ((month == 4 || month == 6 || month == 9 || month == 11) && day > 30) return date;
-            if (month == 2) {
-                bool isLeap = (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
-                if ((isLeap && day > 29) || (!isLeap && day > 28)) return date;
-            }
-            date.year = year; date.month = month; date.day = day;
+//解析失败返回空日期
+Date Common::stringToDate(const std::string& str, const std::string& sep) {
+    const char* begin = str.data();
+    const char* end = str.data() + str.size();
+    while (begin < end && std::isspace(static_cast<unsigned char>(*begin))) ++begin;
+    while (end > begin && std::isspace(static_cast<unsigned char>(end[-1]))) --end;
+    if (begin == end || sep.empty()) return Date();
+
+    //常见情况：标准YYYY-MM-DD
+    if (sep == "-" && end - begin == 10) {
+        Date date = Date::parse(begin, 10);
+        if (!date.isEmpty()) {
+            int year = date.year();
+            return (year >= 2000 && year <= 2100) ? date : Date();
         }
     }
-    return date;
+
+    const char* firstSep = std::search(begin, end, sep.begin(), sep.end());
+    if (firstSep == end) return Date();
+    const char* secondSep = std::find_end(begin, end, sep.begin(), sep.end());
+    if (secondSep == firstSep) return Date();
+
+    int year, month, day;
+    if (!parseDatePart(begin, firstSep, year) || !parseDatePart(firstSep + sep.size(), secondSep, month)
+        || !parseDatePart(secondSep + sep.size(), end, day)) {
+        return Date();
+    }
+    if (year < 2000 || year > 2100 || month < 1 || month > 12 || day < 1 || day > Date::daysInMonth(year, month)) return Date();
+    return Date(year, month, day);
 }
 
 std::string Common::getCurrentDateStr(const std::string& sep) {
-    Date date;
-    return Common::dateToString(date, sep);
+    return Common::dateToString(Date::today(), sep);
 }
 
 std::string Common::getCurrentDateTimeStr() {
@@ -167,34 +250,57 @@ std::string Common::normalizeTimeFormat(const std::string& time) {
     }
 }
 
-Date::Date() {
+Date Date::today() {
     std::time_t now = std::time(nullptr);
 #if defined(_MSC_VER)
     std::tm tm_now;
     if (localtime_s(&tm_now, &now) == 0) {
-        year = tm_now.tm_year + 1900;
-        month = tm_now.tm_mon + 1;
-        day = tm_now.tm_mday;
-        return;
+        return Date(tm_now.tm_year + 1900, tm_now.tm_mon + 1, tm_now.tm_mday);
     }
 #elif defined(__unix__) || defined(__APPLE__)
     std::tm tm_now;
     if (localtime_r(&now, &tm_now) != nullptr) {
-        year = tm_now.tm_year + 1900;
-        month = tm_now.tm_mon + 1;
-        day = tm_now.tm_mday;
-        return;
+        return Date(tm_now.tm_year + 1900, tm_now.tm_mon + 1, tm_now.tm_mday);
     }
 #else
     std::tm* p = std::localtime(&now);
     if (p) {
-        year = p->tm_year + 1900;
-        month = p->tm_mon + 1;
-        day = p->tm_mday;
-        return;
+        return Date(p->tm_year + 1900, p->tm_mon + 1, p->tm_mday);
     }
 #endif
-    year = 1970; month = 1; day = 1;
+    return Date::fromDays(0);
+}
+
+void Date::toCivil(int& y, int& m, int& d) const {
+    if (isEmpty()) {
+        y = m = d = 0;
+        return;
+    }
+    int32_t n = days + 719468;
+    int era = (n >= 0 ? n : n - 146096) / 146097;
+    int doe = n - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp + (mp < 10 ? 3 : -9);
+    y = yoe + era * 400 + (m <= 2 ? 1 : 0);
+}
+
+void Date::format(char* out, char sep) const {
+    int y, m, d;
+    toCivil(y, m, d);
+    y %= 10000;
+    out[0] = static_cast<char>('0' + y / 1000);
+    out[1] = static_cast<char>('0' + y / 100 % 10);
+    out[2] = static_cast<char>('0' + y / 10 % 10);
+    out[3] = static_cast<char>('0' + y % 10);
+    out[4] = sep;
+    out[5] = static_cast<char>('0' + m / 10);
+    out[6] = static_cast<char>('0' + m % 10);
+    out[7] = sep;
+    out[8] = static_cast<char>('0' + d / 10);
+    out[9] = static_cast<char>('0' + d % 10);
 }
 
 bool Common::isValidStudentID(const std::string& id) {
@@ -277,6 +383,17 @@ bool Common::isValidIDCard(const std::string& idCard) {
     return (std::isdigit(static_cast<unsigned char>(lastChar)) || lastChar == 'X' || lastChar == 'x');
 }
 
+bool Common::isValidIDCardChecksum(const std::string& idCard) {
+    if (!Common::isValidIDCard(idCard)) return false;
+    std::string trimmed = Common::trim(idCard);
+    static const int weights[17] = { 7, 9, 10, 5, 8, 4, 2, 1, 6, 3, 7, 9, 10, 5, 8, 4, 2 };
+    static const char checkCodes[] = "10X98765432";
+    int sum = 0;
+    for (int i = 0; i < 17; ++i) sum += (trimmed[i] - '0') * weights[i];
+    char lastChar = static_cast<char>(std::toupper(static_cast<unsigned char>(trimmed.back())));
+    return lastChar == checkCodes[sum % 11];
+}
+
 bool Common::isValidDormID(const std::string& dormID) {
     std::string trimmed = Common::trim(dormID);
     if (trimmed.size() < 3 || trimmed.size() > MAX_DORM_ID_LEN) return false;
@@ -346,8 +463,9 @@ bool Common::isValidMajor(const std::string& major) {
 
 
 bool Common::isValidDate(const std::string& dateStr) {
-    Date date = Common::stringToDate(dateStr);
-    return Common::dateToString(date) == dateStr;
+    //必须恰好是YYYY-MM-DD（不允许首尾空白，月日需补0）
+    Date date = Date::parse(dateStr.data(), dateStr.size());
+    return !date.isEmpty() && date.year() >= 2000 && date.year() <= 2100;
 }
 
 bool Common::isValidDateTime(const std::string& dateTimeStr) {
@@ -411,4 +529,19 @@ bool Common::isPointInRect(int x, int y, int rectX, int rectY, int rectW, int re
 
 void Common::delay(int ms) {
     std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void Common::parallelFor(size_t count, int threadCount, const std::function<void(size_t)>& body) {
+    if (threadCount < 1) threadCount = 1;
+    threadCount = static_cast<int>(std::min<size_t>(static_cast<size_t>(threadCount), std::max<size_t>(1, count)));
+
+    //各线程从共享计数器领取下标，负载自动均衡
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) body(i);
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threadCount; ++i) workers.emplace_back(worker);
+    worker();
+    for (auto& t : workers) t.join();
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <string>
+#include <cstdint>
 #include <ctime>
 #include <sstream>
 #include <iomanip>
@@ -10,6 +11,8 @@
 #include <cctype>
 #include <chrono>
 #include <thread>
+#include <functional>
+#include <vector>
 
 const int WINDOW_WIDTH = 1200;
 const int WINDOW_HEIGHT = 800;
@@ -63,21 +66,101 @@ enum class UIState {
     EXIT = 9
 };
 
+// 日期：存储自1970-01-01起的天数（32位整数，可直接按值复制和比较）
+// 默认构造为空日期（显示为0000-00-00）；当天日期需显式调用Date::today()
 struct Date {
-    int year;
-    int month;
-    int day;
-    Date();
+    static const int32_t EMPTY_DAYS = INT32_MIN;
 
-    Date(int y, int m, int d) : year(y), month(m), day(d) {}
+    int32_t days;
 
-    bool operator==(const Date& other) const {
-        return year == other.year && month == other.month && day == other.day;
+    constexpr Date() : days(EMPTY_DAYS) {}
+
+    // 年月日构造；月或日为0（如Date(0, 0, 0)）表示空日期
+    constexpr Date(int y, int m, int d) : days((m <= 0 || d <= 0) ? EMPTY_DAYS : civilToDays(y, m, d)) {}
+
+    static constexpr Date fromDays(int32_t n) {
+        Date date;
+        date.days = n;
+        return date;
     }
-    bool operator<(const Date& other) const {
-        if (year != other.year) return year < other.year;
-        if (month != other.month) return month < other.month;
-        return day < other.day;
+
+    // 当天日期（本地时区）
+    static Date today();
+
+    constexpr bool isEmpty() const { return days == EMPTY_DAYS; }
+
+    // 空日期时返回当天，用于"未填写则取当天"的写入场景
+    Date orToday() const { return isEmpty() ? today() : *this; }
+
+    constexpr int year() const { return isEmpty() ? 0 : civilYear(days); }
+    constexpr int month() const { return isEmpty() ? 0 : civilMonth(days); }
+    constexpr int day() const { return isEmpty() ? 0 : civilDay(days); }
+
+    // 解析严格的YYYY-MM-DD（不去空白，不分配内存），不合法返回空日期
+    static constexpr Date parse(const char* str, size_t len) {
+        if (len != 10 || str[4] != '-' || str[7] != '-') return Date();
+        unsigned d[10] = {};
+        unsigned bad = 0;
+        for (int i = 0; i < 10; ++i) {
+            d[i] = static_cast<unsigned>(static_cast<unsigned char>(str[i])) - '0';
+            if (i != 4 && i != 7) bad |= (d[i] > 9);
+        }
+        int y = static_cast<int>(d[0] * 1000 + d[1] * 100 + d[2] * 10 + d[3]);
+        int m = static_cast<int>(d[5] * 10 + d[6]);
+        int dd = static_cast<int>(d[8] * 10 + d[9]);
+        if (bad || m < 1 || m > 12 || dd < 1 || dd > daysInMonth(y, m)) return Date();
+        return Date(y, m, dd);
+    }
+
+    // 字面量：constexpr Date start = Date::literal("2024-09-01");
+    template <size_t N>
+    static constexpr Date literal(const char (&str)[N]) { return parse(str, N - 1); }
+
+    // 一次取出年月日（空日期为0,0,0）
+    void toCivil(int& y, int& m, int& d) const;
+
+    // 写出YYYY<sep>MM<sep>DD（10个字符，不含结尾0）
+    void format(char* out, char sep = '-') const;
+
+    static constexpr bool isLeapYear(int y) { return (y % 4 == 0 && y % 100 != 0) || (y % 400 == 0); }
+    static constexpr int daysInMonth(int y, int m) {
+        return m == 2 ? (isLeapYear(y) ? 29 : 28) : 30 + ((m + (m >> 3)) & 1);
+    }
+
+    // 公历与天数互转（按400年周期计算，不依赖time_t范围）
+    static constexpr int32_t civilToDays(int y, int m, int d) {
+        int yy = y - (m <= 2 ? 1 : 0);
+        int era = (yy >= 0 ? yy : yy - 399) / 400;
+        int yoe = yy - era * 400;
+        int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    constexpr bool operator==(const Date& other) const { return days == other.days; }
+    constexpr bool operator!=(const Date& other) const { return days != other.days; }
+    constexpr bool operator<(const Date& other) const { return days < other.days; }
+
+private:
+    static constexpr int civilDayOfEra(int32_t n) {
+        return (n + 719468) - ((n + 719468) >= 0 ? (n + 719468) : (n + 719468) - 146096) / 146097 * 146097;
+    }
+    static constexpr int civilYearOfEra(int doe) { return (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; }
+    static constexpr int civilDayOfYear(int doe) {
+        return doe - (365 * civilYearOfEra(doe) + civilYearOfEra(doe) / 4 - civilYearOfEra(doe) / 100);
+    }
+    static constexpr int civilMonthIndex(int doe) { return (5 * civilDayOfYear(doe) + 2) / 153; }
+
+    static constexpr int civilMonth(int32_t n) {
+        return civilMonthIndex(civilDayOfEra(n)) + (civilMonthIndex(civilDayOfEra(n)) < 10 ? 3 : -9);
+    }
+    static constexpr int civilDay(int32_t n) {
+        return civilDayOfYear(civilDayOfEra(n)) - (153 * civilMonthIndex(civilDayOfEra(n)) + 2) / 5 + 1;
+    }
+    static constexpr int civilYear(int32_t n) {
+        return civilYearOfEra(civilDayOfEra(n))
+            + ((n + 719468) >= 0 ? (n + 719468) : (n + 719468) - 146096) / 146097 * 400
+            + (civilMonth(n) <= 2 ? 1 : 0);
     }
 };
 
@@ -105,10 +188,14 @@ namespace Common {
     std::string padRight(const std::string& str, int length, char pad = ' ');
     bool stringToInt(const std::string& str, int& result);
     bool stringToDouble(const std::string& str, double& result);
+    bool parseCents(const std::string& str, int64_t& cents);
+    std::string centsToString(int64_t cents);
     std::string intToString(int value);
     std::string doubleToString(double value, int precision = 2);
     std::string dateToString(const Date& date, const std::string& sep = "-");
     Date stringToDate(const std::string& str, const std::string& sep = "-");
+    int dateToDays(const Date& date);   // 自1970-01-01起的天数
+    Date daysToDate(int days);
     std::string getCurrentDateStr(const std::string& sep = "-");
     std::string getCurrentDateTimeStr();
     std::string normalizeTimeFormat(const std::string& time);
@@ -119,6 +206,7 @@ namespace Common {
     bool isValidName(const std::string& name);
     bool isValidPhone(const std::string& phone);
     bool isValidIDCard(const std::string& idCard);
+    bool isValidIDCardChecksum(const std::string& idCard);  // 格式合法且末位符合GB 11643校验码
     bool isValidDormID(const std::string& dormID);
     bool isValidBuilding(const std::string& building);
     bool isValidRoomType(const std::string& roomType);
@@ -132,6 +220,29 @@ namespace Common {
     bool isPointInRect(int x, int y, int rectX, int rectY, int rectW, int rectH);
     bool isGB2312Chinese(unsigned char c1, unsigned char c2);
     void delay(int ms);
+
+    // 按线程数把[0, count)分发给多个线程执行（threadCount小于1按1）
+    void parallelFor(size_t count, int threadCount, const std::function<void(size_t)>& body);
+
+    // 按行区间分片并行聚合：每片用addRow累加到自己的结果，最后用merge并入第一片后返回。
+    // 数据库扫描本身是串行流，这里只并行内存中的聚合；每片约4096行以上才多开线程
+    //（threadCount小于等于0时按CPU核数）
+    template <typename Result>
+    Result parallelAggregate(size_t count, int threadCount,
+        const std::function<void(Result&, size_t)>& addRow,
+        const std::function<void(Result&, const Result&)>& merge) {
+        if (threadCount <= 0) threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount < 1) threadCount = 1;
+        size_t shardCount = std::min<size_t>(static_cast<size_t>(threadCount), count / 4096 + 1);
+        size_t perShard = (count + shardCount - 1) / shardCount;
+        std::vector<Result> partial(shardCount);
+        parallelFor(shardCount, static_cast<int>(shardCount), [&](size_t shard) {
+            size_t end = std::min(count, (shard + 1) * perShard);
+            for (size_t i = shard * perShard; i < end; ++i) addRow(partial[shard], i);
+        });
+        for (size_t s = 1; s < shardCount; ++s) merge(partial[0], partial[s]);
+        return std::move(partial[0]);
+    }
 }
 
 #endif 
\ No newline at end of file
@@ -1,11 +1,12 @@
 #include "DBHelper.h"
 #include "Common.h"
+#include "Transcode.h"
 #include <mysql.h>
 #include <cstring>
 #include <iostream>
 
 //构造函数
-DBHelper::DBHelper() : is_connected(false) {
+DBHelper::DBHelper() : is_connected(false), wire_utf8(false) {
     mysql_init(&mysql_conn);
 
     //连接超时
@@ -113,6 +114,8 @@ bool DBHelper::connect(const std::string& host,
         return false;
     }
 
+    wire_utf8 = Transcode::isUtf8Charset(DB_CHARSET);
+
     //设置自动提交，确保每次更新立即生效
     if (mysql_autocommit(&mysql_conn, 1) != 0) {
         int err = mysql_errno(&mysql_conn);
@@ -149,8 +152,9 @@ int DBHelper::executeUpdate(const std::string& sql) {
     std::lock_guard<std::mutex> lock(db_mutex);
     setError(0, "");
 
-    if (mysql_query(&mysql_conn, sql.c_str()) != 0) {
-        setError(mysql_errno(&mysql_conn), std::string("执行SQL失败：") + mysql_error(&mysql_conn) + " [SQL: " + sql + "]");
+    std::string wireBuffer;
+    if (mysql_query(&mysql_conn, toWire(sql, wireBuffer).c_str()) != 0) {
+        setError(mysql_errno(&mysql_conn), std::string("执行SQL失败：") + wireError() + " [SQL: " + sql + "]");
         return -1;
     }
 
@@ -178,6 +182,74 @@ int DBHelper::executeUpdate(const std::string& sql) {
     return affectedRows;
 }
 
+//更新类SQL（返回LAST_INSERT_ID）实现
+int DBHelper::executeUpdate(const std::string& sql, uint64_t& insertId) {
+    insertId = 0;
+    if (!is_connected && !reconnect()) return -1;
+
+    std::lock_guard<std::mutex> lock(db_mutex);
+    setError(0, "");
+
+    std::string wireBuffer;
+    if (mysql_query(&mysql_conn, toWire(sql, wireBuffer).c_str()) != 0) {
+        setError(mysql_errno(&mysql_conn), std::string("执行SQL失败：") + wireError() + " [SQL: " + sql + "]");
+        return -1;
+    }
+
+    //在同一把锁内读取，避免被其他线程的语句覆盖
+    int affectedRows = static_cast<int>(mysql_affected_rows(&mysql_conn));
+    insertId = static_cast<uint64_t>(mysql_insert_id(&mysql_conn));
+    mysql_commit(&mysql_conn);
+    return affectedRows;
+}
+
+//事务批量执行实现
+int DBHelper::executeBatch(const std::vector<std::string>& sqlList, bool requireAffected) {
+    uint64_t firstInsertId = 0;
+    return executeBatch(sqlList, firstInsertId, requireAffected);
+}
+
+//事务批量执行（返回第一条语句的LAST_INSERT_ID）实现
+int DBHelper::executeBatch(const std::vector<std::string>& sqlList, uint64_t& firstInsertId, bool requireAffected) {
+    firstInsertId = 0;
+    if (!is_connected && !reconnect()) return -1;
+    if (sqlList.empty()) return 0;
+
+    std::lock_guard<std::mutex> lock(db_mutex);
+    setError(0, "");
+
+    if (mysql_query(&mysql_conn, "START TRANSACTION") != 0) {
+        setError(mysql_errno(&mysql_conn), std::string("开启事务失败：") + wireError());
+        return -1;
+    }
+
+    int totalRows = 0;
+    std::string wireBuffer;
+    for (const auto& sql : sqlList) {
+        if (mysql_query(&mysql_conn, toWire(sql, wireBuffer).c_str()) != 0) {
+            setError(mysql_errno(&mysql_conn), std::string("执行SQL失败：") + wireError() + " [SQL: " + sql + "]");
+            mysql_rollback(&mysql_conn);
+            return -1;
+        }
+        int affectedRows = static_cast<int>(mysql_affected_rows(&mysql_conn));
+        if (requireAffected && affectedRows <= 0) {
+            setError(-1, "批量执行失败：语句未影响任何行，已回滚 [SQL: " + sql + "]");
+            mysql_rollback(&mysql_conn);
+            return -1;
+        }
+        //在同一把锁内读取，避免被后续语句或其他线程覆盖
+        if (&sql == &sqlList.front()) firstInsertId = static_cast<uint64_t>(mysql_insert_id(&mysql_conn));
+        totalRows += affectedRows;
+    }
+
+    if (mysql_commit(&mysql_conn) != 0) {
+        setError(mysql_errno(&mysql_conn), std::string("提交事务失败：") + wireError());
+        mysql_rollback(&mysql_conn);
+        return -1;
+    }
+    return totalRows;
+}
+
 //查询类SQL
 DBResultset* DBHelper::executeQuery(const std::string& sql) {
     if (!is_connected && !reconnect()) return nullptr;
@@ -188,8 +260,9 @@ DBResultset* DBHelper::executeQuery(const std::string& sql) {
     //提交任何挂起的事务，确保查询到最新数据
     mysql_commit(&mysql_conn);
 
-    if (mysql_query(&mysql_conn, sql.c_str()) != 0) {
-        setError(mysql_errno(&mysql_conn), std::string("执行查询SQL失败：") + mysql_error(&mysql_conn) + " [SQL: " + sql + "]");
+    std::string wireBuffer;
+    if (mysql_query(&mysql_conn, toWire(sql, wireBuffer).c_str()) != 0) {
+        setError(mysql_errno(&mysql_conn), std::string("执行查询SQL失败：") + wireError() + " [SQL: " + sql + "]");
         return nullptr;
     }
 
@@ -200,7 +273,7 @@ DBResultset* DBHelper::executeQuery(const std::string& sql) {
             return nullptr;
         }
         else {
-            setError(mysql_errno(&mysql_conn), std::string("获取结果集失败：") + mysql_error(&mysql_conn));
+            setError(mysql_errno(&mysql_conn), std::string("获取结果集失败：") + wireError());
             return nullptr;
         }
     }
@@ -228,7 +301,7 @@ DBResultset* DBHelper::executeQuery(const std::string& sql) {
                 row_map[result->fields[i]] = "";
             }
             else {
-                row_map[result->fields[i]] = std::string(mysql_row[i], field_lengths[i]);
+                row_map[result->fields[i]] = fromWire(mysql_row[i], field_lengths[i]);
             }
         }
 
@@ -241,6 +314,93 @@ DBResultset* DBHelper::executeQuery(const std::string& sql) {
     return result;
 }
 
+//流式查询实现（mysql_use_result逐行读取）
+int64_t DBHelper::executeQueryStream(const std::string& sql, const std::function<void(const DBRowView&)>& onRow) {
+    if (!is_connected && !reconnect()) return -1;
+
+    std::lock_guard<std::mutex> lock(db_mutex);
+    setError(0, "");
+
+    std::string wireBuffer;
+    if (mysql_query(&mysql_conn, toWire(sql, wireBuffer).c_str()) != 0) {
+        setError(mysql_errno(&mysql_conn), std::string("执行查询SQL失败：") + wireError() + " [SQL: " + sql + "]");
+        return -1;
+    }
+
+    MYSQL_RES* mysql_result = mysql_use_result(&mysql_conn);
+    if (mysql_result == nullptr) {
+        setError(mysql_errno(&mysql_conn), std::string("获取结果集失败：") + wireError());
+        return -1;
+    }
+
+    DBRowView view;
+    view.fieldCount = mysql_num_fields(mysql_result);
+    int64_t rowCount = 0;
+
+    //连接字符集为UTF-8时逐行转为GBK：纯ASCII列直接引用原值，其余列写入复用的行缓冲
+    std::vector<char*> wireValues(view.fieldCount);
+    std::vector<unsigned long> wireLengths(view.fieldCount);
+    std::vector<size_t> wireOffsets(view.fieldCount);
+    std::string rowBuffer;
+
+    MYSQL_ROW mysql_row;
+    while ((mysql_row = mysql_fetch_row(mysql_result)) != nullptr) {
+        view.values = mysql_row;
+        view.lengths = mysql_fetch_lengths(mysql_result);
+        if (wire_utf8) {
+            rowBuffer.clear();
+            for (uint32_t i = 0; i < view.fieldCount; ++i) {
+                wireValues[i] = mysql_row[i];
+                wireLengths[i] = view.lengths[i];
+                wireOffsets[i] = std::string::npos;
+                if (mysql_row[i] == nullptr || Transcode::asciiPrefix(mysql_row[i], view.lengths[i]) == view.lengths[i]) continue;
+                wireOffsets[i] = rowBuffer.size();
+                Transcode::utf8ToGbk(mysql_row[i], view.lengths[i], rowBuffer);
+                wireLengths[i] = static_cast<unsigned long>(rowBuffer.size() - wireOffsets[i]);
+            }
+            //行缓冲全部写完后再取地址
+            for (uint32_t i = 0; i < view.fieldCount; ++i) {
+                if (wireOffsets[i] != std::string::npos) wireValues[i] = &rowBuffer[0] + wireOffsets[i];
+            }
+            view.values = wireValues.data();
+            view.lengths = wireLengths.data();
+        }
+        onRow(view);
+        ++rowCount;
+    }
+
+    //读取中途出错（如连接中断）
+    if (mysql_errno(&mysql_conn) != 0) {
+        setError(mysql_errno(&mysql_conn), std::string("流式读取失败：") + wireError());
+        mysql_free_result(mysql_result);
+        return -1;
+    }
+
+    mysql_free_result(mysql_result);
+    return rowCount;
+}
+
+//SQL转为连接字符集
+const std::string& DBHelper::toWire(const std::string& sql, std::string& buffer) const {
+    if (!wire_utf8 || Transcode::asciiPrefix(sql.data(), sql.size()) == sql.size()) return sql;
+    buffer.clear();
+    Transcode::gbkToUtf8(sql.data(), sql.size(), buffer);
+    return buffer;
+}
+
+//连接字符集的文本转为GBK
+std::string DBHelper::fromWire(const char* data, size_t len) const {
+    if (!wire_utf8) return std::string(data, len);
+    std::string result;
+    Transcode::utf8ToGbk(data, len, result);
+    return result;
+}
+
+std::string DBHelper::wireError() {
+    const char* msg = mysql_error(&mysql_conn);
+    return msg ? fromWire(msg, std::strlen(msg)) : std::string();
+}
+
 //释放查询结果集实现
 void DBHelper::freeResultset(DBResultset* result) {
     if (result != nullptr) {
@@ -280,7 +440,7 @@ bool DBHelper::commitTransaction() {
     setError(0, "");
     
     if (mysql_commit(&mysql_conn) != 0) {
-        setError(mysql_errno(&mysql_conn), std::string("提交事务失败：") + mysql_error(&mysql_conn));
+        setError(mysql_errno(&mysql_conn), std::string("提交事务失败：") + wireError());
         return false;
     }
     
@@ -295,7 +455,7 @@ bool DBHelper::rollbackTransaction() {
     setError(0, "");
     
     if (mysql_rollback(&mysql_conn) != 0) {
-        setError(mysql_errno(&mysql_conn), std::string("回滚事务失败：") + mysql_error(&mysql_conn));
+        setError(mysql_errno(&mysql_conn), std::string("回滚事务失败：") + wireError());
         return false;
     }
     
@@ -7,6 +7,8 @@
 #include <map>
 #include <cstdint>
 #include <mutex>  
+#include <functional>
+#include "Common.h"
 
 //数据库相关常量
 constexpr const char* DB_DEFAULT_HOST = "localhost";    //主机
@@ -14,7 +16,7 @@ constexpr const char* DB_DEFAULT_USER = "root";         //用户名
 constexpr const char* DB_DEFAULT_PWD = "root";          // 默认数据库密码
 constexpr const char* DB_DEFAULT_NAME = "Dorm_management"; //数据库名
 constexpr unsigned int DB_DEFAULT_PORT = 3306;          //数据库端口
-constexpr const char* DB_CHARSET = "gb2312";           //数据库字符集
+constexpr const char* DB_CHARSET = "gb2312";           //数据库字符集（改为utf8mb4时，收发内容在GBK与UTF-8间自动转换）
 
 //数据库错误信息结构体
 struct DBErrorInfo {
@@ -43,6 +45,28 @@ struct DBResultset {
     }
 };
 
+//流式查询的行视图（仅在回调期间有效）
+struct DBRowView {
+    MYSQL_ROW values;          // 各列原始值（NULL列为nullptr；连接字符集为UTF-8时为转换后的GBK，仅在回调内有效）
+    unsigned long* lengths;    // 各列长度
+    uint32_t fieldCount;       // 列数
+
+    //按列序号取字符串（NULL返回空串）
+    std::string getString(uint32_t index) const {
+        if (index >= fieldCount || values[index] == nullptr) return "";
+        return std::string(values[index], lengths[index]);
+    }
+    //按列序号取日期（DATE或DATETIME的日期部分，不分配内存；NULL或格式不符返回空日期）
+    Date getDate(uint32_t index) const {
+        if (index >= fieldCount || values[index] == nullptr || lengths[index] < 10) return Date();
+        return Date::parse(values[index], 10);
+    }
+    //判断列是否为NULL
+    bool isNull(uint32_t index) const {
+        return index >= fieldCount || values[index] == nullptr;
+    }
+};
+
 //数据库操作封装类
 class DBHelper {
 private:
@@ -50,6 +74,7 @@ private:
     DBErrorInfo last_error;    // 最后一次错误信息
     std::mutex db_mutex;       // 互斥锁（保证SQL执行线程安全）
     bool is_connected;         // 连接状态标记
+    bool wire_utf8;            // 连接字符集为UTF-8（程序内部为GBK，SQL和结果在收发时转换）
 
     //构造、析构
     DBHelper();
@@ -66,6 +91,13 @@ private:
     // 内部错误处理函数
     void setError(int errCode, const std::string& errMsg);
 
+    // SQL转为连接字符集（无需转换时直接返回sql，否则写入buffer并返回buffer）
+    const std::string& toWire(const std::string& sql, std::string& buffer) const;
+    // 连接字符集的文本转为GBK
+    std::string fromWire(const char* data, size_t len) const;
+    // 当前MySQL错误描述（已转为GBK）
+    std::string wireError();
+
 public:
     //单例实例获取接口
     static DBHelper& getInstance();
@@ -81,9 +113,19 @@ public:
     void disconnect();
     //执行更新类SQL，比如INSERT/UPDATE/DELETE
     int executeUpdate(const std::string& sql);
+    //执行更新类SQL并取回LAST_INSERT_ID（同一连接内原子完成，用于序列号预留）
+    int executeUpdate(const std::string& sql, uint64_t& insertId);
+    //在一个事务内依次执行多条更新SQL，任一失败则整体回滚，返回总影响行数（失败返回-1）
+    //requireAffected为true时，某条语句未影响任何行也视为失败（用于条件UPDATE）
+    int executeBatch(const std::vector<std::string>& sqlList, bool requireAffected = false);
+    //同上，并在同一连接内取回第一条语句的LAST_INSERT_ID（用于单条INSERT随其他语句一起提交）
+    int executeBatch(const std::vector<std::string>& sqlList, uint64_t& firstInsertId, bool requireAffected = false);
 
     //执行查询类SQL如SELECT
     DBResultset* executeQuery(const std::string& sql);
+    //流式查询：逐行回调，不缓存整个结果集，返回行数（失败返回-1）
+    //注意：回调期间持有连接锁，回调内不可再调用DBHelper
+    int64_t executeQueryStream(const std::string& sql, const std::function<void(const DBRowView&)>& onRow);
     //释放查询结果集
     void freeResultset(DBResultset* result);
     //获取最后一次错误信息
@@ -0,0 +1,305 @@
+#include "DormAssignment.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include "Transcode.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <atomic>
+#include <thread>
+
+static const size_t MAX_REJECTED_LINES = 100;
+
+//解析名单文件的一行
+bool DormAssignment::parseLine(const std::string& line, Student& student, std::string& err) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) fields.push_back(Common::trim(field));
+    if (fields.size() < 5 || fields.size() > 7) {
+        err = "字段数应为5~7";
+        return false;
+    }
+
+    student.studentId = fields[0];
+    student.studentName = fields[1];
+    student.gender = fields[2];
+    if (!Common::stringToInt(fields[3], student.age)) {
+        err = "年龄格式错误";
+        return false;
+    }
+    student.major = fields[4];
+    student.studentPhone = fields.size() > 5 ? fields[5] : "";
+    student.dormId.clear();
+    student.checkInDate = Date();
+    if (fields.size() > 6 && !fields[6].empty()) {
+        if (!Common::isValidDate(fields[6])) {
+            err = "入学日期格式错误";
+            return false;
+        }
+        student.checkInDate = Common::stringToDate(fields[6]);
+    }
+    return true;
+}
+
+//读取宿舍容量和现有住户性别
+bool DormAssignment::loadDorms(const AssignmentConstraints& constraints, std::vector<DormSlot>& dorms) {
+    std::map<std::string, size_t> buildingRank;
+    for (size_t i = 0; i < constraints.preferredBuildings.size(); ++i) {
+        buildingRank.emplace(Common::trim(constraints.preferredBuildings[i]), i);
+    }
+    std::string roomType = Common::trim(constraints.roomType);
+
+    //一次联表扫描取出空余床位和已入住学生的性别范围
+    std::string sql =
+        "SELECT d.dorm_id, d.building, d.room_type, d.max_capacity - d.current_occupancy, "
+        "MIN(s.gender), MAX(s.gender) "
+        "FROM dorm d LEFT JOIN student s ON s.dorm_id = d.dorm_id "
+        "GROUP BY d.dorm_id, d.building, d.room_type, d.max_capacity, d.current_occupancy";
+
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(sql, [&](const DBRowView& row) {
+        DormSlot slot;
+        slot.dormId = row.getString(0);
+        slot.building = row.getString(1);
+        slot.roomType = row.getString(2);
+        slot.freeBeds = 0;
+        Common::stringToInt(row.getString(3), slot.freeBeds);
+        if (slot.freeBeds <= 0) return;
+        if (!roomType.empty() && slot.roomType != roomType) return;
+        if (!buildingRank.empty() && buildingRank.count(slot.building) == 0) return;
+
+        std::string minGender = row.getString(4);
+        std::string maxGender = row.getString(5);
+        if (minGender != maxGender) return; //已混住的宿舍不再分配
+        slot.gender = minGender;
+
+        auto it = constraints.dormGender.find(slot.dormId);
+        if (it != constraints.dormGender.end()) {
+            std::string required = Common::trim(it->second);
+            if (!slot.gender.empty() && slot.gender != required) return; //与现有住户冲突
+            slot.gender = required;
+        }
+        dorms.push_back(slot);
+    });
+    if (rowCount < 0) {
+        lastError = "读取宿舍失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    //按楼栋优先级、宿舍号排序
+    std::sort(dorms.begin(), dorms.end(), [&buildingRank](const DormSlot& a, const DormSlot& b) {
+        size_t rankA = buildingRank.empty() ? 0 : buildingRank.at(a.building);
+        size_t rankB = buildingRank.empty() ? 0 : buildingRank.at(b.building);
+        if (rankA != rankB) return rankA < rankB;
+        if (a.building != b.building) return a.building < b.building;
+        return a.dormId < b.dormId;
+    });
+    return true;
+}
+
+//分片内装箱：大专业先排，优先放进恰好装得下的宿舍，装不下则先住满最大的宿舍
+void DormAssignment::packShard(Shard& shard, std::vector<std::string>& dormOfStudent) {
+    std::multimap<int, DormSlot*> byFree;
+    for (DormSlot* dorm : shard.dorms) {
+        if (dorm->freeBeds > 0) byFree.emplace(dorm->freeBeds, dorm);
+    }
+
+    std::sort(shard.majorGroups.begin(), shard.majorGroups.end(),
+        [](const std::vector<size_t>& a, const std::vector<size_t>& b) { return a.size() > b.size(); });
+
+    for (const auto& group : shard.majorGroups) {
+        size_t next = 0;
+        while (next < group.size() && !byFree.empty()) {
+            int remaining = static_cast<int>(group.size() - next);
+            auto it = byFree.lower_bound(remaining);
+            if (it == byFree.end()) --it;
+
+            DormSlot* dorm = it->second;
+            byFree.erase(it);
+            int take = std::min(remaining, dorm->freeBeds);
+            for (int i = 0; i < take; ++i) {
+                dormOfStudent[group[next++]] = dorm->dormId;
+            }
+            dorm->freeBeds -= take;
+            if (dorm->freeBeds > 0) byFree.emplace(dorm->freeBeds, dorm);
+        }
+    }
+}
+
+//计算分配方案
+bool DormAssignment::solve(const std::vector<Student>& students, const AssignmentConstraints& constraints,
+    AssignmentResult& result) {
+    lastError.clear();
+    result = AssignmentResult();
+
+    std::vector<DormSlot> dorms;
+    if (!loadDorms(constraints, dorms)) return false;
+
+    //1. 按性别分组，性别不合法的学生直接列为未分配
+    std::map<std::string, std::vector<size_t>> byGender;
+    for (size_t i = 0; i < students.size(); ++i) {
+        std::string gender = Common::trim(students[i].gender);
+        if (gender != "男" && gender != "女") {
+            result.unassigned.push_back(students[i]);
+            continue;
+        }
+        byGender[gender].push_back(i);
+    }
+
+    //2. 尚未确定性别的空宿舍，按缺口分给床位不足的性别
+    std::map<std::string, int> deficit;
+    for (const auto& item : byGender) deficit[item.first] = static_cast<int>(item.second.size());
+    for (const auto& dorm : dorms) {
+        if (!dorm.gender.empty() && deficit.count(dorm.gender)) deficit[dorm.gender] -= dorm.freeBeds;
+    }
+    for (auto& dorm : dorms) {
+        if (!dorm.gender.empty()) continue;
+        auto best = deficit.end();
+        for (auto it = deficit.begin(); it != deficit.end(); ++it) {
+            if (it->second > 0 && (best == deficit.end() || it->second > best->second)) best = it;
+        }
+        if (best == deficit.end()) break;
+        dorm.gender = best->first;
+        best->second -= dorm.freeBeds;
+    }
+
+    //3. 按(性别, 楼栋)划分分片，保持楼栋优先级顺序
+    std::vector<Shard> shards;
+    std::map<std::string, std::vector<size_t>> shardsOfGender;
+    for (auto& dorm : dorms) {
+        if (dorm.gender.empty() || byGender.count(dorm.gender) == 0) continue;
+        std::vector<size_t>& owned = shardsOfGender[dorm.gender];
+        if (owned.empty() || shards[owned.back()].building != dorm.building) {
+            Shard shard;
+            shard.gender = dorm.gender;
+            shard.building = dorm.building;
+            shards.push_back(shard);
+            owned.push_back(shards.size() - 1);
+        }
+        Shard& shard = shards[owned.back()];
+        shard.dorms.push_back(&dorm);
+        shard.capacity += dorm.freeBeds;
+    }
+
+    //4. 专业整体分到分片：按专业人数从大到小，优先放进第一个装得下的楼栋，否则按优先级拆分
+    std::vector<std::string> dormOfStudent(students.size());
+    for (const auto& genderItem : byGender) {
+        std::map<std::string, std::vector<size_t>> majors;
+        for (size_t index : genderItem.second) {
+            std::string key = constraints.keepMajorsTogether ? Common::trim(students[index].major) : "";
+            majors[key].push_back(index);
+        }
+        std::vector<std::vector<size_t>> groups;
+        for (auto& item : majors) groups.push_back(std::move(item.second));
+        std::stable_sort(groups.begin(), groups.end(),
+            [](const std::vector<size_t>& a, const std::vector<size_t>& b) { return a.size() > b.size(); });
+
+        std::vector<size_t>& owned = shardsOfGender[genderItem.first];
+        for (auto& group : groups) {
+            int need = static_cast<int>(group.size());
+            auto fit = std::find_if(owned.begin(), owned.end(),
+                [&shards, need](size_t s) { return shards[s].capacity >= need; });
+            if (fit != owned.end()) {
+                shards[*fit].capacity -= need;
+                shards[*fit].majorGroups.push_back(group);
+                continue;
+            }
+            size_t next = 0;
+            for (size_t s : owned) {
+                if (next >= group.size()) break;
+                int take = std::min(shards[s].capacity, static_cast<int>(group.size() - next));
+                if (take <= 0) continue;
+                shards[s].majorGroups.push_back(std::vector<size_t>(group.begin() + next, group.begin() + next + take));
+                shards[s].capacity -= take;
+                next += take;
+            }
+        }
+    }
+
+    //5. 各分片并行装箱（分片之间不共享宿舍，也不写同一个学生）
+    int threadCount = constraints.threadCount > 0 ? constraints.threadCount
+        : static_cast<int>(std::thread::hardware_concurrency());
+    if (threadCount < 1) threadCount = 1;
+    threadCount = std::min(threadCount, static_cast<int>(shards.size()));
+
+    std::atomic<size_t> nextShard(0);
+    auto worker = [&]() {
+        for (size_t s = nextShard.fetch_add(1); s < shards.size(); s = nextShard.fetch_add(1)) {
+            packShard(shards[s], dormOfStudent);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threadCount; ++i) workers.emplace_back(worker);
+    worker();
+    for (auto& t : workers) t.join();
+
+    //6. 汇总结果
+    for (const auto& genderItem : byGender) {
+        for (size_t index : genderItem.second) {
+            Student student = students[index];
+            if (dormOfStudent[index].empty()) {
+                result.unassigned.push_back(student);
+                continue;
+            }
+            student.dormId = dormOfStudent[index];
+            result.dormDelta[student.dormId]++;
+            result.assigned.push_back(student);
+        }
+    }
+    return true;
+}
+
+//计算并提交
+bool DormAssignment::run(const std::vector<Student>& students, const AssignmentConstraints& constraints,
+    AssignmentResult& result) {
+    if (!solve(students, constraints, result)) return false;
+    if (result.assigned.empty()) return true;
+
+    StudentManager studentMgr;
+    if (!studentMgr.addStudentsBulk(result.assigned)) {
+        lastError = studentMgr.getLastError();
+        return false;
+    }
+    return true;
+}
+
+//读取名单文件后分配并提交
+bool DormAssignment::runFile(const std::string& filePath, const AssignmentConstraints& constraints,
+    AssignmentResult& result) {
+    lastError.clear();
+    result = AssignmentResult();
+
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        lastError = "无法打开名单文件：" + filePath;
+        return false;
+    }
+
+    std::vector<Student> students;
+    std::vector<std::string> rejected;
+    std::string line;
+    bool utf8 = false;
+    for (size_t lineNo = 1; std::getline(file, line); ++lineNo) {
+        //带BOM的UTF-8文件（如Excel导出）转为程序使用的GBK
+        if (lineNo == 1 && line.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+            utf8 = true;
+            line.erase(0, 3);
+        }
+        if (utf8) line = Transcode::utf8ToGbk(line);
+        std::string trimmed = Common::trim(line);
+        if (trimmed.empty()) continue;
+        if (lineNo == 1 && Common::startsWith(Common::toLower(trimmed), "student_id")) continue;
+
+        Student student;
+        std::string err;
+        if (!parseLine(line, student, err)) {
+            if (rejected.size() < MAX_REJECTED_LINES) rejected.push_back("第" + std::to_string(lineNo) + "行：" + err);
+            continue;
+        }
+        students.push_back(student);
+    }
+
+    bool ok = run(students, constraints, result);
+    result.rejectedLines = rejected;
+    return ok;
+}
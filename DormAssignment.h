@@ -0,0 +1,81 @@
+#ifndef DORMASSIGNMENT_H
+#define DORMASSIGNMENT_H
+
+#include "StudentManager.h"
+#include <string>
+#include <vector>
+#include <map>
+
+// 批量分配约束
+struct AssignmentConstraints {
+    std::map<std::string, std::string> dormGender; // 宿舍号 → 限定性别（"男"/"女"），未列出的按现有住户推断
+    std::vector<std::string> preferredBuildings;   // 按优先级排列的楼栋，为空表示全部楼栋
+    std::string roomType;                          // 限定房间类型（4/6/8），为空不限
+    bool keepMajorsTogether;                       // 同专业尽量住同一楼栋、同一宿舍
+    int threadCount;                               // 工作线程数，0表示按CPU核数
+
+    AssignmentConstraints() : keepMajorsTogether(true), threadCount(0) {}
+};
+
+// 批量分配结果
+struct AssignmentResult {
+    std::vector<Student> assigned;           // 已分配宿舍的学生（dormId已填写）
+    std::vector<Student> unassigned;         // 无法分配的学生
+    std::map<std::string, int> dormDelta;    // 宿舍号 → 新增人数
+    std::vector<std::string> rejectedLines;  // 名单文件中格式错误的行（最多保留100条）
+};
+
+// --------------- 新生批量分配宿舍 ---------------
+// 先按性别划分宿舍池，再把各专业整体分配到楼栋（分片），
+// 各分片内的床位装箱由多个线程并行完成，最后一次性批量写入。
+class DormAssignment {
+public:
+    // 计算分配方案（不写数据库），返回false表示读取宿舍数据失败
+    bool solve(const std::vector<Student>& students, const AssignmentConstraints& constraints,
+        AssignmentResult& result);
+
+    // 计算并提交：批量写入学生，每个宿舍只更新一次入住人数
+    bool run(const std::vector<Student>& students, const AssignmentConstraints& constraints,
+        AssignmentResult& result);
+
+    // 读取新生名单CSV（student_id,student_name,gender,age,major[,student_phone[,check_in_date]]）后分配并提交，
+    // 格式错误的行跳过并记入result.rejectedLines
+    bool runFile(const std::string& filePath, const AssignmentConstraints& constraints, AssignmentResult& result);
+
+    // 获取最近一次错误信息
+    std::string getLastError() const { return lastError; }
+
+private:
+    std::string lastError;
+
+    // 可分配的宿舍
+    struct DormSlot {
+        std::string dormId;
+        std::string building;
+        std::string roomType;
+        int freeBeds;
+        std::string gender; // 已确定的性别，空表示尚未确定
+    };
+
+    // 同一楼栋、同一性别的分片
+    struct Shard {
+        std::string gender;
+        std::string building;
+        std::vector<DormSlot*> dorms;
+        std::vector<std::vector<size_t>> majorGroups; // 分到本分片的各专业学生下标
+        int capacity;
+
+        Shard() : capacity(0) {}
+    };
+
+    // 解析名单文件的一行，失败返回false并写入err
+    static bool parseLine(const std::string& line, Student& student, std::string& err);
+
+    // 读取宿舍容量和现有住户性别
+    bool loadDorms(const AssignmentConstraints& constraints, std::vector<DormSlot>& dorms);
+
+    // 分片内装箱（各线程独立执行，只修改本分片的宿舍）
+    static void packShard(Shard& shard, std::vector<std::string>& dormOfStudent);
+};
+
+#endif // DORMASSIGNMENT_H
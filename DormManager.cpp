@@ -1,6 +1,14 @@
 #include "DormManager.h"
 #include "Common.h"
 #include "DBHelper.h"
+#include "ExistenceCache.h"
+#include "OccupancyTable.h"
+#include "FreeBedIndex.h"
+#include "FeeRollup.h"
+#include "ArrearsIndex.h"
+#include "PageCache.h"
+#include "AuditJournal.h"
+#include "ChangeFeed.h"
 #include <sstream>
 #include <algorithm>
 
@@ -119,6 +127,17 @@ int DormManager::getDefaultMaxCapacity(const std::string& roomType) {
     return 0;
 }
 
+//宿舍的各列值（列名与数据库一致），用于审计日志和变更通知
+static AuditValues dormColumns(const Dorm& dorm) {
+    return AuditValues{
+        { "building", Common::trim(dorm.building) },
+        { "room_type", Common::trim(dorm.roomType) },
+        { "max_capacity", std::to_string(dorm.maxCapacity) },
+        { "current_occupancy", std::to_string(dorm.currentOccupancy) },
+        { "dorm_manager", Common::trim(dorm.dormManager) }
+    };
+}
+
 //添加宿舍实现
 bool DormManager::addDorm(const Dorm& dorm) {
     lastError.clear();
@@ -127,8 +146,7 @@ bool DormManager::addDorm(const Dorm& dorm) {
         return false;
     }
     //检查宿舍号是否已存在
-    Dorm existDorm = getDormById(dorm.dormId);
-    if (!existDorm.dormId.empty()) {
+    if (ExistenceCache::getInstance().isDormExist(dorm.dormId)) {
         lastError = "添加失败：宿舍号" + dorm.dormId + "已存在！";
         return false;
     }
@@ -162,6 +180,16 @@ bool DormManager::addDorm(const Dorm& dorm) {
         return false;
     }
 
+    //同步入住计数表和空床索引，记录审计日志并发布变更
+    if (affectedRows > 0) {
+        OccupancyTable::getInstance().set(dorm.dormId, dorm.currentOccupancy, dorm.maxCapacity);
+        FreeBedIndex::getInstance().addDorm(dorm);
+        ChangeValues columns = dormColumns(dorm);
+        std::string trimmedId = Common::trim(dorm.dormId);
+        AuditJournal::getInstance().recordInsert(AuditEntity::DORM, trimmedId, columns);
+        ChangeFeed::getInstance().publishInsert(ChangeTable::DORM, trimmedId, columns);
+    }
+
     return affectedRows >= 0;
 }
 
@@ -204,6 +232,23 @@ bool DormManager::updateDorm(const Dorm& dorm) {
         lastError = "修改失败：" + dbErr.errorMsg;
         return false;
     }
+
+    //同步入住计数表、空床索引，以及费用汇总和欠费索引的楼栋
+    OccupancyTable::getInstance().set(dorm.dormId, dorm.currentOccupancy, dorm.maxCapacity);
+    FreeBedIndex::getInstance().updateDorm(dorm);
+    //楼栋缓存由存在性缓存订阅变更后更新
+    if (Common::trim(existDorm.building) != Common::trim(dorm.building)) {
+        FeeRollup::getInstance().onDormBuildingChanged(dorm.dormId, dorm.building);
+        ArrearsIndex::getInstance().onDormBuildingChanged(dorm.dormId, dorm.building);
+    }
+
+    //审计日志和变更通知
+    if (affectedRows > 0) {
+        ChangeValues before = dormColumns(existDorm);
+        ChangeValues after = dormColumns(dorm);
+        AuditJournal::getInstance().recordUpdate(AuditEntity::DORM, existDorm.dormId, before, after);
+        ChangeFeed::getInstance().publishUpdate(ChangeTable::DORM, existDorm.dormId, before, after);
+    }
     return affectedRows >= 0;
 }
 //删除宿舍实现
@@ -246,6 +291,15 @@ bool DormManager::deleteDorm(const std::string& dormId) {
         return false;
     }
 
+    //同步入住计数表和空床索引，记录审计日志并发布变更
+    if (affectedRows > 0) {
+        OccupancyTable::getInstance().remove(trimmedId);
+        FreeBedIndex::getInstance().removeDorm(trimmedId);
+        ChangeValues columns = dormColumns(existDorm);
+        AuditJournal::getInstance().recordRemove(AuditEntity::DORM, trimmedId, columns);
+        ChangeFeed::getInstance().publishRemove(ChangeTable::DORM, trimmedId, columns);
+    }
+
     return affectedRows >= 0;
 }
 
@@ -426,41 +480,104 @@ bool DormManager::updateCurrentCount(const std::string& dormId, int changeNum) {
         return false;
     }
 
-    //2. 检查宿舍是否存在
+    //2. 先在进程内计数表中原子预占（越界直接拒绝，无需访问数据库）
+    OccupancyTable& occTable = OccupancyTable::getInstance();
+    bool tracked = false;
+    if (occTable.ensureLoaded()) {
+        int occupancy = 0, maxCapacity = 0;
+        OccupancyAdjust adjust = occTable.tryAdjust(trimmedId, changeNum);
+        if (adjust == OccupancyAdjust::UNDERFLOW) {
+            lastError = "更新失败：当前入住人数不能为负数！";
+            return false;
+        }
+        if (adjust == OccupancyAdjust::OVERFLOW) {
+            occTable.get(trimmedId, occupancy, maxCapacity);
+            lastError = "更新失败：当前入住人数不能超过最大容纳人数（" + std::to_string(maxCapacity) + "人）！";
+            return false;
+        }
+        tracked = (adjust == OccupancyAdjust::OK);
+    }
+    FreeBedIndex& freeBeds = FreeBedIndex::getInstance();
+    if (tracked) freeBeds.refresh(trimmedId);
+
+    //3. 单条条件UPDATE，由数据库保证结果在[0, 最大容量]内
+    std::ostringstream sqlStream;
+    sqlStream << "UPDATE dorm SET current_occupancy = current_occupancy + " << changeNum
+        << " WHERE dorm_id = '" << trimmedId << "'"
+        << " AND current_occupancy + " << changeNum << " BETWEEN 0 AND max_capacity";
+
+    int affectedRows = DBHelper::getInstance().executeUpdate(sqlStream.str());
+    if (affectedRows == -1) {
+        if (tracked) {
+            occTable.forceAdjust(trimmedId, -changeNum);
+            freeBeds.refresh(trimmedId);
+        }
+        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
+        lastError = "更新失败：" + dbErr.errorMsg;
+        return false;
+    }
+
+    //分页缓存失效
+    PageCacheVersion::invalidate(PageScreen::DORM);
+
+    if (affectedRows > 0) {
+        return true;
+    }
+
+    //4. 未更新任何行：宿舍不存在或数据库中的人数与计数表不一致，撤销预占并按数据库重新同步
+    if (tracked) occTable.forceAdjust(trimmedId, -changeNum);
     Dorm existDorm = getDormById(trimmedId);
     if (existDorm.dormId.empty()) {
+        occTable.remove(trimmedId);
+        freeBeds.removeDorm(trimmedId);
         lastError = "更新失败：未查询到宿舍号" + trimmedId + "对应的宿舍！";
         return false;
     }
-
-    //3. 计算新的入住人数（确保非负且不超过最大容量）
-    int newCount = existDorm.currentOccupancy + changeNum;
-    if (newCount < 0) {
+    occTable.set(trimmedId, existDorm.currentOccupancy, existDorm.maxCapacity);
+    freeBeds.refresh(trimmedId);
+    if (existDorm.currentOccupancy + changeNum < 0) {
         lastError = "更新失败：当前入住人数不能为负数！";
-        return false;
     }
-    if (newCount > existDorm.maxCapacity) {
+    else {
         lastError = "更新失败：当前入住人数不能超过最大容纳人数（" + std::to_string(existDorm.maxCapacity) + "人）！";
-        return false;
     }
+    return false;
+}
 
-    //构建UPDATE SQL
-    std::ostringstream sqlStream;
-    sqlStream << "UPDATE dorm SET current_occupancy = " << newCount << " WHERE dorm_id = '" << trimmedId << "'";
+//空床查询实现
+std::vector<Dorm> DormManager::findDormsWithFreeBeds(const std::string& building, const std::string& roomType,
+    int minFree, int limit) {
+    lastError.clear();
+    std::vector<Dorm> dormList;
 
-    //执行SQL
-    int affectedRows = DBHelper::getInstance().executeUpdate(sqlStream.str());
-    if (affectedRows == -1) {
-        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
-        lastError = "更新失败：" + dbErr.errorMsg;
-        return false;
+    std::string trimmedBuilding = Common::trim(building);
+    if (trimmedBuilding.empty()) {
+        lastError = "楼栋不能为空！";
+        return dormList;
     }
-    //显式提交事务，确保数据立即更新
-    if (affectedRows > 0) {
-        DBHelper::getInstance().commitTransaction();
+    std::string trimmedType = Common::trim(roomType);
+    if (!trimmedType.empty() && trimmedType != "4" && trimmedType != "6" && trimmedType != "8") {
+        lastError = "房间类型错误（仅支持数字4、6、8）！";
+        return dormList;
     }
 
-    return affectedRows >= 0;
+    FreeBedIndex& freeBeds = FreeBedIndex::getInstance();
+    if (!freeBeds.ensureLoaded()) {
+        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
+        lastError = "查询失败：" + dbErr.errorMsg;
+        return dormList;
+    }
+
+    OccupancyTable& occTable = OccupancyTable::getInstance();
+    for (const auto& entry : freeBeds.findFree(trimmedBuilding, trimmedType, minFree, limit)) {
+        Dorm dorm;
+        dorm.dormId = entry.dormId;
+        dorm.building = entry.building;
+        dorm.roomType = entry.roomType;
+        occTable.get(entry.dormId, dorm.currentOccupancy, dorm.maxCapacity);
+        dormList.push_back(dorm);
+    }
+    return dormList;
 }
 
 //获取最后一次操作错误信息实现
@@ -47,7 +47,11 @@ public:
     //获取指定楼栋的宿舍数量（用于分页计算）
     int getBuildingDormCount(const std::string& building);
     //更新当前住宿人数（学生入住/退宿时调用，返回true成功）
+    //单条条件UPDATE原子完成，并同步进程内计数表，可多线程并发调用
     bool updateCurrentCount(const std::string& dormId, int changeNum);
+    //查询楼栋中空床数不少于minFree的前limit个宿舍（roomType为空表示不限类型）
+    std::vector<Dorm> findDormsWithFreeBeds(const std::string& building, const std::string& roomType,
+        int minFree, int limit);
     //获取最近一次错误信息
     std::string getLastError() const;
 
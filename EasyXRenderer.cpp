@@ -0,0 +1,44 @@
+#include "EasyXRenderer.h"
+#include "Common.h"
+#include <graphics.h>
+
+extern const int APP_WIN_W;
+extern const int APP_WIN_H;
+extern IMAGE g_backgroundImage;
+extern bool g_backgroundLoaded;
+
+void EasyXRenderer::execute(const RenderCommand& command) {
+    switch (command.op) {
+    case RenderOp::TEXT:
+        settextstyle(command.fontSize, 0, "宋体");
+        setbkmode(TRANSPARENT);
+        settextcolor(command.color);
+        outtextxy(command.x1, command.y1, _T(command.text.c_str()));
+        break;
+    case RenderOp::RECT:
+        setlinecolor(command.color);
+        rectangle(command.x1, command.y1, command.x2, command.y2);
+        break;
+    case RenderOp::FILL_RECT:
+        setlinecolor(command.color);
+        setfillcolor(command.fillColor);
+        fillrectangle(command.x1, command.y1, command.x2, command.y2);
+        break;
+    case RenderOp::LINE:
+        setlinecolor(command.color);
+        line(command.x1, command.y1, command.x2, command.y2);
+        break;
+    case RenderOp::IMAGE:
+        //目前只有背景图片一种贴图
+        if (command.imageId == RENDER_IMAGE_BACKGROUND && g_backgroundLoaded) {
+            putimage(command.x1, command.y1, command.x2, command.y2, &g_backgroundImage, command.x1, command.y1);
+        }
+        else {
+            setfillcolor(COLOR_BG_MAIN);
+            solidrectangle(command.x1, command.y1, command.x1 + command.x2, command.y1 + command.y2);
+        }
+        break;
+    default:
+        break;
+    }
+}
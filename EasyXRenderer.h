@@ -0,0 +1,13 @@
+#ifndef EASYXRENDERER_H
+#define EASYXRENDERER_H
+
+#include "RenderCommands.h"
+
+// --------------- EasyX绘制后端 ---------------
+// 把绘制命令转换为EasyX调用；背景贴图使用main.cpp加载的背景图片，未加载时用背景色填充。
+class EasyXRenderer : public RenderBackend {
+public:
+    void execute(const RenderCommand& command) override;
+};
+
+#endif // EASYXRENDERER_H
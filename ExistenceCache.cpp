@@ -0,0 +1,169 @@
+#include "ExistenceCache.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include "ChangeFeed.h"
+
+ExistenceCache& ExistenceCache::getInstance() {
+    static ExistenceCache instance;
+    return instance;
+}
+
+//扫描主键列，建立布隆过滤器和键集合
+bool ExistenceCache::scanKeys(const std::string& sql, KeySet& set,
+    std::unordered_map<std::string, std::string>* values) {
+    std::vector<std::string> keyList;
+    int64_t rows = DBHelper::getInstance().executeQueryStream(sql, [&keyList, values](const DBRowView& row) {
+        keyList.push_back(row.getString(0));
+        if (values != nullptr) (*values)[keyList.back()] = row.getString(1);
+    });
+    if (rows < 0) return false;
+
+    //预留一倍余量，避免后续新增导致误判率上升
+    set.bloom.reset(keyList.size() * 2);
+    set.keys.clear();
+    set.keys.reserve(keyList.size() * 2);
+    for (const auto& key : keyList) {
+        set.bloom.add(key);
+        set.keys.insert(key);
+    }
+    return true;
+}
+
+bool ExistenceCache::rebuild() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+
+    KeySet newStudents;
+    KeySet newDorms;
+    std::unordered_map<std::string, std::string> newBuildings;
+    if (!scanKeys("SELECT student_id FROM student", newStudents)) return false;
+    if (!scanKeys("SELECT dorm_id, IFNULL(building, '') FROM dorm", newDorms, &newBuildings)) return false;
+
+    students = std::move(newStudents);
+    dorms = std::move(newDorms);
+    buildingOfDorm.swap(newBuildings);
+    loaded = true;
+    return true;
+}
+
+bool ExistenceCache::ensureLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (loaded) return true;
+    }
+    return rebuild();
+}
+
+bool ExistenceCache::contains(const KeySet& set, const std::string& key) {
+    //布隆过滤器判定不存在则无需再查
+    if (!set.bloom.mayContain(key)) return false;
+    return set.keys.count(key) > 0;
+}
+
+bool ExistenceCache::queryExist(const std::string& table, const std::string& column, const std::string& key) {
+    std::string sql = "SELECT " + column + " FROM " + table + " WHERE " + column + " = '" + key + "' LIMIT 1";
+    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
+    if (result == nullptr) return false;
+
+    bool exist = result->rowCount > 0;
+    DBHelper::getInstance().freeResultset(result);
+    return exist;
+}
+
+bool ExistenceCache::isStudentExist(const std::string& studentId) {
+    std::string trimmedId = Common::trim(studentId);
+    if (trimmedId.empty()) return false;
+
+    if (!ensureLoaded()) {
+        return queryExist("student", "student_id", trimmedId);
+    }
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return contains(students, trimmedId);
+}
+
+bool ExistenceCache::isDormExist(const std::string& dormId) {
+    std::string trimmedId = Common::trim(dormId);
+    if (trimmedId.empty()) return false;
+
+    if (!ensureLoaded()) {
+        return queryExist("dorm", "dorm_id", trimmedId);
+    }
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return contains(dorms, trimmedId);
+}
+
+std::string ExistenceCache::getBuildingOfDorm(const std::string& dormId) {
+    std::string trimmedId = Common::trim(dormId);
+    if (trimmedId.empty()) return "";
+
+    if (!ensureLoaded()) {
+        //缓存不可用，单独查询一次
+        std::string building;
+        DBHelper::getInstance().executeQueryStream("SELECT building FROM dorm WHERE dorm_id = '" + trimmedId + "'",
+            [&building](const DBRowView& row) {
+                building = row.getString(0);
+            });
+        return building;
+    }
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = buildingOfDorm.find(trimmedId);
+    return it != buildingOfDorm.end() ? it->second : "";
+}
+
+void ExistenceCache::addStudent(const std::string& studentId) {
+    std::string trimmedId = Common::trim(studentId);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!loaded || trimmedId.empty()) return;
+    if (students.keys.insert(trimmedId).second) {
+        students.bloom.add(trimmedId);
+    }
+}
+
+void ExistenceCache::removeStudent(const std::string& studentId) {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!loaded) return;
+    //布隆过滤器不支持删除，只需从键集合移除
+    students.keys.erase(Common::trim(studentId));
+}
+
+void ExistenceCache::addDorm(const std::string& dormId, const std::string& building) {
+    std::string trimmedId = Common::trim(dormId);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!loaded || trimmedId.empty()) return;
+    if (dorms.keys.insert(trimmedId).second) {
+        dorms.bloom.add(trimmedId);
+    }
+    buildingOfDorm[trimmedId] = Common::trim(building);
+}
+
+void ExistenceCache::setDormBuilding(const std::string& dormId, const std::string& building) {
+    std::string trimmedId = Common::trim(dormId);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!loaded || dorms.keys.count(trimmedId) == 0) return;
+    buildingOfDorm[trimmedId] = Common::trim(building);
+}
+
+void ExistenceCache::removeDorm(const std::string& dormId) {
+    std::string trimmedId = Common::trim(dormId);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    if (!loaded) return;
+    dorms.keys.erase(trimmedId);
+    buildingOfDorm.erase(trimmedId);
+}
+
+void ExistenceCache::subscribeChanges() {
+    static std::once_flag once;
+    std::call_once(once, [this]() {
+        //写入后紧接着的存在性检查（如批量导入查重）必须看到结果，同步处理
+        ChangeFeed::getInstance().subscribe("存在性缓存", ChangeDelivery::INLINE, [this](const ChangeEvent& event) {
+            if (event.table == ChangeTable::STUDENT) {
+                if (event.kind == ChangeKind::INSERT) addStudent(event.key);
+                else if (event.kind == ChangeKind::REMOVE) removeStudent(event.key);
+            }
+            else if (event.table == ChangeTable::DORM) {
+                if (event.kind == ChangeKind::INSERT) addDorm(event.key, event.value("building"));
+                else if (event.kind == ChangeKind::REMOVE) removeDorm(event.key);
+                else if (event.isChanged("building")) setDormBuilding(event.key, event.value("building"));
+            }
+        });
+    });
+}
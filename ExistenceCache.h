@@ -0,0 +1,73 @@
+#ifndef EXISTENCECACHE_H
+#define EXISTENCECACHE_H
+
+#include "BloomFilter.h"
+#include <string>
+#include <unordered_set>
+#include <unordered_map>
+#include <mutex>
+
+// --------------- 学生/宿舍存在性缓存（单例）---------------
+// 布隆过滤器直接回答"不存在"，正向键集合确认"存在"；
+// 同时保存宿舍所在楼栋，供按楼栋统计的各模块共用。
+// 订阅学生和宿舍的数据变更保持同步，也可通过流式扫描重建。
+class ExistenceCache {
+public:
+    static ExistenceCache& getInstance();
+
+    // 校验学号是否存在
+    bool isStudentExist(const std::string& studentId);
+
+    // 校验宿舍号是否存在
+    bool isDormExist(const std::string& dormId);
+
+    // 查询宿舍所在楼栋（宿舍不存在返回空串）
+    std::string getBuildingOfDorm(const std::string& dormId);
+
+    // 写操作后同步
+    void addStudent(const std::string& studentId);
+    void removeStudent(const std::string& studentId);
+    void addDorm(const std::string& dormId, const std::string& building);
+    void setDormBuilding(const std::string& dormId, const std::string& building);
+    void removeDorm(const std::string& dormId);
+
+    // 订阅学生和宿舍的新增、删除及宿舍改楼栋（启动时调用一次）
+    void subscribeChanges();
+
+    // 从数据库流式扫描重建（返回true成功）
+    bool rebuild();
+
+    // 缓存是否已加载
+    bool isLoaded() const { return loaded; }
+
+private:
+    ExistenceCache() : loaded(false) {}
+    ExistenceCache(const ExistenceCache&) = delete;
+    ExistenceCache& operator=(const ExistenceCache&) = delete;
+
+    struct KeySet {
+        BloomFilter bloom;                   // 否定判断
+        std::unordered_set<std::string> keys; // 正向确认
+    };
+
+    std::mutex cacheMutex;
+    KeySet students;
+    KeySet dorms;
+    std::unordered_map<std::string, std::string> buildingOfDorm; // 宿舍号 → 楼栋
+    bool loaded;
+
+    // 首次使用时加载
+    bool ensureLoaded();
+
+    // 在键集合中查找
+    static bool contains(const KeySet& set, const std::string& key);
+
+    // 缓存不可用时回退到数据库查询
+    static bool queryExist(const std::string& table, const std::string& column, const std::string& key);
+
+    // 扫描一张表的主键到键集合（有第二列时记入values）
+    static bool scanKeys(const std::string& sql, KeySet& set,
+        std::unordered_map<std::string, std::string>* values = nullptr);
+};
+
+#endif // EXISTENCECACHE_H
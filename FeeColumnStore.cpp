@@ -0,0 +1,351 @@
+#include "FeeColumnStore.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <map>
+#include <numeric>
+
+//AVX2内核的编译条件：MSVC可直接使用内建函数，GCC/Clang按函数开启目标指令集
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#include <immintrin.h>
+#define FEE_AVX2_TARGET
+#define FEE_HAS_AVX2_KERNEL 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FEE_AVX2_TARGET __attribute__((target("avx2")))
+#define FEE_HAS_AVX2_KERNEL 1
+#else
+#define FEE_HAS_AVX2_KERNEL 0
+#endif
+
+// ---------------- CPU检测 ----------------
+static bool detectAvx2() {
+#if FEE_HAS_AVX2_KERNEL
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; //操作系统需保存YMM寄存器
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+#else
+    return false;
+#endif
+}
+
+static const bool g_cpuHasAvx2 = detectAvx2();
+static std::atomic<bool> g_simdEnabled(g_cpuHasAvx2);
+
+bool FeeColumnStore::isSimdEnabled() {
+    return g_simdEnabled.load();
+}
+
+void FeeColumnStore::setSimdEnabled(bool enabled) {
+    g_simdEnabled.store(enabled && g_cpuHasAvx2);
+}
+
+// ---------------- 标量内核 ----------------
+static int64_t sumScalar(const int64_t* values, size_t begin, size_t end) {
+    int64_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4) {
+        sum0 += values[i];
+        sum1 += values[i + 1];
+        sum2 += values[i + 2];
+        sum3 += values[i + 3];
+    }
+    for (; i < end; ++i) sum0 += values[i];
+    return sum0 + sum1 + sum2 + sum3;
+}
+
+static inline bool testBit(const uint64_t* bits, size_t i) {
+    return ((bits[i >> 6] >> (i & 63)) & 1) != 0;
+}
+
+static int64_t maskedSumScalar(const int64_t* values, const uint64_t* bits, size_t begin, size_t end) {
+    int64_t sum = 0;
+    for (size_t i = begin; i < end; ++i) {
+        //用掩码代替分支：位为1时取全1
+        sum += values[i] & -static_cast<int64_t>(testBit(bits, i));
+    }
+    return sum;
+}
+
+static int64_t countBits(const uint64_t* bits, size_t begin, size_t end) {
+    if (begin >= end) return 0;
+    size_t firstWord = begin >> 6;
+    size_t lastWord = (end - 1) >> 6;
+    int64_t count = 0;
+    for (size_t w = firstWord; w <= lastWord; ++w) {
+        uint64_t word = bits[w];
+        if (w == firstWord) word &= ~0ull << (begin & 63);
+        if (w == lastWord && (end & 63) != 0) word &= ~0ull >> (64 - (end & 63));
+        count += static_cast<int64_t>(std::bitset<64>(word).count());
+    }
+    return count;
+}
+
+// ---------------- AVX2内核 ----------------
+#if FEE_HAS_AVX2_KERNEL
+//4位状态 → 4个64位通道的掩码
+alignas(32) static const int64_t kNibbleMasks[16][4] = {
+    {  0,  0,  0,  0 }, { -1,  0,  0,  0 }, {  0, -1,  0,  0 }, { -1, -1,  0,  0 },
+    {  0,  0, -1,  0 }, { -1,  0, -1,  0 }, {  0, -1, -1,  0 }, { -1, -1, -1,  0 },
+    {  0,  0,  0, -1 }, { -1,  0,  0, -1 }, {  0, -1,  0, -1 }, { -1, -1,  0, -1 },
+    {  0,  0, -1, -1 }, { -1,  0, -1, -1 }, {  0, -1, -1, -1 }, { -1, -1, -1, -1 }
+};
+
+FEE_AVX2_TARGET static int64_t horizontalSum(__m256i v) {
+    alignas(32) int64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+FEE_AVX2_TARGET static int64_t sumAvx2(const int64_t* values, size_t begin, size_t end) {
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8) {
+        acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i + 4)));
+    }
+    int64_t sum = horizontalSum(_mm256_add_epi64(acc0, acc1));
+    for (; i < end; ++i) sum += values[i];
+    return sum;
+}
+
+FEE_AVX2_TARGET static int64_t maskedSumAvx2(const int64_t* values, const uint64_t* bits, size_t begin, size_t end) {
+    int64_t sum = 0;
+    size_t i = begin;
+    //先用标量对齐到4行边界，保证每次取出的4位不跨字
+    for (; i < end && (i & 3) != 0; ++i) {
+        sum += values[i] & -static_cast<int64_t>(testBit(bits, i));
+    }
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= end; i += 4) {
+        unsigned nibble = static_cast<unsigned>((bits[i >> 6] >> (i & 63)) & 0xF);
+        __m256i mask = _mm256_load_si256(reinterpret_cast<const __m256i*>(kNibbleMasks[nibble]));
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+        acc = _mm256_add_epi64(acc, _mm256_and_si256(v, mask));
+    }
+    sum += horizontalSum(acc);
+    for (; i < end; ++i) {
+        sum += values[i] & -static_cast<int64_t>(testBit(bits, i));
+    }
+    return sum;
+}
+#endif
+
+// ---------------- 区段汇总 ----------------
+void FeeColumnStore::accumulate(size_t begin, size_t end, FeeGroupTotals& out) const {
+    if (begin >= end) return;
+    const int64_t* values = totalCents.data();
+    const uint64_t* bits = paidBits.data();
+
+    int64_t total = 0, paid = 0;
+#if FEE_HAS_AVX2_KERNEL
+    if (g_simdEnabled.load(std::memory_order_relaxed)) {
+        total = sumAvx2(values, begin, end);
+        paid = maskedSumAvx2(values, bits, begin, end);
+    }
+    else
+#endif
+    {
+        total = sumScalar(values, begin, end);
+        paid = maskedSumScalar(values, bits, begin, end);
+    }
+    int64_t paidCount = countBits(bits, begin, end);
+
+    out.totalCents += total;
+    out.paidCents += paid;
+    out.unpaidCents += total - paid;
+    out.paidCount += paidCount;
+    out.unpaidCount += static_cast<int64_t>(end - begin) - paidCount;
+}
+
+// ---------------- 加载与编码 ----------------
+void FeeColumnStore::append(const std::string& feeMonth, const std::string& dormId, const std::string& building,
+    int64_t cents, bool paid) {
+    pending.push_back(PendingRow{ feeMonth, dormId, building, cents, paid });
+}
+
+void FeeColumnStore::finalize() {
+    //已有的列数据与新行一起重新编码
+    for (size_t i = 0; i < totalCents.size(); ++i) {
+        uint32_t dormCode = dormCodes[i];
+        pending.push_back(PendingRow{ months[monthCodes[i]], dorms[dormCode],
+            buildings[buildingOfDorm[dormCode]], totalCents[i], testBit(paidBits.data(), i) });
+    }
+
+    //建立字典（月份、楼栋按字典序，编码顺序即排序顺序）
+    std::map<std::string, uint16_t> monthDict, buildingDict;
+    std::map<std::string, uint32_t> dormDict;
+    for (const auto& row : pending) {
+        monthDict.emplace(row.feeMonth, 0);
+        buildingDict.emplace(row.building, 0);
+        dormDict.emplace(row.dormId, 0);
+    }
+    months.clear();
+    buildings.clear();
+    dorms.clear();
+    for (auto& item : monthDict) { item.second = static_cast<uint16_t>(months.size()); months.push_back(item.first); }
+    for (auto& item : buildingDict) { item.second = static_cast<uint16_t>(buildings.size()); buildings.push_back(item.first); }
+    for (auto& item : dormDict) { item.second = static_cast<uint32_t>(dorms.size()); dorms.push_back(item.first); }
+
+    buildingOfDorm.assign(dorms.size(), 0);
+    for (const auto& row : pending) {
+        buildingOfDorm[dormDict[row.dormId]] = buildingDict[row.building];
+    }
+
+    //按(月份, 楼栋, 宿舍)排序
+    struct Coded {
+        uint16_t month;
+        uint16_t building;
+        uint32_t dorm;
+        size_t row;
+    };
+    std::vector<Coded> order;
+    order.reserve(pending.size());
+    for (size_t i = 0; i < pending.size(); ++i) {
+        const PendingRow& row = pending[i];
+        order.push_back(Coded{ monthDict[row.feeMonth], buildingDict[row.building], dormDict[row.dormId], i });
+    }
+    std::sort(order.begin(), order.end(), [](const Coded& a, const Coded& b) {
+        if (a.month != b.month) return a.month < b.month;
+        if (a.building != b.building) return a.building < b.building;
+        return a.dorm < b.dorm;
+    });
+
+    //填充列并记录区段
+    size_t rowCount = order.size();
+    totalCents.resize(rowCount);
+    monthCodes.resize(rowCount);
+    dormCodes.resize(rowCount);
+    paidBits.assign((rowCount + 63) / 64 + 1, 0);
+    runs.clear();
+    for (size_t i = 0; i < rowCount; ++i) {
+        const Coded& coded = order[i];
+        const PendingRow& row = pending[coded.row];
+        totalCents[i] = row.cents;
+        monthCodes[i] = coded.month;
+        dormCodes[i] = coded.dorm;
+        if (row.paid) paidBits[i >> 6] |= 1ull << (i & 63);
+
+        if (runs.empty() || runs.back().monthCode != coded.month || runs.back().buildingCode != coded.building) {
+            runs.push_back(Run{ coded.month, coded.building, i, i });
+        }
+        runs.back().end = i + 1;
+    }
+
+    pending.clear();
+    pending.shrink_to_fit();
+}
+
+bool FeeColumnStore::load() {
+    lastError.clear();
+    totalCents.clear();
+    paidBits.clear();
+    monthCodes.clear();
+    dormCodes.clear();
+    runs.clear();
+    pending.clear();
+
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT f.fee_month, f.dorm_id, IFNULL(d.building, ''), f.total_fee, f.pay_status "
+        "FROM fee f LEFT JOIN dorm d ON d.dorm_id = f.dorm_id",
+        [this](const DBRowView& row) {
+            int64_t cents = 0;
+            Common::parseCents(row.getString(3), cents);
+            append(row.getString(0), row.getString(1), row.getString(2), cents, row.getString(4) == "1");
+        });
+    if (rowCount < 0) {
+        lastError = "加载费用数据失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        pending.clear();
+        return false;
+    }
+    finalize();
+    return true;
+}
+
+// ---------------- 查询 ----------------
+FeeGroupTotals FeeColumnStore::totals() const {
+    FeeGroupTotals result;
+    result.key = "全部";
+    accumulate(0, size(), result);
+    return result;
+}
+
+std::vector<FeeGroupTotals> FeeColumnStore::groupByMonth() const {
+    std::vector<FeeGroupTotals> resultList;
+    size_t i = 0;
+    while (i < runs.size()) {
+        //同一月份的区段相邻，合并为一个连续行范围
+        size_t j = i;
+        while (j < runs.size() && runs[j].monthCode == runs[i].monthCode) ++j;
+        FeeGroupTotals group;
+        group.key = months[runs[i].monthCode];
+        accumulate(runs[i].begin, runs[j - 1].end, group);
+        resultList.push_back(group);
+        i = j;
+    }
+    return resultList;
+}
+
+std::vector<FeeGroupTotals> FeeColumnStore::groupByBuilding(const std::string& feeMonth) const {
+    std::vector<FeeGroupTotals> groups(buildings.size());
+    std::vector<char> used(buildings.size(), 0);
+
+    std::string trimmedMonth = Common::trim(feeMonth);
+    auto monthIt = std::lower_bound(months.begin(), months.end(), trimmedMonth);
+    bool filterMonth = !trimmedMonth.empty();
+    if (filterMonth && (monthIt == months.end() || *monthIt != trimmedMonth)) return std::vector<FeeGroupTotals>();
+    uint16_t monthCode = static_cast<uint16_t>(monthIt - months.begin());
+
+    for (const auto& run : runs) {
+        if (filterMonth && run.monthCode != monthCode) continue;
+        accumulate(run.begin, run.end, groups[run.buildingCode]);
+        used[run.buildingCode] = 1;
+    }
+
+    std::vector<FeeGroupTotals> resultList;
+    for (size_t b = 0; b < buildings.size(); ++b) {
+        if (!used[b]) continue;
+        groups[b].key = buildings[b];
+        resultList.push_back(groups[b]);
+    }
+    return resultList;
+}
+
+std::vector<FeeGroupTotals> FeeColumnStore::groupByDorm(const std::string& feeMonth) const {
+    std::vector<FeeGroupTotals> resultList;
+    std::string trimmedMonth = Common::trim(feeMonth);
+    auto monthIt = std::lower_bound(months.begin(), months.end(), trimmedMonth);
+    if (monthIt == months.end() || *monthIt != trimmedMonth) return resultList;
+    uint16_t monthCode = static_cast<uint16_t>(monthIt - months.begin());
+
+    //行按宿舍排序，宿舍在区段内也是连续的
+    for (const auto& run : runs) {
+        if (run.monthCode != monthCode) continue;
+        size_t i = run.begin;
+        while (i < run.end) {
+            size_t j = i;
+            while (j < run.end && dormCodes[j] == dormCodes[i]) ++j;
+            FeeGroupTotals group;
+            group.key = dorms[dormCodes[i]];
+            accumulate(i, j, group);
+            resultList.push_back(group);
+            i = j;
+        }
+    }
+    return resultList;
+}
@@ -0,0 +1,96 @@
+#ifndef FEECOLUMNSTORE_H
+#define FEECOLUMNSTORE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// 分组汇总结果（金额以分为单位）
+struct FeeGroupTotals {
+    std::string key;      // 分组键（月份/楼栋/宿舍号）
+    int64_t totalCents;   // 应收总额
+    int64_t paidCents;    // 已缴金额
+    int64_t unpaidCents;  // 未缴金额
+    int64_t paidCount;    // 已缴记录数
+    int64_t unpaidCount;  // 未缴记录数
+
+    FeeGroupTotals() : totalCents(0), paidCents(0), unpaidCents(0), paidCount(0), unpaidCount(0) {}
+};
+
+// --------------- 费用列式存储（分析用）---------------
+// 金额按int64分存储，缴费状态按位压缩，月份/宿舍/楼栋使用字典编码；
+// 行按(月份, 楼栋)排序并记录连续区段，分组汇总变为对区段的求和，
+// 求和内核在支持AVX2的CPU上使用向量指令，否则走标量实现。
+class FeeColumnStore {
+public:
+    FeeColumnStore() {}
+
+    // 从数据库流式加载全部费用（返回true成功）
+    bool load();
+
+    // 追加一行后需调用finalize才能查询（供测试数据或其他来源使用）
+    void append(const std::string& feeMonth, const std::string& dormId, const std::string& building,
+        int64_t totalCents, bool paid);
+    void finalize();
+
+    // 行数
+    size_t size() const { return totalCents.size(); }
+
+    // 全部汇总
+    FeeGroupTotals totals() const;
+
+    // 按月份分组
+    std::vector<FeeGroupTotals> groupByMonth() const;
+
+    // 按楼栋分组（feeMonth为空表示全部月份）
+    std::vector<FeeGroupTotals> groupByBuilding(const std::string& feeMonth = "") const;
+
+    // 按宿舍分组（指定月份）
+    std::vector<FeeGroupTotals> groupByDorm(const std::string& feeMonth) const;
+
+    // 是否使用AVX2内核；可关闭以对比标量实现
+    static bool isSimdEnabled();
+    static void setSimdEnabled(bool enabled);
+
+    // 获取最近一次错误信息
+    std::string getLastError() const { return lastError; }
+
+private:
+    // 列
+    std::vector<int64_t> totalCents;    // 金额（分）
+    std::vector<uint64_t> paidBits;     // 缴费状态位图（1为已缴）
+    std::vector<uint16_t> monthCodes;   // 月份字典编码
+    std::vector<uint32_t> dormCodes;    // 宿舍字典编码
+
+    // 字典
+    std::vector<std::string> months;        // 编码 → 月份（按月份排序）
+    std::vector<std::string> dorms;         // 编码 → 宿舍号
+    std::vector<std::string> buildings;     // 编码 → 楼栋
+    std::vector<uint16_t> buildingOfDorm;   // 宿舍编码 → 楼栋编码
+
+    // 同一(月份, 楼栋)的连续行区段
+    struct Run {
+        uint16_t monthCode;
+        uint16_t buildingCode;
+        size_t begin;
+        size_t end;
+    };
+    std::vector<Run> runs;
+
+    // 加载过程中的暂存行
+    struct PendingRow {
+        std::string feeMonth;
+        std::string dormId;
+        std::string building;
+        int64_t cents;
+        bool paid;
+    };
+    std::vector<PendingRow> pending;
+
+    std::string lastError;
+
+    // 对[begin, end)行求汇总并累加到out
+    void accumulate(size_t begin, size_t end, FeeGroupTotals& out) const;
+};
+
+#endif // FEECOLUMNSTORE_H
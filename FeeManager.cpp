@@ -1,9 +1,16 @@
 #include "FeeManager.h"
 #include "Common.h"
 #include "DBHelper.h"
+#include "ExistenceCache.h"
+#include "FeeRollup.h"
+#include "ArrearsIndex.h"
+#include "AuditJournal.h"
+#include "ChangeFeed.h"
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
+#include <map>
+#include <unordered_map>
 
 bool FeeManager::validateFee(const Fee& fee, bool isAdd) {
     lastError.clear();
@@ -26,7 +33,7 @@ bool FeeManager::validateFee(const Fee& fee, bool isAdd) {
         lastError = "学号格式不正确";
         return false;
     }
-    if (!isStudentExist(trimmedStuId)) {
+    if (!ExistenceCache::getInstance().isStudentExist(trimmedStuId)) {
         lastError = "学号" + trimmedStuId + "对应的学生不存在";
         return false;
     }
@@ -40,7 +47,7 @@ bool FeeManager::validateFee(const Fee& fee, bool isAdd) {
         lastError = "宿舍号格式不正确";
         return false;
     }
-    if (!isDormExist(trimmedDormId)) {
+    if (!ExistenceCache::getInstance().isDormExist(trimmedDormId)) {
         lastError = "宿舍号" + trimmedDormId + "不存在";
         return false;
     }
@@ -102,68 +109,58 @@ Fee FeeManager::rowToFee(const std::map<std::string, std::string>& row) {
     return fee;
 }
 
-//生成费用ID，自增
-std::string FeeManager::generateFeeId() {
-    Date now;
-    std::ostringstream dateStream;
-    dateStream << std::setfill('0') << std::setw(4) << now.year
-        << std::setw(2) << now.month;
-    std::string datePart = dateStream.str();
-
-    //查询当前月份的最大序号
-    std::ostringstream sqlStream;
-    sqlStream << "SELECT MAX(fee_id) AS max_id FROM fee WHERE fee_id LIKE 'F" << datePart << "%'";
+//费用的各列值（列名与数据库一致），用于审计日志和变更通知
+static AuditValues feeColumns(const Fee& fee) {
+    return AuditValues{
+        { "student_id", Common::trim(fee.studentId) },
+        { "dorm_id", Common::trim(fee.dormId) },
+        { "fee_month", Common::trim(fee.feeMonth) },
+        { "water_fee", Common::doubleToString(fee.waterFee) },
+        { "electric_fee", Common::doubleToString(fee.electricFee) },
+        { "total_fee", Common::doubleToString(fee.totalFee) },
+        { "pay_status", std::to_string(static_cast<int>(fee.payStatus)) },
+        { "pay_date", fee.payDate.isEmpty() ? std::string() : Common::dateToString(fee.payDate) }
+    };
+}
 
-    DBResultset* result = DBHelper::getInstance().executeQuery(sqlStream.str());
-    if (result == nullptr) {
-        return "F" + datePart + "0001"; //没有记录则从0001开始
-    }
+//学号和月份组成的键（每名学生每月一条费用）
+static std::string feeMonthKey(const Fee& fee) {
+    return Common::trim(fee.studentId) + "/" + Common::trim(fee.feeMonth);
+}
 
-    //获取最大序号并加1
-    int maxSeq = 0;
-    if (result->rowCount > 0 && !result->rows[0]["max_id"].empty()) {
-        std::string maxId = result->rows[0]["max_id"];
-        if (maxId.size() >= 10) {
-            std::string seqPart = maxId.substr(8); //提取后4位序号
-            Common::stringToInt(seqPart, maxSeq);
+//批量新增的费用ID由数据库自增列分配，提交后按(学号, 月份)读回，与修改、删除使用同一个fee_id
+static void readBackFeeIds(const std::vector<Fee>& fees, std::unordered_map<std::string, std::string>& feeIds) {
+    std::map<std::string, std::vector<std::string>> studentsOfMonth;
+    for (const auto& fee : fees) {
+        studentsOfMonth[Common::trim(fee.feeMonth)].push_back(Common::trim(fee.studentId));
+    }
+    const size_t idsPerQuery = 500;
+    for (const auto& item : studentsOfMonth) {
+        const std::vector<std::string>& students = item.second;
+        for (size_t begin = 0; begin < students.size(); begin += idsPerQuery) {
+            std::ostringstream sqlStream;
+            sqlStream << "SELECT student_id, fee_month, MAX(fee_id) FROM fee WHERE fee_month = '" << item.first
+                << "' AND student_id IN (";
+            size_t end = std::min(students.size(), begin + idsPerQuery);
+            for (size_t i = begin; i < end; ++i) {
+                sqlStream << (i > begin ? ", '" : "'") << students[i] << "'";
+            }
+            sqlStream << ") GROUP BY student_id, fee_month";
+            DBHelper::getInstance().executeQueryStream(sqlStream.str(), [&feeIds](const DBRowView& row) {
+                feeIds[row.getString(0) + "/" + row.getString(1)] = row.getString(2);
+            });
         }
     }
-
-    DBHelper::getInstance().freeResultset(result);
-    maxSeq++;
-
-    //生成4位序号
-    std::ostringstream seqStream;
-    seqStream << std::setfill('0') << std::setw(4) << maxSeq;
-    return "F" + datePart + seqStream.str();
-}
-
-//检查学生是否存在
-bool FeeManager::isStudentExist(const std::string& studentId) {
-    std::string trimmedId = Common::trim(studentId);
-    if (trimmedId.empty()) return false;
-
-    std::string sql = "SELECT student_id FROM student WHERE student_id = '" + trimmedId + "' LIMIT 1";
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) return false;
-
-    bool exist = result->rowCount > 0;
-    DBHelper::getInstance().freeResultset(result);
-    return exist;
 }
 
-//检查宿舍是否存在
-bool FeeManager::isDormExist(const std::string& dormId) {
-    std::string trimmedId = Common::trim(dormId);
-    if (trimmedId.empty()) return false;
-
-    std::string sql = "SELECT dorm_id FROM dorm WHERE dorm_id = '" + trimmedId + "' LIMIT 1";
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) return false;
-
-    bool exist = result->rowCount > 0;
-    DBHelper::getInstance().freeResultset(result);
-    return exist;
+//记录审计日志并返回待发布的变更（以fee_id标识）
+static ChangeEvent recordFeeInsert(const Fee& fee, const std::string& feeId) {
+    Fee written = fee;
+    written.totalFee = fee.waterFee + fee.electricFee;
+    written.payDate = fee.payStatus == PayStatus::PAID ? fee.payDate.orToday() : Date();
+    ChangeValues columns = feeColumns(written);
+    AuditJournal::getInstance().recordInsert(AuditEntity::FEE, feeId, columns);
+    return ChangeFeed::makeInsert(ChangeTable::FEE, feeId, columns);
 }
 
 //添加费用记录
@@ -180,8 +177,6 @@ bool FeeManager::addFee(const Fee& fee) {
 
     //构建INSERT SQL
     std::ostringstream sqlStream;
-    std::string payDateStr = Common::dateToString(fee.payDate);
-
     sqlStream << "INSERT INTO fee (student_id, dorm_id, fee_month, water_fee, electric_fee, total_fee, "
         << "pay_status, pay_date) "
         << "VALUES ("
@@ -193,23 +188,28 @@ bool FeeManager::addFee(const Fee& fee) {
         << totalFee << ", "
         << static_cast<int>(fee.payStatus) << ", ";
 
-    //缴费日期：未缴则存NULL，已缴则存日期
+    //缴费日期：未缴则存NULL，已缴则存日期（未填写取当天）
     if (fee.payStatus == PayStatus::UNPAID) {
         sqlStream << "NULL";
     }
     else {
-        sqlStream << "'" << payDateStr << "'";
+        sqlStream << "'" << Common::dateToString(fee.payDate.orToday()) << "'";
     }
 
     sqlStream << ")";
 
-    //SQL
-    int affectedRows = DBHelper::getInstance().executeUpdate(sqlStream.str());
+    //SQL（与费用汇总增量同一事务提交，自增的fee_id在同一连接内取回）
+    uint64_t feeId = 0;
+    int affectedRows = executeWithRollup(std::vector<std::string>(1, sqlStream.str()),
+        std::vector<FeeChange>(1, FeeChange(fee, 1)), &feeId);
     if (affectedRows == -1) {
-        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
-        lastError = "添加费用失败：" + dbErr.errorMsg;
+        lastError = "添加费用失败：" + lastError;
         return false;
     }
+    if (affectedRows > 0) {
+        std::vector<ChangeEvent> events(1, recordFeeInsert(fee, std::to_string(feeId)));
+        ChangeFeed::getInstance().publish(events);
+    }
 
     return affectedRows >= 0;
 }
@@ -248,17 +248,29 @@ bool FeeManager::updateFee(const Fee& fee) {
         << "fee_month = '" << Common::trim(fee.feeMonth) << "', "
         << "water_fee = " << fee.waterFee << ", "
         << "electric_fee = " << fee.electricFee << ", "
-        << "total_fee = " << totalFee << ", ";
+        << "total_fee = " << totalFee << " ";
 
     sqlStream << "WHERE fee_id = " << Common::trim(fee.feeId);
 
-    //执行SQL
-    int affectedRows = DBHelper::getInstance().executeUpdate(sqlStream.str());
+    //执行SQL（旧记录移出汇总，新记录加入汇总）
+    Fee newFee = fee;
+    newFee.payStatus = existFee.payStatus;
+    newFee.payDate = existFee.payDate;
+    newFee.totalFee = totalFee;
+    std::vector<FeeChange> changes;
+    changes.push_back(FeeChange(existFee, -1));
+    changes.push_back(FeeChange(newFee, 1));
+    int affectedRows = executeWithRollup(std::vector<std::string>(1, sqlStream.str()), changes);
     if (affectedRows == -1) {
-        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
-        lastError = "更新费用失败：" + dbErr.errorMsg;
+        lastError = "更新费用失败：" + lastError;
         return false;
     }
+    if (affectedRows > 0) {
+        ChangeValues before = feeColumns(existFee);
+        ChangeValues after = feeColumns(newFee);
+        AuditJournal::getInstance().recordUpdate(AuditEntity::FEE, existFee.feeId, before, after);
+        ChangeFeed::getInstance().publishUpdate(ChangeTable::FEE, existFee.feeId, before, after);
+    }
 
     return affectedRows >= 0;
 }
@@ -292,9 +304,8 @@ bool FeeManager::updatePayStatus(const std::string& feeId, const Date& payDate)
     std::string payDateStr;
     
     // 如果从未付变为已付，使用当前日期；如果传入的日期为空，也使用当前日期
-    if (payDate.year == 0 && payDate.month == 0 && payDate.day == 0) {
-        Date currentDate;
-        payDateStr = Common::dateToString(currentDate);
+    if (payDate.isEmpty()) {
+        payDateStr = Common::dateToString(Date::today());
     } else {
         payDateStr = Common::dateToString(payDate);
     }
@@ -304,13 +315,24 @@ bool FeeManager::updatePayStatus(const std::string& feeId, const Date& payDate)
         << "pay_date = '" << payDateStr << "' "
         << "WHERE fee_id = " << trimmedId;
 
-    //执行SQL
-    int affectedRows = DBHelper::getInstance().executeUpdate(sqlStream.str());
+    //执行SQL（金额从未缴移到已缴）
+    Fee paidFee = existFee;
+    paidFee.payStatus = PayStatus::PAID;
+    paidFee.payDate = Common::stringToDate(payDateStr);
+    std::vector<FeeChange> changes;
+    changes.push_back(FeeChange(existFee, -1));
+    changes.push_back(FeeChange(paidFee, 1));
+    int affectedRows = executeWithRollup(std::vector<std::string>(1, sqlStream.str()), changes);
     if (affectedRows == -1) {
-        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
-        lastError = "更新缴费状态失败：" + dbErr.errorMsg;
+        lastError = "更新缴费状态失败：" + lastError;
         return false;
     }
+    if (affectedRows > 0) {
+        ChangeValues before = feeColumns(existFee);
+        ChangeValues after = feeColumns(paidFee);
+        AuditJournal::getInstance().recordStatus(AuditEntity::FEE, existFee.feeId, before, after);
+        ChangeFeed::getInstance().publishUpdate(ChangeTable::FEE, existFee.feeId, before, after);
+    }
 
     return affectedRows >= 0;
 }
@@ -344,12 +366,17 @@ bool FeeManager::deleteFee(const std::string& feeId) {
     sqlStream << "DELETE FROM fee WHERE fee_id = " << trimmedId;
 
     //执行SQL
-    int affectedRows = DBHelper::getInstance().executeUpdate(sqlStream.str());
+    int affectedRows = executeWithRollup(std::vector<std::string>(1, sqlStream.str()),
+        std::vector<FeeChange>(1, FeeChange(existFee, -1)));
     if (affectedRows == -1) {
-        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
-        lastError = "删除费用失败：" + dbErr.errorMsg;
+        lastError = "删除费用失败：" + lastError;
         return false;
     }
+    if (affectedRows > 0) {
+        ChangeValues columns = feeColumns(existFee);
+        AuditJournal::getInstance().recordRemove(AuditEntity::FEE, existFee.feeId, columns);
+        ChangeFeed::getInstance().publishRemove(ChangeTable::FEE, existFee.feeId, columns);
+    }
 
     return affectedRows >= 0;
 }
@@ -589,6 +616,119 @@ bool FeeManager::isFeeDuplicate(const std::string& studentId, const std::string&
     return duplicate;
 }
 
+//取出某月已出账的学号集合
+bool FeeManager::getBilledStudents(const std::string& feeMonth, std::unordered_set<std::string>& studentIds) {
+    lastError.clear();
+    studentIds.clear();
+
+    std::string trimmedMonth = Common::trim(feeMonth);
+    if (!Common::isValidFeeMonth(trimmedMonth)) {
+        lastError = "费用月份格式不正确，应为YYYY-MM格式";
+        return false;
+    }
+
+    std::string sql = "SELECT student_id FROM fee WHERE fee_month = '" + trimmedMonth + "'";
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(sql, [&studentIds](const DBRowView& row) {
+        studentIds.insert(row.getString(0));
+    });
+    if (rowCount < 0) {
+        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
+        lastError = "查询已出账记录失败：" + dbErr.errorMsg;
+        return false;
+    }
+    return true;
+}
+
+//批量添加费用记录
+bool FeeManager::addFeesBulk(const std::vector<Fee>& fees, const std::vector<std::string>& extraSql) {
+    lastError.clear();
+    if (fees.empty() && extraSql.empty()) return true;
+
+    //金额和月份校验（学号/宿舍由调用方从数据库读出，不再逐条查询）
+    for (const auto& fee : fees) {
+        if (!Common::isValidFeeMonth(fee.feeMonth)) {
+            lastError = "学号" + fee.studentId + "的费用月份格式不正确";
+            return false;
+        }
+        if (fee.waterFee < 0.0 || fee.electricFee < 0.0) {
+            lastError = "学号" + fee.studentId + "的费用金额不能为负数";
+            return false;
+        }
+    }
+
+    //多行INSERT分块，fee_id由数据库自增列按块连续分配
+    std::vector<std::string> sqlList;
+    const size_t rowsPerInsert = 500;
+    for (size_t begin = 0; begin < fees.size(); begin += rowsPerInsert) {
+        std::ostringstream sqlStream;
+        sqlStream << std::fixed << std::setprecision(2);
+        sqlStream << "INSERT INTO fee (student_id, dorm_id, fee_month, water_fee, electric_fee, total_fee, "
+            << "pay_status, pay_date) VALUES ";
+        size_t end = std::min(fees.size(), begin + rowsPerInsert);
+        for (size_t i = begin; i < end; ++i) {
+            const Fee& fee = fees[i];
+            if (i > begin) sqlStream << ", ";
+            sqlStream << "("
+                << "'" << Common::trim(fee.studentId) << "', "
+                << "'" << Common::trim(fee.dormId) << "', "
+                << "'" << Common::trim(fee.feeMonth) << "', "
+                << fee.waterFee << ", "
+                << fee.electricFee << ", "
+                << fee.waterFee + fee.electricFee << ", "
+                << static_cast<int>(fee.payStatus) << ", ";
+            if (fee.payStatus == PayStatus::UNPAID) {
+                sqlStream << "NULL)";
+            }
+            else {
+                sqlStream << "'" << Common::dateToString(fee.payDate.orToday()) << "')";
+            }
+        }
+        sqlList.push_back(sqlStream.str());
+    }
+    sqlList.insert(sqlList.end(), extraSql.begin(), extraSql.end());
+
+    std::vector<FeeChange> changes;
+    changes.reserve(fees.size());
+    for (const auto& fee : fees) changes.push_back(FeeChange(fee, 1));
+    if (executeWithRollup(sqlList, changes) == -1) {
+        lastError = "批量添加费用失败：" + lastError;
+        return false;
+    }
+    //批量插入的自增ID按(学号, 月份)分组读回（读回失败时退回以"学号/月份"标识）
+    std::unordered_map<std::string, std::string> feeIds;
+    readBackFeeIds(fees, feeIds);
+    std::vector<ChangeEvent> events;
+    events.reserve(fees.size());
+    for (const auto& fee : fees) {
+        std::string key = feeMonthKey(fee);
+        auto it = feeIds.find(key);
+        if (it != feeIds.end() && !it->second.empty()) key = it->second;
+        events.push_back(recordFeeInsert(fee, key));
+    }
+    ChangeFeed::getInstance().publish(events);
+    return true;
+}
+
+//费用写入与汇总增量在同一事务内执行，提交后更新汇总镜像和欠费索引（分页缓存和统计由调用方发布的变更通知更新）
+int FeeManager::executeWithRollup(const std::vector<std::string>& sqlList, const std::vector<FeeChange>& changes,
+    uint64_t* firstInsertId) {
+    //锁顺序：汇总 → 欠费索引 → 数据库
+    FeeRollup& rollup = FeeRollup::getInstance();
+    int affectedRows = rollup.commitChanges(sqlList, changes, [&changes, firstInsertId](const std::vector<std::string>& batch) {
+        return ArrearsIndex::getInstance().commitChanges(changes, [&batch, firstInsertId]() {
+            uint64_t insertId = 0;
+            int rows = DBHelper::getInstance().executeBatch(batch, insertId);
+            if (firstInsertId != nullptr) *firstInsertId = insertId;
+            return rows;
+        });
+    });
+    if (affectedRows == -1) {
+        lastError = rollup.getLastError();
+        return -1;
+    }
+    return affectedRows;
+}
+
 std::string FeeManager::getLastError() const {
     return lastError;
 }
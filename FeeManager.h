@@ -5,6 +5,7 @@
 #include "DBHelper.h"
 #include <vector>
 #include <string>
+#include <unordered_set>
 
 // --------------- 水电费结构体（与MySQL fee表字段一一对应）---------------
 // 修改Fee结构体
@@ -36,6 +37,8 @@ struct Fee {
 };
 
 
+struct FeeChange;
+
 // --------------- 水电费业务逻辑封装类 ---------------
 class FeeManager {
 public:
@@ -76,6 +79,12 @@ public:
     // 11. 检查同一学生/宿舍同一月份是否已存在费用记录（返回true表示已存在）
     bool isFeeDuplicate(const std::string& studentId, const std::string& feeMonth);
 
+    // 11.1 一次查询取出某月已出账的全部学号（批量出账前的集合去重）
+    bool getBilledStudents(const std::string& feeMonth, std::unordered_set<std::string>& studentIds);
+
+    // 11.2 批量添加费用记录（调用方已去重；一个事务内多行INSERT，extraSql随同一事务执行）
+    bool addFeesBulk(const std::vector<Fee>& fees, const std::vector<std::string>& extraSql = std::vector<std::string>());
+
     // 12. 获取最后一次操作错误信息
     std::string getLastError() const;
 
@@ -88,14 +97,10 @@ private:
     // 私有辅助函数：将查询结果行转换为Fee对象
     Fee rowToFee(const std::map<std::string, std::string>& row);
 
-    // 私有辅助函数：生成费用ID（格式F+年月日+序号，如F2024110001）
-    std::string generateFeeId();
-
-    // 私有辅助函数：校验学号是否存在
-    bool isStudentExist(const std::string& studentId);
-
-    // 私有辅助函数：校验宿舍号是否存在
-    bool isDormExist(const std::string& dormId);
+    // 私有辅助函数：费用写入与汇总增量同一事务执行（返回影响行数，失败返回-1）
+    // firstInsertId非空时取回第一条语句的自增ID
+    int executeWithRollup(const std::vector<std::string>& sqlList, const std::vector<FeeChange>& changes,
+        uint64_t* firstInsertId = nullptr);
 };
 
 #endif // FEEMANAGER_H
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "FeeRollup.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include "ExistenceCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+
+//每条INSERT包含的汇总行数
+static const size_t ROLLUP_ROWS_PER_INSERT = 500;
+
+FeeRollup& FeeRollup::getInstance() {
+    static FeeRollup instance;
+    return instance;
+}
+
+std::string FeeRollup::getLastError() {
+    std::lock_guard<std::mutex> lock(rollupMutex);
+    return lastError;
+}
+
+bool FeeRollup::ensureTable() {
+    std::string sql =
+        "CREATE TABLE IF NOT EXISTS fee_rollup ("
+        "fee_month VARCHAR(7) NOT NULL, "
+        "dorm_id VARCHAR(10) NOT NULL, "
+        "building VARCHAR(20) NOT NULL DEFAULT '', "
+        "total_cents BIGINT NOT NULL DEFAULT 0, "
+        "paid_cents BIGINT NOT NULL DEFAULT 0, "
+        "unpaid_cents BIGINT NOT NULL DEFAULT 0, "
+        "paid_count INT NOT NULL DEFAULT 0, "
+        "unpaid_count INT NOT NULL DEFAULT 0, "
+        "PRIMARY KEY (fee_month, dorm_id), "
+        "KEY idx_month_building (fee_month, building))";
+    if (DBHelper::getInstance().executeUpdate(sql) == -1) {
+        lastError = "创建费用汇总表失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+    return true;
+}
+
+FeeTotals FeeRollup::deltaOf(const Fee& fee, int sign) {
+    FeeTotals delta;
+    int64_t cents = std::llround((fee.waterFee + fee.electricFee) * 100);
+    delta.totalCents = sign * cents;
+    if (fee.payStatus == PayStatus::PAID) {
+        delta.paidCents = sign * cents;
+        delta.paidCount = sign;
+    }
+    else {
+        delta.unpaidCents = sign * cents;
+        delta.unpaidCount = sign;
+    }
+    return delta;
+}
+
+void FeeRollup::appendInsertSql(const RollupMap& rollups, bool accumulate, std::vector<std::string>& sqlList) {
+    std::ostringstream sqlStream;
+    size_t rows = 0;
+    auto finish = [&]() {
+        if (rows == 0) return;
+        if (accumulate) {
+            sqlStream << " ON DUPLICATE KEY UPDATE building = VALUES(building), "
+                << "total_cents = total_cents + VALUES(total_cents), "
+                << "paid_cents = paid_cents + VALUES(paid_cents), "
+                << "unpaid_cents = unpaid_cents + VALUES(unpaid_cents), "
+                << "paid_count = paid_count + VALUES(paid_count), "
+                << "unpaid_count = unpaid_count + VALUES(unpaid_count)";
+        }
+        sqlList.push_back(sqlStream.str());
+        sqlStream.str("");
+        rows = 0;
+    };
+
+    for (const auto& monthItem : rollups) {
+        for (const auto& buildingItem : monthItem.second) {
+            for (const auto& dormItem : buildingItem.second) {
+                const FeeTotals& t = dormItem.second;
+                sqlStream << (rows == 0
+                    ? "INSERT INTO fee_rollup (fee_month, dorm_id, building, total_cents, paid_cents, "
+                      "unpaid_cents, paid_count, unpaid_count) VALUES "
+                    : ", ");
+                sqlStream << "('" << monthItem.first << "', '" << dormItem.first << "', '" << buildingItem.first << "', "
+                    << t.totalCents << ", " << t.paidCents << ", " << t.unpaidCents << ", "
+                    << t.paidCount << ", " << t.unpaidCount << ")";
+                if (++rows >= ROLLUP_ROWS_PER_INSERT) finish();
+            }
+        }
+    }
+    finish();
+}
+
+int FeeRollup::commitChanges(const std::vector<std::string>& sqlList, const std::vector<FeeChange>& changes,
+    const std::function<int(const std::vector<std::string>&)>& commit) {
+    if (!changes.empty() && !ensureLoaded()) return -1;
+
+    //加载和重建持同一把锁扫描fee表，写入期间持锁，提交的费用不会被扫描和增量重复计入，也不会被重建覆盖
+    std::lock_guard<std::mutex> lock(rollupMutex);
+    RollupMap deltas;
+    for (const auto& change : changes) {
+        std::string dormId = Common::trim(change.fee.dormId);
+        std::string building = ExistenceCache::getInstance().getBuildingOfDorm(dormId);
+        deltas[Common::trim(change.fee.feeMonth)][building][dormId].add(deltaOf(change.fee, change.sign));
+    }
+    std::vector<std::string> batch = sqlList;
+    appendInsertSql(deltas, true, batch);
+
+    int affectedRows = commit(batch);
+    if (affectedRows == -1) {
+        lastError = DBHelper::getInstance().getLastError().errorMsg;
+        return -1;
+    }
+    if (!loaded) return affectedRows;
+    for (const auto& monthItem : deltas) {
+        for (const auto& buildingItem : monthItem.second) {
+            for (const auto& dormItem : buildingItem.second) {
+                mirror[monthItem.first][buildingItem.first][dormItem.first].add(dormItem.second);
+            }
+        }
+    }
+    return affectedRows;
+}
+
+void FeeRollup::onDormBuildingChanged(const std::string& dormId, const std::string& building) {
+    std::string trimmedId = Common::trim(dormId);
+    std::string trimmedBuilding = Common::trim(building);
+
+    std::lock_guard<std::mutex> lock(rollupMutex);
+    //汇总表未加载时也要改楼栋列，否则之后加载时读到旧楼栋
+    DBHelper::getInstance().executeUpdate("UPDATE fee_rollup SET building = '" + trimmedBuilding
+        + "' WHERE dorm_id = '" + trimmedId + "' AND building <> '" + trimmedBuilding + "'");
+    if (!loaded) return;
+
+    //在镜像中把该宿舍各月的汇总从原楼栋挪到新楼栋下
+    for (auto& monthItem : mirror) {
+        for (auto oldIt = monthItem.second.begin(); oldIt != monthItem.second.end();) {
+            auto dormIt = oldIt->second.find(trimmedId);
+            if (oldIt->first == trimmedBuilding || dormIt == oldIt->second.end()) {
+                ++oldIt;
+                continue;
+            }
+            FeeTotals moved = dormIt->second;
+            oldIt->second.erase(dormIt);
+            oldIt = oldIt->second.empty() ? monthItem.second.erase(oldIt) : std::next(oldIt);
+            monthItem.second[trimmedBuilding][trimmedId].add(moved);
+        }
+    }
+}
+
+bool FeeRollup::ensureLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(rollupMutex);
+        if (loaded) return true;
+        if (!ensureTable()) return false;
+
+        //读取已有汇总，非空说明此前已建立过
+        RollupMap existing;
+        int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+            "SELECT fee_month, building, dorm_id, total_cents, paid_cents, unpaid_cents, paid_count, unpaid_count "
+            "FROM fee_rollup",
+            [&existing](const DBRowView& row) {
+                FeeTotals& t = existing[row.getString(0)][row.getString(1)][row.getString(2)];
+                t.totalCents = std::strtoll(row.getString(3).c_str(), nullptr, 10);
+                t.paidCents = std::strtoll(row.getString(4).c_str(), nullptr, 10);
+                t.unpaidCents = std::strtoll(row.getString(5).c_str(), nullptr, 10);
+                Common::stringToInt(row.getString(6), t.paidCount);
+                Common::stringToInt(row.getString(7), t.unpaidCount);
+            });
+        if (rowCount < 0) {
+            lastError = "读取费用汇总失败：" + DBHelper::getInstance().getLastError().errorMsg;
+            return false;
+        }
+        if (rowCount > 0) {
+            mirror.swap(existing);
+            loaded = true;
+            return true;
+        }
+    }
+    //汇总表为空（首次使用），从fee表重建
+    return rebuild();
+}
+
+bool FeeRollup::rebuild(int threadCount) {
+    std::lock_guard<std::mutex> lock(rollupMutex);
+    if (!ensureTable()) return false;
+
+    //1. 一次联表扫描取出费用明细
+    struct FeeRow {
+        std::string feeMonth;
+        std::string building;
+        std::string dormId;
+        FeeTotals delta;
+    };
+    std::vector<FeeRow> rows;
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT f.fee_month, IFNULL(d.building, ''), f.dorm_id, f.pay_status, f.total_fee "
+        "FROM fee f LEFT JOIN dorm d ON d.dorm_id = f.dorm_id",
+        [&rows](const DBRowView& row) {
+            FeeRow item;
+            item.feeMonth = row.getString(0);
+            item.building = row.getString(1);
+            item.dormId = row.getString(2);
+            int status = 0;
+            int64_t cents = 0;
+            Common::stringToInt(row.getString(3), status);
+            Common::parseCents(row.getString(4), cents);
+            item.delta.totalCents = cents;
+            if (status == 1) {
+                item.delta.paidCents = cents;
+                item.delta.paidCount = 1;
+            }
+            else {
+                item.delta.unpaidCents = cents;
+                item.delta.unpaidCount = 1;
+            }
+            rows.push_back(item);
+        });
+    if (rowCount < 0) {
+        lastError = "读取费用明细失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    //2. 扫描是单条串行流，仅内存聚合按行区间分片并行，再合并
+    RollupMap rebuilt = Common::parallelAggregate<RollupMap>(rows.size(), threadCount,
+        [&rows](RollupMap& part, size_t i) {
+            part[rows[i].feeMonth][rows[i].building][rows[i].dormId].add(rows[i].delta);
+        },
+        [](RollupMap& into, const RollupMap& from) {
+            for (const auto& monthItem : from) {
+                for (const auto& buildingItem : monthItem.second) {
+                    for (const auto& dormItem : buildingItem.second) {
+                        into[monthItem.first][buildingItem.first][dormItem.first].add(dormItem.second);
+                    }
+                }
+            }
+        });
+
+    //3. 清空并重写汇总表
+    std::vector<std::string> sqlList(1, "DELETE FROM fee_rollup");
+    appendInsertSql(rebuilt, false, sqlList);
+    if (DBHelper::getInstance().executeBatch(sqlList) == -1) {
+        lastError = "重建费用汇总失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    mirror.swap(rebuilt);
+    loaded = true;
+    return true;
+}
+
+FeeTotals FeeRollup::getTotals(const std::string& feeMonth, const std::string& building, const std::string& dormId) {
+    FeeTotals totals;
+    if (!ensureLoaded()) return totals;
+
+    std::string trimmedBuilding = Common::trim(building);
+    std::string trimmedDorm = Common::trim(dormId);
+
+    std::lock_guard<std::mutex> lock(rollupMutex);
+    auto monthIt = mirror.find(Common::trim(feeMonth));
+    if (monthIt == mirror.end()) return totals;
+
+    for (const auto& buildingItem : monthIt->second) {
+        if (!trimmedBuilding.empty() && buildingItem.first != trimmedBuilding) continue;
+        if (!trimmedDorm.empty()) {
+            auto dormIt = buildingItem.second.find(trimmedDorm);
+            if (dormIt != buildingItem.second.end()) totals.add(dormIt->second);
+            continue;
+        }
+        for (const auto& dormItem : buildingItem.second) totals.add(dormItem.second);
+    }
+    return totals;
+}
+
+std::vector<std::pair<std::string, FeeTotals>> FeeRollup::getBuildingTotals(const std::string& feeMonth) {
+    std::vector<std::pair<std::string, FeeTotals>> resultList;
+    if (!ensureLoaded()) return resultList;
+
+    std::lock_guard<std::mutex> lock(rollupMutex);
+    auto monthIt = mirror.find(Common::trim(feeMonth));
+    if (monthIt == mirror.end()) return resultList;
+
+    for (const auto& buildingItem : monthIt->second) {
+        FeeTotals totals;
+        for (const auto& dormItem : buildingItem.second) totals.add(dormItem.second);
+        resultList.push_back(std::make_pair(buildingItem.first, totals));
+    }
+    return resultList;
+}
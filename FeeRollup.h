@@ -0,0 +1,99 @@
+#ifndef FEEROLLUP_H
+#define FEEROLLUP_H
+
+#include "FeeManager.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+// 费用汇总值（金额以分为单位）
+struct FeeTotals {
+    int64_t totalCents;  // 应收总额
+    int64_t paidCents;   // 已缴金额
+    int64_t unpaidCents; // 未缴金额
+    int paidCount;       // 已缴记录数
+    int unpaidCount;     // 未缴记录数
+
+    FeeTotals() : totalCents(0), paidCents(0), unpaidCents(0), paidCount(0), unpaidCount(0) {}
+
+    void add(const FeeTotals& other) {
+        totalCents += other.totalCents;
+        paidCents += other.paidCents;
+        unpaidCents += other.unpaidCents;
+        paidCount += other.paidCount;
+        unpaidCount += other.unpaidCount;
+    }
+    bool isZero() const {
+        return totalCents == 0 && paidCents == 0 && unpaidCents == 0 && paidCount == 0 && unpaidCount == 0;
+    }
+};
+
+// 一条费用记录的变化（sign为1表示加入汇总，-1表示移出）
+struct FeeChange {
+    Fee fee;
+    int sign;
+
+    FeeChange(const Fee& f, int s) : fee(f), sign(s) {}
+};
+
+// --------------- 按(月份, 楼栋, 宿舍)维护的费用汇总（单例）---------------
+// 汇总表fee_rollup与费用写入在同一事务内增量更新，内存中保留一份镜像，
+// 看板查询只遍历分组，不扫描fee表；也可并行从fee表全量重建。
+class FeeRollup {
+public:
+    static FeeRollup& getInstance();
+
+    // 费用写入：把汇总增量SQL（按宿舍-月份合并）追加到sqlList后交给commit在同一事务执行，
+    // 成功后更新内存镜像；全程持有汇总锁，与加载和重建互斥。返回commit的结果，-1表示失败
+    int commitChanges(const std::vector<std::string>& sqlList, const std::vector<FeeChange>& changes,
+        const std::function<int(const std::vector<std::string>&)>& commit);
+
+    // 宿舍改楼栋后同步汇总表和镜像
+    void onDormBuildingChanged(const std::string& dormId, const std::string& building);
+
+    // 查询某月汇总（building/dormId为空表示不限）
+    FeeTotals getTotals(const std::string& feeMonth, const std::string& building = "", const std::string& dormId = "");
+
+    // 查询某月各楼栋的汇总
+    std::vector<std::pair<std::string, FeeTotals>> getBuildingTotals(const std::string& feeMonth);
+
+    // 首次使用时建表并加载镜像
+    bool ensureLoaded();
+
+    // 镜像是否已加载（不等待正在进行的加载，界面据此显示加载状态）
+    bool isLoaded() const { return loaded.load(); }
+
+    // 从fee表并行重建汇总表和镜像（threadCount为0表示按CPU核数）
+    bool rebuild(int threadCount = 0);
+
+    // 获取最近一次错误信息
+    std::string getLastError();
+
+private:
+    FeeRollup() : loaded(false) {}
+    FeeRollup(const FeeRollup&) = delete;
+    FeeRollup& operator=(const FeeRollup&) = delete;
+
+    // 月份 → 楼栋 → 宿舍 → 汇总
+    typedef std::map<std::string, std::map<std::string, std::map<std::string, FeeTotals>>> RollupMap;
+
+    std::mutex rollupMutex;
+    RollupMap mirror;
+    std::atomic<bool> loaded;   // 加载期间持有rollupMutex，标志单独可读
+    std::string lastError;
+
+    // 单条费用对汇总的增量
+    static FeeTotals deltaOf(const Fee& fee, int sign);
+
+    // 建表
+    bool ensureTable();
+
+    // 把汇总写成多行INSERT语句
+    static void appendInsertSql(const RollupMap& rollups, bool accumulate, std::vector<std::string>& sqlList);
+};
+
+#endif // FEEROLLUP_H
@@ -0,0 +1,230 @@
+#include "FreeBedIndex.h"
+#include "OccupancyTable.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include <algorithm>
+
+static const size_t FREE_BED_NPOS = static_cast<size_t>(-1);
+
+FreeBedIndex& FreeBedIndex::getInstance() {
+    static FreeBedIndex instance;
+    return instance;
+}
+
+// ---------------- 分组线段树 ----------------
+void FreeBedIndex::Group::build(const std::vector<int>& freeBeds) {
+    leafBase = 1;
+    while (leafBase < freeBeds.size()) leafBase <<= 1;
+    //空叶子记为-1，永远不会被选中
+    tree.assign(leafBase * 2, -1);
+    for (size_t i = 0; i < freeBeds.size(); ++i) {
+        tree[leafBase + i] = freeBeds[i];
+    }
+    for (size_t i = leafBase - 1; i >= 1; --i) {
+        tree[i] = std::max(tree[i * 2], tree[i * 2 + 1]);
+    }
+}
+
+void FreeBedIndex::Group::update(size_t pos, int freeBeds) {
+    size_t i = leafBase + pos;
+    tree[i] = freeBeds;
+    for (i >>= 1; i >= 1; i >>= 1) {
+        tree[i] = std::max(tree[i * 2], tree[i * 2 + 1]);
+    }
+}
+
+size_t FreeBedIndex::Group::findFirst(size_t from, int minFree) const {
+    if (tree.size() < 2 || from >= dormIds.size()) return FREE_BED_NPOS;
+    return findFirst(1, 0, leafBase, from, minFree);
+}
+
+size_t FreeBedIndex::Group::findFirst(size_t node, size_t nodeLeft, size_t nodeRight,
+    size_t from, int minFree) const {
+    //区间[nodeLeft, nodeRight)整体在from左侧或最大值不足，剪枝
+    if (nodeRight <= from || tree[node] < minFree) return FREE_BED_NPOS;
+    if (nodeRight - nodeLeft == 1) return nodeLeft;
+
+    size_t mid = (nodeLeft + nodeRight) / 2;
+    size_t found = findFirst(node * 2, nodeLeft, mid, from, minFree);
+    if (found != FREE_BED_NPOS) return found;
+    return findFirst(node * 2 + 1, mid, nodeRight, from, minFree);
+}
+
+// ---------------- 索引维护 ----------------
+std::string FreeBedIndex::makeGroupKey(const std::string& building, const std::string& roomType) {
+    return building + "|" + roomType;
+}
+
+int FreeBedIndex::currentFree(const std::string& dormId) {
+    int occupancy = 0, maxCapacity = 0;
+    if (!OccupancyTable::getInstance().get(dormId, occupancy, maxCapacity)) return 0;
+    return std::max(0, maxCapacity - occupancy);
+}
+
+void FreeBedIndex::rebuildGroup(const std::string& groupKey) {
+    auto it = groups.find(groupKey);
+    if (it == groups.end()) return;
+    Group& group = it->second;
+    if (group.dormIds.empty()) {
+        groups.erase(it);
+        return;
+    }
+
+    std::vector<int> freeBeds;
+    freeBeds.reserve(group.dormIds.size());
+    for (size_t i = 0; i < group.dormIds.size(); ++i) {
+        freeBeds.push_back(currentFree(group.dormIds[i]));
+        slots[group.dormIds[i]] = Slot{ groupKey, i };
+    }
+    group.build(freeBeds);
+}
+
+void FreeBedIndex::eraseDorm(const std::string& dormId) {
+    auto slotIt = slots.find(dormId);
+    if (slotIt == slots.end()) return;
+    std::string groupKey = slotIt->second.groupKey;
+    size_t pos = slotIt->second.pos;
+    slots.erase(slotIt);
+
+    Group& group = groups[groupKey];
+    group.dormIds.erase(group.dormIds.begin() + static_cast<std::ptrdiff_t>(pos));
+    rebuildGroup(groupKey);
+}
+
+void FreeBedIndex::insertDorm(const std::string& dormId, const std::string& building, const std::string& roomType) {
+    std::string groupKey = makeGroupKey(building, roomType);
+    Group& group = groups[groupKey];
+    group.building = building;
+    group.roomType = roomType;
+    auto it = std::lower_bound(group.dormIds.begin(), group.dormIds.end(), dormId);
+    group.dormIds.insert(it, dormId);
+    rebuildGroup(groupKey);
+}
+
+bool FreeBedIndex::rebuild() {
+    if (!OccupancyTable::getInstance().ensureLoaded()) return false;
+
+    struct DormKey {
+        std::string dormId;
+        std::string building;
+        std::string roomType;
+    };
+    std::vector<DormKey> rows;
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT dorm_id, building, room_type FROM dorm ORDER BY dorm_id",
+        [&rows](const DBRowView& row) {
+            rows.push_back(DormKey{ row.getString(0), row.getString(1), row.getString(2) });
+        });
+    if (rowCount < 0) return false;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    groups.clear();
+    slots.clear();
+    for (const auto& item : rows) {
+        Group& group = groups[makeGroupKey(item.building, item.roomType)];
+        group.building = item.building;
+        group.roomType = item.roomType;
+        group.dormIds.push_back(item.dormId);
+    }
+    for (auto& entry : groups) {
+        std::sort(entry.second.dormIds.begin(), entry.second.dormIds.end());
+    }
+    std::vector<std::string> keys;
+    for (const auto& entry : groups) keys.push_back(entry.first);
+    for (const auto& key : keys) rebuildGroup(key);
+
+    loaded = true;
+    return true;
+}
+
+bool FreeBedIndex::ensureLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (loaded) return true;
+    }
+    return rebuild();
+}
+
+void FreeBedIndex::refresh(const std::string& dormId) {
+    std::string trimmedId = Common::trim(dormId);
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    auto it = slots.find(trimmedId);
+    if (it == slots.end()) return;
+    //持锁读取计数表最新值，保证并发刷新时最后写入的总是最新数据
+    groups[it->second.groupKey].update(it->second.pos, currentFree(trimmedId));
+}
+
+void FreeBedIndex::addDorm(const Dorm& dorm) {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    std::string trimmedId = Common::trim(dorm.dormId);
+    eraseDorm(trimmedId);
+    insertDorm(trimmedId, Common::trim(dorm.building), Common::trim(dorm.roomType));
+}
+
+void FreeBedIndex::updateDorm(const Dorm& dorm) {
+    //楼栋或类型可能变化，按删除后重新插入处理
+    addDorm(dorm);
+}
+
+void FreeBedIndex::removeDorm(const std::string& dormId) {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    eraseDorm(Common::trim(dormId));
+}
+
+// ---------------- 查询 ----------------
+std::vector<FreeBedEntry> FreeBedIndex::findFree(const std::string& building, const std::string& roomType,
+    int minFree, int limit) {
+    std::vector<FreeBedEntry> resultList;
+    if (limit <= 0 || !ensureLoaded()) return resultList;
+    if (minFree < 1) minFree = 1;
+
+    std::string trimmedBuilding = Common::trim(building);
+    std::string trimmedType = Common::trim(roomType);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+
+    //选出参与查询的分组（不限类型时合并该楼栋的4/6/8人间）
+    std::vector<const Group*> selected;
+    if (!trimmedType.empty()) {
+        auto it = groups.find(makeGroupKey(trimmedBuilding, trimmedType));
+        if (it != groups.end()) selected.push_back(&it->second);
+    }
+    else {
+        for (auto it = groups.lower_bound(trimmedBuilding + "|"); it != groups.end(); ++it) {
+            if (it->second.building != trimmedBuilding) break;
+            selected.push_back(&it->second);
+        }
+    }
+
+    //各分组内依次向后查找，按宿舍号归并出前limit个
+    std::vector<size_t> cursors(selected.size());
+    for (size_t g = 0; g < selected.size(); ++g) {
+        cursors[g] = selected[g]->findFirst(0, minFree);
+    }
+    while (static_cast<int>(resultList.size()) < limit) {
+        size_t best = FREE_BED_NPOS;
+        for (size_t g = 0; g < selected.size(); ++g) {
+            if (cursors[g] == FREE_BED_NPOS) continue;
+            if (best == FREE_BED_NPOS ||
+                selected[g]->dormIds[cursors[g]] < selected[best]->dormIds[cursors[best]]) {
+                best = g;
+            }
+        }
+        if (best == FREE_BED_NPOS) break;
+
+        const Group& group = *selected[best];
+        size_t pos = cursors[best];
+        FreeBedEntry entry;
+        entry.dormId = group.dormIds[pos];
+        entry.building = group.building;
+        entry.roomType = group.roomType;
+        entry.freeBeds = group.tree[group.leafBase + pos];
+        resultList.push_back(entry);
+
+        cursors[best] = group.findFirst(pos + 1, minFree);
+    }
+    return resultList;
+}
@@ -0,0 +1,88 @@
+#ifndef FREEBEDINDEX_H
+#define FREEBEDINDEX_H
+
+#include "DormManager.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+
+// 空床查询结果
+struct FreeBedEntry {
+    std::string dormId;   // 宿舍号
+    std::string building; // 楼栋
+    std::string roomType; // 房间类型
+    int freeBeds;         // 空床数
+};
+
+// --------------- 宿舍空床索引（单例）---------------
+// 按(楼栋, 房间类型)分组，每组宿舍按宿舍号排序，
+// 用记录区间最大空床数的线段树回答"前N个空床数>=k的宿舍"，
+// 每找到一个宿舍耗时O(log n)；空床数取自OccupancyTable。
+class FreeBedIndex {
+public:
+    static FreeBedIndex& getInstance();
+
+    // 查询楼栋building中空床数>=minFree的前limit个宿舍（roomType为空表示不限类型）
+    std::vector<FreeBedEntry> findFree(const std::string& building, const std::string& roomType,
+        int minFree, int limit);
+
+    // 宿舍入住人数变化后调用（从OccupancyTable读取最新值）
+    void refresh(const std::string& dormId);
+
+    // 新增/修改/删除宿舍后调用
+    void addDorm(const Dorm& dorm);
+    void updateDorm(const Dorm& dorm);
+    void removeDorm(const std::string& dormId);
+
+    // 首次使用时加载
+    bool ensureLoaded();
+
+    // 从数据库重建
+    bool rebuild();
+
+private:
+    FreeBedIndex() : loaded(false) {}
+    FreeBedIndex(const FreeBedIndex&) = delete;
+    FreeBedIndex& operator=(const FreeBedIndex&) = delete;
+
+    // 一个(楼栋, 房间类型)分组
+    struct Group {
+        std::string building;
+        std::string roomType;
+        std::vector<std::string> dormIds; // 按宿舍号排序
+        std::vector<int> tree;            // 线段树（叶子为各宿舍空床数）
+        size_t leafBase;                  // 叶子起始下标（2的幂）
+
+        Group() : leafBase(1) {}
+        void build(const std::vector<int>& freeBeds);
+        void update(size_t pos, int freeBeds);
+        // 查找下标>=from且空床数>=minFree的第一个位置，没有返回npos
+        size_t findFirst(size_t from, int minFree) const;
+        size_t findFirst(size_t node, size_t nodeLeft, size_t nodeRight, size_t from, int minFree) const;
+    };
+
+    // 宿舍在索引中的位置
+    struct Slot {
+        std::string groupKey;
+        size_t pos;
+    };
+
+    std::mutex indexMutex;
+    std::map<std::string, Group> groups;              // 楼栋+类型 → 分组
+    std::unordered_map<std::string, Slot> slots;      // 宿舍号 → 位置
+    bool loaded;
+
+    static std::string makeGroupKey(const std::string& building, const std::string& roomType);
+    static int currentFree(const std::string& dormId);
+
+    // 重建一个分组的线段树和位置表（已持有indexMutex）
+    void rebuildGroup(const std::string& groupKey);
+    // 从分组中移除宿舍（已持有indexMutex）
+    void eraseDorm(const std::string& dormId);
+    // 插入宿舍（已持有indexMutex）
+    void insertDorm(const std::string& dormId, const std::string& building, const std::string& roomType);
+};
+
+#endif // FREEBEDINDEX_H
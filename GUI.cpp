@@ -4,6 +4,21 @@
 #include "FeeManager.h"
 #include "RepairManager.h"
 #include "VisitorManager.h"
+#include "BillingRun.h"
+#include "MeterIngest.h"
+#include "DormAssignment.h"
+#include "FeeRollup.h"
+#include "ArrearsIndex.h"
+#include "FeeColumnStore.h"
+#include "VisitorProfileIndex.h"
+#include "VisitorTimeIndex.h"
+#include "RepairDispatcher.h"
+#include "RepairAnalytics.h"
+#include "StatsService.h"
+#include "PageCache.h"
+#include "ViewModel.h"
+#include "TableRender.h"
+#include "EasyXRenderer.h"
 #include "MultiTableQueryManager.h"
 #include "MultiTableQueryTypes.h"
 #include "main.h"
@@ -31,8 +46,33 @@ struct InitDormManager {
 };
 static InitDormManager initDormManager;
 
+//各管理界面的分页缓存（加载函数可能在预取线程执行，使用独立的管理类对象）
+static PageCache<Student> studentPages(PageScreen::STUDENT,
+    [](const PageParam& page) { StudentManager mgr; return mgr.getAllStudents(page); },
+    []() { StudentManager mgr; return mgr.getStudentTotalCount(); });
+static PageCache<Dorm> dormPages(PageScreen::DORM,
+    [](const PageParam& page) { DormManager mgr; return mgr.getAllDorms(page); },
+    []() { DormManager mgr; return mgr.getDormTotalCount(); });
+static PageCache<Fee> feePages(PageScreen::FEE,
+    [](const PageParam& page) { FeeManager mgr; return mgr.getAllFees(page); },
+    []() { FeeManager mgr; return mgr.getFeeTotalCount(); });
+static PageCache<Repair> repairPages(PageScreen::REPAIR,
+    [](const PageParam& page) { RepairManager mgr; return mgr.getAllRepairs(page); },
+    []() { RepairManager mgr; return mgr.getRepairTotalCount(); });
+static PageCache<Visitor> visitorPages(PageScreen::VISITOR,
+    [](const PageParam& page) { VisitorManager mgr; return mgr.getAllVisitors(page); },
+    []() { VisitorManager mgr; return mgr.getVisitorTotalCount(); });
+
+//各管理界面当前显示的数据（在视图模型工作线程中加载）
+static ListViewModel<Student> studentList(studentPages);
+static ListViewModel<Dorm> dormList(dormPages);
+static ListViewModel<Fee> feeList(feePages);
+static ListViewModel<Repair> repairList(repairPages);
+static ListViewModel<Visitor> visitorList(visitorPages);
+
 void showStudentFeeQueryResult(const std::vector<StudentDormFeeInfo>& results);
 void showStudentInfoQueryResult(const Student& student);
+void showInfoLinesDialog(const std::string& title, const std::vector<std::string>& lines);
 
 //绘制背景函数
 void drawBackground() {
@@ -262,19 +302,89 @@ void drawTitleBar(const std::string& title) {
     drawButton(WINDOW_W - 150, 30, "返回主菜单");
 }
 
-void drawFooter(int totalCount) {
+void drawFooter() {
     settextcolor(g_tipColor);
     outtextxy(50, WINDOW_H - 80, _T(g_tipMsg.c_str()));
 
+    drawButton(WINDOW_W / 2 - 200, WINDOW_H - 70, "上一页");
+    drawButton(WINDOW_W / 2 + 100, WINDOW_H - 70, "下一页");
+}
+
+void drawLoadingHint(bool loading) {
+    if (!loading) return;
+    settextcolor(0x0066CC);
+    settextstyle(20, 0, "宋体");
+    outtextxy(WINDOW_W / 2 - 50, WINDOW_H - 90, _T("加载中..."));
+}
+
+//表格数据和页码生成绘制命令列表，由EasyX后端执行；记录上一帧用于局部重绘
+static EasyXRenderer g_renderer;
+static RenderList g_lastTable;
+static UIState g_lastTableState = UIState::LOGIN;
+
+//生成当前界面的表格命令（非列表界面返回false）
+static bool buildCurrentTable(RenderList& list) {
+    //表头在y=160处，数据从下一行开始
+    TableLayout layout(50, 160 + ROW_H, WINDOW_W - 100, ROW_H, WINDOW_W, WINDOW_H);
+    bool loading = false;
+    int totalCount = 0;
+    if (currentState == UIState::STUDENT_MANAGE) {
+        studentList.request("", g_pageParam);
+        buildStudentRows(list, layout, studentList.getRows());
+        loading = studentList.isLoading();
+        totalCount = studentList.getTotalCount();
+    }
+    else if (currentState == UIState::DORM_MANAGE) {
+        dormList.request("", g_pageParam);
+        buildDormRows(list, layout, dormList.getRows());
+        loading = dormList.isLoading();
+        totalCount = dormList.getTotalCount();
+    }
+    else if (currentState == UIState::FEE_MANAGE) {
+        feeList.request("", g_pageParam);
+        buildFeeRows(list, layout, feeList.getRows());
+        loading = feeList.isLoading();
+        totalCount = feeList.getTotalCount();
+    }
+    else if (currentState == UIState::REPAIR_MANAGE) {
+        repairList.request("", g_pageParam);
+        buildRepairRows(list, layout, repairList.getRows());
+        loading = repairList.isLoading();
+        totalCount = repairList.getTotalCount();
+    }
+    else if (currentState == UIState::VISITOR_MANAGE) {
+        visitorList.request("", g_pageParam);
+        buildVisitorRows(list, layout, visitorList.getRows());
+        loading = visitorList.isLoading();
+        totalCount = visitorList.getTotalCount();
+    }
+    else {
+        return false;
+    }
+
     g_pageParam.totalCount = totalCount;
     g_pageParam.calcTotalPage();
+    buildPageInfo(list, layout, g_pageParam, loading);
+    return true;
+}
 
-    std::string pageInfo = "第 " + std::to_string(g_pageParam.pageIndex) + " / " + std::to_string(g_pageParam.totalPage) + " 页";
-    settextcolor(BLACK);
-    outtextxy(WINDOW_W / 2 - 50, WINDOW_H - 60, _T(pageInfo.c_str()));
+//完整绘制当前界面的表格
+static void drawCurrentTable() {
+    RenderList list;
+    if (!buildCurrentTable(list)) return;
+    g_renderer.submit(list);
+    g_lastTable = list;
+    g_lastTableState = currentState;
+}
 
-    drawButton(WINDOW_W / 2 - 200, WINDOW_H - 70, "上一页");
-    drawButton(WINDOW_W / 2 + 100, WINDOW_H - 70, "下一页");
+//数据返回后只重绘与上一帧不同的行；界面已切换或有提示信息时返回false，由调用方完整重绘
+bool refreshCurrentTable() {
+    if (currentState != g_lastTableState || !g_tipMsg.empty()) return false;
+    RenderList list;
+    if (!buildCurrentTable(list)) return false;
+    g_renderer.submitRegions(list, g_lastTable, list.diffRegions(g_lastTable));
+    g_lastTable = list;
+    return true;
 }
 
 bool isClickedReturn(int x, int y) {
@@ -328,6 +438,7 @@ void drawStudentManage() {
     drawButton(310, y, "删除学生");
     drawButton(440, y, "查询学生信息");
     drawButton(570, y, "学生缴费查询");
+    drawButton(700, y, "新生批量入住");
 
     y += 60;
     
@@ -338,35 +449,8 @@ void drawStudentManage() {
     int colWidth = (WINDOW_W - 100) / static_cast<int>(headers.size());
     drawTableHeader(50, y, headers, colWidth);
 
-    y += ROW_H;
-    
-    //显示普通学生列表
-    auto students = studentMgr.getAllStudents(g_pageParam);
-    
-    for (const auto& s : students) {
-        int x = 50;
-        settextcolor(BLACK);
-        settextstyle(20, 0, "宋体");
-        
-        //使用_T()宏正确处理字符串
-        outtextxy(x + 5, y + 5, _T(s.studentId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(s.studentName.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(s.gender.c_str())); x += colWidth;
-        
-        std::string ageStr = std::to_string(s.age);
-        outtextxy(x + 5, y + 5, _T(ageStr.c_str())); x += colWidth;
-        
-        outtextxy(x + 5, y + 5, _T(s.major.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(s.dormId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(s.studentPhone.c_str())); x += colWidth;
-        
-        std::string dateStr = Common::dateToString(s.checkInDate);
-        outtextxy(x + 5, y + 5, _T(dateStr.c_str()));
-        
-        y += ROW_H;
-    }
-    
-    drawFooter(studentMgr.getStudentTotalCount());
+    drawFooter();
+    drawCurrentTable();
 }
 
 void drawDormManage() {
@@ -376,34 +460,15 @@ void drawDormManage() {
     drawButton(50, y, "添加宿舍");
     drawButton(180, y, "修改宿舍");
     drawButton(310, y, "删除宿舍");
+    drawButton(440, y, "空床查询");
 
     y += 60;
     std::vector<std::string> headers = { "宿舍号", "楼号", "类型", "最大容量", "当前人数", "管理电话" };
     int colWidth = (WINDOW_W - 100) / static_cast<int>(headers.size());
     drawTableHeader(50, y, headers, colWidth);
 
-    auto dorms = dormMgr.getAllDorms(g_pageParam);
-    y += ROW_H;
-    for (const auto& d : dorms) {
-        int totalWidth = static_cast<int>(headers.size()) * colWidth;
-        int x = 50;
-        
-        //使用_T()宏正确处理字符串
-        outtextxy(x + 5, y + 5, _T(d.dormId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(d.building.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(d.roomType.c_str())); x += colWidth;
-        
-        std::string capStr = std::to_string(d.maxCapacity);
-        outtextxy(x + 5, y + 5, _T(capStr.c_str())); x += colWidth;
-        
-        std::string occStr = std::to_string(d.currentOccupancy);
-        outtextxy(x + 5, y + 5, _T(occStr.c_str())); x += colWidth;
-        
-        outtextxy(x + 5, y + 5, _T(d.dormManager.c_str()));
-        
-        y += ROW_H;
-    }
-    drawFooter(dormMgr.getDormTotalCount());
+    drawFooter();
+    drawCurrentTable();
 }
 
 void drawFeeManage() {
@@ -414,50 +479,18 @@ void drawFeeManage() {
     drawButton(50, y, "添加收费");
     drawButton(180, y, "修改状态");
     drawButton(310, y, "删除记录");
+    drawButton(440, y, "月度出账");
+    drawButton(570, y, "抄表导入");
+    drawButton(700, y, "欠费查询");
+    drawButton(830, y, "费用报表");
 
     y += 60;
     std::vector<std::string> headers = { "收费ID", "学号", "宿舍", "月份", "水费", "电费", "合计", "状态", "支付日期" };
     int colWidth = (WINDOW_W - 100) / static_cast<int>(headers.size());
     drawTableHeader(50, y, headers, colWidth);
 
-    auto fees = feeMgr.getAllFees(g_pageParam);
-
-    y += ROW_H;
-    for (const auto& f : fees) {
-        settextcolor(BLACK);
-        int totalWidth = static_cast<int>(headers.size()) * colWidth;
-        int x = 50;
-        settextstyle(20, 0, "宋体");
-        
-        //使用_T()宏正确处理字符串
-        outtextxy(x + 5, y + 5, _T(f.feeId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(f.studentId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(f.dormId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(f.feeMonth.c_str())); x += colWidth;
-        
-        std::stringstream waterStream;
-        waterStream << std::fixed << std::setprecision(2) << f.waterFee;
-        outtextxy(x + 5, y + 5, _T(waterStream.str().c_str())); x += colWidth;
-        
-        std::stringstream elecStream;
-        elecStream << std::fixed << std::setprecision(2) << f.electricFee;
-        outtextxy(x + 5, y + 5, _T(elecStream.str().c_str())); x += colWidth;
-        
-        std::stringstream totalStream;
-        totalStream << std::fixed << std::setprecision(2) << f.totalFee;
-        outtextxy(x + 5, y + 5, _T(totalStream.str().c_str())); x += colWidth;
-        
-        std::string statusStr = (f.payStatus == PayStatus::PAID) ? "已付" : "未付";
-        outtextxy(x + 5, y + 5, _T(statusStr.c_str())); x += colWidth;
-        
-        //未付状态时支付日期为空，已付状态时显示支付日期
-        std::string dateStr = (f.payStatus == PayStatus::PAID) ? Common::dateToString(f.payDate) : "";
-        outtextxy(x + 5, y + 5, _T(dateStr.c_str()));
-
-        y += ROW_H;
-    }
-
-    drawFooter(feeMgr.getFeeTotalCount());
+    drawFooter();
+    drawCurrentTable();
 }
 
 void drawRepairManage() {
@@ -468,55 +501,15 @@ void drawRepairManage() {
     drawButton(50, y, "添加报修");
     drawButton(180, y, "处理报修");
     drawButton(310, y, "删除记录");
+    drawButton(440, y, "领取任务");
 
     y += 60;
     std::vector<std::string> headers = { "报修ID", "学号", "宿舍", "内容", "申请日期", "状态", "处理日期" };
     int colWidth = (WINDOW_W - 100) / static_cast<int>(headers.size());
     drawTableHeader(50, y, headers, colWidth);
 
-    auto repairs = repairMgr.getAllRepairs(g_pageParam);
-
-    y += ROW_H;
-    for (const auto& r : repairs) {
-        settextcolor(BLACK);
-        int totalWidth = static_cast<int>(headers.size()) * colWidth;
-        int x = 50;
-        settextstyle(20, 0, "宋体");
-        
-        //使用_T()宏正确处理字符串
-        outtextxy(x + 5, y + 5, _T(r.repairId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(r.studentId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(r.dormId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(r.repairContent.c_str())); x += colWidth;
-        
-        std::string dateStr = Common::dateToString(r.repairDate);
-        outtextxy(x + 5, y + 5, _T(dateStr.c_str())); x += colWidth;
-        
-        std::string statusStr;
-        if (r.handleStatus == RepairStatus::UNHANDLED) statusStr = "未处理";
-        else if (r.handleStatus == RepairStatus::HANDLING) statusStr = "处理中";
-        else statusStr = "已完成";
-        outtextxy(x + 5, y + 5, _T(statusStr.c_str())); x += colWidth;
-        
-        //处理日期显示：如果状态为未处理，显示"未处理"，否则显示实际日期
-        std::string handleDateStr;
-        if (r.handleStatus == RepairStatus::UNHANDLED) {
-            handleDateStr = "未处理";
-        } else {
-            //已处理或处理中状态，显示处理日期
-            //检查是否是有效日期（非0-0-0表示实际设置了日期）
-            if (r.handleDate.year > 0 && r.handleDate.month > 0 && r.handleDate.day > 0) {
-                handleDateStr = Common::dateToString(r.handleDate);
-            } else {
-                handleDateStr = "未设置";
-            }
-        }
-        outtextxy(x + 5, y + 5, _T(handleDateStr.c_str()));
-
-        y += ROW_H;
-    }
-
-    drawFooter(repairMgr.getRepairTotalCount());
+    drawFooter();
+    drawCurrentTable();
 }
 
 void drawVisitorManage() {
@@ -527,46 +520,17 @@ void drawVisitorManage() {
     drawButton(50, y, "登记访客");
     drawButton(180, y, "访客离开");
     drawButton(310, y, "删除记录");
+    drawButton(440, y, "黑名单");
+    drawButton(570, y, "访客档案");
+    drawButton(700, y, "时段统计");
 
     y += 60;
     std::vector<std::string> headers = { "访客ID", "姓名", "性别", "身份证", "宿舍号", "访问事由", "来访时间", "离开时间", "登记人" };
     int colWidth = (WINDOW_W - 100) / static_cast<int>(headers.size());
     drawTableHeader(50, y, headers, colWidth);
 
-    auto visitors = visitorMgr.getAllVisitors(g_pageParam);
-
-    y += ROW_H;
-    for (const auto& v : visitors) {
-        settextcolor(BLACK);
-        int totalWidth = static_cast<int>(headers.size()) * colWidth;
-        int x = 50;
-        settextstyle(20, 0, "宋体");
-        
-        //使用_T()宏正确处理字符串
-        outtextxy(x + 5, y + 5, _T(v.visitorId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(v.visitorName.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(v.gender.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T("***")); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(v.dormId.c_str())); x += colWidth;
-        outtextxy(x + 5, y + 5, _T(v.visitReason.c_str())); x += colWidth;
-        
-        std::string visitTimeOnly = v.visitTime.substr(11, 5);
-        outtextxy(x + 5, y + 5, _T(visitTimeOnly.c_str())); x += colWidth;
-        
-        std::string leaveTimeOnly;
-        if (v.leaveTime.length() >= 16) {
-            leaveTimeOnly = v.leaveTime.substr(11, 5);
-        } else {
-            leaveTimeOnly = "未离开";
-        }
-        outtextxy(x + 5, y + 5, _T(leaveTimeOnly.c_str())); x += colWidth;
-        
-        outtextxy(x + 5, y + 5, _T(v.registerAdmin.c_str()));
-
-        y += ROW_H;
-    }
-
-    drawFooter(visitorMgr.getVisitorTotalCount());
+    drawFooter();
+    drawCurrentTable();
 }
 
 void handleMainMenu(int x, int y) {
@@ -741,6 +705,33 @@ void handleStudentEvent(int x, int y) {
         }
         drawCurrentScreen("", BLACK); //立即重绘界面
     }
+    else if (Common::isPointInRect(x, y, 700, 100, BTN_W, BTN_H)) {
+        //新生批量入住：按名单自动分配宿舍并批量写入
+        std::string path = showInputBox("新生批量入住", "名单文件路径(CSV):");
+        if (path.empty()) return;
+        AssignmentConstraints constraints;
+        std::string buildings = showInputBox("新生批量入住", "优先楼栋(逗号分隔，可选):");
+        std::stringstream ss(buildings);
+        std::string building;
+        while (std::getline(ss, building, ',')) {
+            if (!Common::trim(building).empty()) constraints.preferredBuildings.push_back(Common::trim(building));
+        }
+        constraints.roomType = showInputBox("新生批量入住", "房间类型(4/6/8，可选):");
+
+        g_tipMsg = "正在分配宿舍..."; g_tipColor = BLACK;
+        drawCurrentScreen("", BLACK);
+        DormAssignment assignment;
+        AssignmentResult result;
+        if (assignment.runFile(path, constraints, result)) {
+            g_tipMsg = "分配完成：入住" + std::to_string(result.assigned.size()) + "人，未分配"
+                + std::to_string(result.unassigned.size()) + "人，格式错误" + std::to_string(result.rejectedLines.size()) + "行";
+            g_tipColor = result.unassigned.empty() && result.rejectedLines.empty() ? 0x00AA00 : RED;
+        }
+        else {
+            g_tipMsg = "批量入住失败: " + assignment.getLastError(); g_tipColor = RED;
+        }
+        drawCurrentScreen("", BLACK); //立即重绘界面
+    }
 }
 
 void handleDormEvent(int x, int y) {
@@ -817,6 +808,31 @@ void handleDormEvent(int x, int y) {
             }
         }
     }
+    else if (Common::isPointInRect(x, y, 440, 100, BTN_W, BTN_H)) {
+        std::string building = showInputBox("空床查询", "楼号(如1栋):");
+        if (building.empty()) return;
+        std::string roomType = showInputBox("空床查询", "类型(4/6/8，留空不限):");
+        std::string freeStr = showInputBox("空床查询", "至少空床数(默认1):");
+        int minFree = 1;
+        if (!freeStr.empty() && !Common::stringToInt(freeStr, minFree)) {
+            g_tipMsg = "空床数格式错误"; g_tipColor = RED; return;
+        }
+
+        std::vector<Dorm> dorms = dormMgr.findDormsWithFreeBeds(building, roomType, minFree, 10);
+        if (dorms.empty()) {
+            std::string err = dormMgr.getLastError();
+            g_tipMsg = err.empty() ? "没有满足条件的宿舍" : "查询失败: " + err;
+            g_tipColor = err.empty() ? BLACK : RED;
+        }
+        else {
+            g_tipMsg = "空床宿舍:";
+            for (const auto& d : dorms) {
+                g_tipMsg += " " + d.dormId + "(" + std::to_string(d.maxCapacity - d.currentOccupancy) + ")";
+            }
+            g_tipColor = 0x00AA00;
+        }
+        drawCurrentScreen("", BLACK); //立即重绘界面
+    }
 }
 
 void handleFeeEvent(int x, int y) {
@@ -872,6 +888,140 @@ void handleFeeEvent(int x, int y) {
             }
         }
     }
+    else if (Common::isPointInRect(x, y, 440, 100, BTN_W, BTN_H)) {
+        BillingParams params;
+        params.feeMonth = showInputBox("月度出账", "月份(YYYY-MM):");
+        if (params.feeMonth.empty()) return;
+        std::string waterStr = showInputBox("月度出账", "每间宿舍水费:");
+        std::string elecStr = showInputBox("月度出账", "每间宿舍电费:");
+        if (!Common::stringToDouble(waterStr, params.dormWaterFee) || !Common::stringToDouble(elecStr, params.dormElectricFee)) {
+            g_tipMsg = "费用格式错误"; g_tipColor = RED; return;
+        }
+
+        BillingRun billing;
+        bool ok = billing.run(params, [](int done, int total) {
+            g_tipMsg = "出账中: " + std::to_string(done) + " / " + std::to_string(total); g_tipColor = BLACK;
+            drawCurrentScreen("", BLACK);
+        });
+        if (ok) {
+            g_tipMsg = "出账完成：新增" + std::to_string(billing.getCreatedCount()) + "条，跳过已出账"
+                + std::to_string(billing.getSkippedCount()) + "人";
+            g_tipColor = 0x00AA00;
+        }
+        else {
+            g_tipMsg = "出账失败: " + billing.getLastError(); g_tipColor = RED;
+        }
+        drawCurrentScreen("", BLACK); //立即重绘界面
+    }
+    else if (Common::isPointInRect(x, y, 570, 100, BTN_W, BTN_H)) {
+        std::string path = showInputBox("抄表导入", "读数文件路径(CSV):");
+        if (path.empty()) return;
+        MeterIngestParams params;
+        std::string waterStr = showInputBox("抄表导入", "水价(元/立方米):");
+        std::string elecStr = showInputBox("抄表导入", "电价(元/千瓦时):");
+        if (!Common::stringToDouble(waterStr, params.waterPrice) || !Common::stringToDouble(elecStr, params.electricPrice)) {
+            g_tipMsg = "价格格式错误"; g_tipColor = RED; return;
+        }
+
+        MeterIngest ingest;
+        if (ingest.ingestFile(path, params)) {
+            const MeterIngestStats& st = ingest.getStats();
+            g_tipMsg = "导入完成：读数" + std::to_string(st.readingCount) + "条，生成费用" + std::to_string(st.feeCount)
+                + "条，拒绝" + std::to_string(st.rejectedCount) + "条（其中已出账冲突" + std::to_string(st.conflictCount) + "条）";
+            g_tipColor = st.rejectedCount > 0 ? RED : 0x00AA00;
+        }
+        else {
+            g_tipMsg = "导入失败: " + ingest.getLastError(); g_tipColor = RED;
+        }
+        drawCurrentScreen("", BLACK); //立即重绘界面
+    }
+    else if (Common::isPointInRect(x, y, 700, 100, BTN_W, BTN_H)) {
+        //欠费查询：取自欠费索引，不扫描fee表
+        ArrearsIndex& arrears = ArrearsIndex::getInstance();
+        std::string monthsStr = showInputBox("欠费查询", "未缴月数超过(留空列出欠费最多的前15名):");
+        std::vector<ArrearsEntry> entries;
+        std::string title;
+        int minMonths = 0;
+        if (Common::trim(monthsStr).empty()) {
+            entries = arrears.getTopDebtors(15);
+            title = "欠费最多的学生";
+        }
+        else if (Common::stringToInt(monthsStr, minMonths) && minMonths >= 0) {
+            entries = arrears.getStudentsWithUnpaidMonthsOver(minMonths);
+            title = "未缴超过" + std::to_string(minMonths) + "个月的学生";
+        }
+        else {
+            g_tipMsg = "月数格式错误"; g_tipColor = RED; return;
+        }
+
+        std::vector<std::string> lines;
+        for (const auto& entry : entries) {
+            if (lines.size() >= 15) break;
+            lines.push_back(entry.studentId + "  欠费 " + Common::centsToString(entry.balanceCents) + " 元  最早 "
+                + entry.oldestUnpaidMonth + "  共 " + std::to_string(entry.unpaidMonths) + " 个月");
+        }
+        if (entries.size() > lines.size()) lines.push_back("……共 " + std::to_string(entries.size()) + " 人");
+        lines.push_back("");
+        std::string buildingLine = "各楼栋欠费:";
+        for (const auto& item : arrears.getOutstandingByBuilding()) {
+            buildingLine += "  " + (item.first.empty() ? std::string("未知楼栋") : item.first) + " "
+                + Common::centsToString(item.second) + " 元";
+        }
+        lines.push_back(buildingLine);
+        showInfoLinesDialog(title, lines);
+
+        std::string path = showInputBox("欠费查询", "导出全部欠费到CSV(路径，留空不导出):");
+        if (!path.empty()) {
+            if (arrears.exportCsv(path, TextEncoding::UTF8)) {
+                g_tipMsg = "欠费名单已导出"; g_tipColor = 0x00AA00;
+            }
+            else {
+                g_tipMsg = "导出失败：无法写入" + path; g_tipColor = RED;
+            }
+            drawCurrentScreen("", BLACK); //立即重绘界面
+        }
+    }
+    else if (Common::isPointInRect(x, y, 830, 100, BTN_W, BTN_H)) {
+        //费用报表：按列存储整表加载一次，月份和楼栋汇总走列扫描
+        FeeColumnStore store;
+        if (!store.load()) {
+            g_tipMsg = "报表加载失败: " + store.getLastError(); g_tipColor = RED;
+            drawCurrentScreen("", BLACK); //立即重绘界面
+            return;
+        }
+        std::vector<FeeGroupTotals> months = store.groupByMonth();
+        if (months.empty()) {
+            g_tipMsg = "暂无收费记录"; g_tipColor = RED;
+            drawCurrentScreen("", BLACK); //立即重绘界面
+            return;
+        }
+        std::string month = Common::trim(showInputBox("费用报表", "楼栋明细月份(YYYY-MM，留空取最近一个月):"));
+        if (month.empty()) month = months.back().key;
+
+        std::vector<std::string> lines;
+        //只列最近6个月，留出楼栋明细的行
+        size_t first = months.size() > 6 ? months.size() - 6 : 0;
+        for (size_t i = first; i < months.size(); ++i) {
+            const FeeGroupTotals& t = months[i];
+            lines.push_back(t.key + "  应收 " + Common::centsToString(t.totalCents) + " 元  已收 "
+                + Common::centsToString(t.paidCents) + " 元  未收 " + Common::centsToString(t.unpaidCents)
+                + " 元（" + std::to_string(t.unpaidCount) + " 笔）");
+        }
+        lines.push_back("");
+        lines.push_back(month + " 各楼栋:");
+        std::vector<FeeGroupTotals> buildings = store.groupByBuilding(month);
+        if (buildings.empty()) lines.push_back("  该月无收费记录");
+        for (const auto& t : buildings) {
+            lines.push_back("  " + (t.key.empty() ? std::string("未知楼栋") : t.key) + "  应收 "
+                + Common::centsToString(t.totalCents) + " 元  未收 " + Common::centsToString(t.unpaidCents) + " 元");
+        }
+        FeeGroupTotals all = store.totals();
+        lines.push_back("");
+        lines.push_back("全部 " + std::to_string(store.size()) + " 笔  应收 " + Common::centsToString(all.totalCents)
+            + " 元  未收 " + Common::centsToString(all.unpaidCents) + " 元"
+            + (FeeColumnStore::isSimdEnabled() ? "（AVX2）" : ""));
+        showInfoLinesDialog("费用报表", lines);
+    }
 }
 
 void handleRepairEvent(int x, int y) {
@@ -883,7 +1033,14 @@ void handleRepairEvent(int x, int y) {
         r.dormId = showInputBox("添加报修", "宿舍:");
         r.repairContent = showInputBox("添加报修", "内容:");
 
-        if (repairMgr.addRepair(r)) {
+        bool added = repairMgr.addRepair(r);
+        if (!added && !repairMgr.getLastDuplicate().empty()) {
+            std::string confirm = showInputBox("添加报修", "与报修" + repairMgr.getLastDuplicate() + "疑似重复，仍要提交请输入Y:");
+            if (confirm == "Y" || confirm == "y") {
+                added = repairMgr.addRepair(r, true);
+            }
+        }
+        if (added) {
             g_tipMsg = "提交成功"; g_tipColor = 0x00AA00;
             drawCurrentScreen("", BLACK); //立即重绘界面
         }
@@ -918,6 +1075,20 @@ void handleRepairEvent(int x, int y) {
             }
         }
     }
+    else if (Common::isPointInRect(x, y, 440, 100, BTN_W, BTN_H)) {
+        std::string building = showInputBox("领取任务", "楼栋(留空表示不限):");
+
+        DispatchTicket ticket;
+        if (RepairDispatcher::getInstance().claimNext(building, ticket)) {
+            g_tipMsg = "已领取报修" + ticket.repairId + "：" + ticket.dormId + " " + ticket.content
+                + "，请于" + Common::dateToString(ticket.dueDate) + "前处理";
+            g_tipColor = 0x00AA00;
+        }
+        else {
+            g_tipMsg = "领取失败: " + RepairDispatcher::getInstance().getLastError(); g_tipColor = RED;
+        }
+        drawCurrentScreen("", BLACK); //立即重绘界面
+    }
 }
 
 void handleVisitorEvent(int x, int y) {
@@ -958,6 +1129,12 @@ void handleVisitorEvent(int x, int y) {
 
         if (visitorMgr.addVisitor(v)) {
             g_tipMsg = "添加成功"; g_tipColor = 0x00AA00;
+            //多次来访的访客提示历史，便于核对
+            VisitorProfile profile;
+            if (VisitorProfileIndex::getInstance().getProfile(v.idCard, profile) && profile.visitCount > 1) {
+                g_tipMsg += "（该访客第" + std::to_string(profile.visitCount) + "次来访，到访过"
+                    + std::to_string(profile.dormsVisited.size()) + "间宿舍）";
+            }
             drawCurrentScreen("", BLACK); //立即重绘界面
         }
         else {
@@ -980,7 +1157,7 @@ void handleVisitorEvent(int x, int y) {
             leaveTimeOnly = leaveTime;
         }
 
-        if (visitorMgr.recordLeave(id, Date(), leaveTimeOnly)) {
+        if (visitorMgr.recordLeave(id, Date::today(), leaveTimeOnly)) {
             g_tipMsg = "离开登记成功"; g_tipColor = 0x00AA00;
             drawCurrentScreen("", BLACK); //立即重绘界面
         }
@@ -1003,9 +1180,113 @@ void handleVisitorEvent(int x, int y) {
             }
         }
     }
+    else if (Common::isPointInRect(x, y, 440, 100, BTN_W, BTN_H)) {
+        std::string idCard = showInputBox("黑名单", "身份证号:");
+        if (idCard.empty()) return;
+
+        VisitorProfileIndex& profileIndex = VisitorProfileIndex::getInstance();
+        bool ok = false;
+        if (profileIndex.isBlacklisted(idCard)) {
+            std::string confirm = showInputBox("黑名单", "该身份证号已在黑名单中，输入Y移出:");
+            if (confirm != "Y" && confirm != "y") return;
+            ok = profileIndex.removeFromBlacklist(idCard);
+            g_tipMsg = ok ? "已移出黑名单" : "操作失败: " + profileIndex.getLastError();
+        }
+        else {
+            std::string reason = showInputBox("黑名单", "列入原因:");
+            ok = profileIndex.addToBlacklist(idCard, reason);
+            g_tipMsg = ok ? "已加入黑名单" : "操作失败: " + profileIndex.getLastError();
+        }
+        g_tipColor = ok ? 0x00AA00 : RED;
+        drawCurrentScreen("", BLACK); //立即重绘界面
+    }
+    else if (Common::isPointInRect(x, y, 570, 100, BTN_W, BTN_H)) {
+        std::string idCard = showInputBox("访客档案", "身份证号:");
+        if (idCard.empty()) return;
+
+        //档案取自内存索引，不扫描visitor表
+        VisitorProfile profile;
+        if (!VisitorProfileIndex::getInstance().getProfile(idCard, profile)) {
+            std::string error = VisitorProfileIndex::getInstance().getLastError();
+            g_tipMsg = error.empty() ? "未查询到该访客的来访记录" : "查询失败: " + error; g_tipColor = RED;
+            drawCurrentScreen("", BLACK); //立即重绘界面
+            return;
+        }
+
+        std::vector<std::string> lines;
+        lines.push_back("身份证号: " + profile.idCard);
+        lines.push_back("姓名: " + (profile.visitorName.empty() ? std::string("-") : profile.visitorName));
+        lines.push_back("来访次数: " + std::to_string(profile.visitCount));
+        lines.push_back("最近来访: " + (profile.lastVisit.empty() ? std::string("-") : profile.lastVisit));
+        std::string dormLine = "到访宿舍:";
+        for (const auto& dormId : profile.dormsVisited) dormLine += " " + dormId;
+        if (profile.dormsVisited.empty()) dormLine += " -";
+        lines.push_back(dormLine);
+        lines.push_back(profile.blacklisted ? "黑名单: 是（" + profile.blacklistReason + "）" : "黑名单: 否");
+        showInfoLinesDialog("访客档案", lines);
+    }
+    else if (Common::isPointInRect(x, y, 700, 100, BTN_W, BTN_H)) {
+        std::string dateStr = Common::trim(showInputBox("时段统计", "日期(YYYY-MM-DD，留空为今天):"));
+        if (dateStr.empty()) dateStr = Common::getCurrentDateStr();
+        if (!Common::isValidDate(dateStr)) {
+            g_tipMsg = "日期格式错误"; g_tipColor = RED;
+            drawCurrentScreen("", BLACK); //立即重绘界面
+            return;
+        }
+        std::string building = Common::trim(showInputBox("时段统计", "楼栋(留空为全部):"));
+
+        //统计取自内存时间索引，不扫描visitor表
+        VisitorTimeIndex& timeIndex = VisitorTimeIndex::getInstance();
+        Date date = Common::stringToDate(dateStr);
+        std::string dayStart = dateStr + " 00:00";
+        std::string dayEnd = Common::dateToString(Common::daysToDate(Common::dateToDays(date) + 1)) + " 00:00";
+        std::array<int, 24> hourly = timeIndex.getHourlyArrivals(date, date, building);
+        std::vector<VisitSpan> spans = timeIndex.findOverlapping(dayStart, dayEnd, building);
+
+        std::vector<std::string> lines;
+        lines.push_back("日期: " + dateStr + "  楼栋: " + (building.empty() ? std::string("全部") : building));
+        lines.push_back("当前在访: " + std::to_string(timeIndex.countPresentAt(Common::getCurrentDateTimeStr(), building)) + " 人");
+        lines.push_back("当日在访(含跨日停留): " + std::to_string(spans.size()) + " 人次");
+        int peakHour = static_cast<int>(std::max_element(hourly.begin(), hourly.end()) - hourly.begin());
+        if (hourly[peakHour] > 0) {
+            lines.push_back("到访高峰: " + Common::padLeft(std::to_string(peakHour), 2, '0') + ":00-"
+                + Common::padLeft(std::to_string(peakHour + 1), 2, '0') + ":00（" + std::to_string(hourly[peakHour]) + " 人）");
+        }
+        for (int h = 0; h < 24; h += 6) {
+            std::string hourLine = Common::padLeft(std::to_string(h), 2, '0') + "-"
+                + Common::padLeft(std::to_string(h + 5), 2, '0') + "时到访:";
+            for (int i = h; i < h + 6; ++i) hourLine += "  " + std::to_string(hourly[i]);
+            lines.push_back(hourLine);
+        }
+        lines.push_back("");
+        for (const auto& span : spans) {
+            if (lines.size() >= 17) break;
+            lines.push_back(span.visitorId + "  " + span.dormId + "  " + span.visitTime + " ~ "
+                + (span.leaveTime.empty() ? std::string("未离开") : span.leaveTime));
+        }
+        showInfoLinesDialog("时段统计", lines);
+    }
 }
 
 
+//费用汇总和报修统计首次加载需全表扫描，交给工作线程；
+//加载失败（如离线）时每10秒最多重试一次，避免每次重绘都重新投递
+static time_t g_analyticsLoadAt = 0;
+
+static bool ensureAnalyticsLoading() {
+    if (FeeRollup::getInstance().isLoaded() && RepairAnalytics::getInstance().isLoaded()) return true;
+    time_t now = time(nullptr);
+    if (!ViewModel::getInstance().isLoading() && now - g_analyticsLoadAt >= 10) {
+        g_analyticsLoadAt = now;
+        ViewModel::getInstance().post([]() -> ViewApply {
+            FeeRollup::getInstance().ensureLoaded();
+            RepairAnalytics::getInstance().ensureLoaded();
+            return ViewApply();
+        });
+    }
+    return false;
+}
+
 void drawStatistics() {
     drawBackground();
     drawTitleBar("系统统计");
@@ -1016,15 +1297,25 @@ void drawStatistics() {
     int startY = 150;
     int gap = 50;
     
-    int studentCount = studentMgr.getStudentTotalCount();
-    int dormCount = dormMgr.getDormTotalCount();
-    int feeCount = feeMgr.getFeeTotalCount();
-    int repairCount = repairMgr.getRepairTotalCount();
-    int visitorCount = visitorMgr.getVisitorTotalCount();
+    //计数取自统计快照，不访问数据库；后台尚未完成首次加载时交给工作线程刷新
+    std::shared_ptr<const StatsSnapshot> stats = StatsService::getInstance().getSnapshot();
+    if (!stats->valid && !ViewModel::getInstance().isLoading()) {
+        ViewModel::getInstance().post([]() -> ViewApply {
+            StatsService::getInstance().refreshNow();
+            return ViewApply();
+        });
+    }
+    bool analyticsReady = ensureAnalyticsLoading();
+    drawLoadingHint(!stats->valid || !analyticsReady);
+    int studentCount = stats->get(StatsCounter::STUDENTS);
+    int dormCount = stats->get(StatsCounter::DORMS);
+    int feeCount = stats->get(StatsCounter::FEES);
+    int repairCount = stats->get(StatsCounter::REPAIRS);
+    int visitorCount = stats->get(StatsCounter::VISITORS);
     
     //获取更精确的统计数据
-    int activeVisitorCount = visitorMgr.getActiveVisitorCount();
-    int unpaidFeeCount = feeMgr.getUnpaidFeeCount();
+    int activeVisitorCount = stats->get(StatsCounter::ACTIVE_VISITORS);
+    int unpaidFeeCount = stats->get(StatsCounter::UNPAID_FEES);
     
     //使用_T()宏正确处理字符串
     std::string studentText = "学生总数: " + std::to_string(studentCount) + " 人";
@@ -1058,7 +1349,7 @@ void drawStatistics() {
     }
     outtextxy(WINDOW_W - 280, startY + 50, _T(usageRate.c_str()));
     
-    int unhandledRepairs = repairMgr.getUnfinishedRepairCount();
+    int unhandledRepairs = stats->get(StatsCounter::UNFINISHED_REPAIRS);
     std::string repairInfo = "未处理报修: " + std::to_string(unhandledRepairs) + " 条";
     outtextxy(WINDOW_W - 280, startY + 80, _T(repairInfo.c_str()));
     
@@ -1069,10 +1360,52 @@ void drawStatistics() {
     int activeVisitors = activeVisitorCount;
     std::string visitorInfo = "当前访客: " + std::to_string(activeVisitors) + " 人";
     outtextxy(WINDOW_W - 280, startY + 140, _T(visitorInfo.c_str()));
+
+    //本月未缴金额取自费用汇总，不扫描fee表；汇总未加载完时不在界面线程查询
+    Date today = Date::today();
+    std::ostringstream monthStream;
+    monthStream << today.year() << "-" << std::setw(2) << std::setfill('0') << today.month();
+    std::string unpaidInfo = "本月未缴: 加载中";
+    if (analyticsReady) {
+        FeeTotals monthTotals = FeeRollup::getInstance().getTotals(monthStream.str());
+        unpaidInfo = "本月未缴: " + Common::doubleToString(monthTotals.unpaidCents / 100.0) + " 元";
+    }
+    outtextxy(WINDOW_W - 280, startY + 170, _T(unpaidInfo.c_str()));
+
+    //本月各楼栋报修处理时长取自增量统计
+    settextcolor(0x0066CC);
+    settextstyle(20, 0, "宋体");
+    outtextxy(100, startY + gap * 6, _T("本月报修处理时长"));
+    settextcolor(0x333333);
+    settextstyle(14, 0, "宋体");
+    if (!analyticsReady) {
+        outtextxy(100, startY + gap * 6 + 30, _T("加载中"));
+    }
+    else {
+        TurnaroundStats monthRepair = RepairAnalytics::getInstance().getStats(monthStream.str());
+        std::string turnaroundInfo = "全部: " + std::to_string(monthRepair.count) + " 单  平均 "
+            + Common::doubleToString(monthRepair.meanDays, 1) + " 天  P90 " + std::to_string(monthRepair.p90Days) + " 天";
+        outtextxy(100, startY + gap * 6 + 30, _T(turnaroundInfo.c_str()));
+        int buildingRow = 0;
+        for (const auto& item : RepairAnalytics::getInstance().getBuildingStats(monthStream.str())) {
+            if (buildingRow >= 6) break;
+            std::string buildingName = item.first.empty() ? "未知楼栋" : item.first;
+            std::string line = buildingName + ": " + std::to_string(item.second.count) + " 单  平均 "
+                + Common::doubleToString(item.second.meanDays, 1) + " 天  P90 " + std::to_string(item.second.p90Days) + " 天";
+            outtextxy(100 + (buildingRow % 2) * 380, startY + gap * 6 + 55 + (buildingRow / 2) * 22, _T(line.c_str()));
+            buildingRow++;
+        }
+    }
     
     settextcolor(0x666666);
     settextstyle(14, 0, "宋体");
-    std::string timeInfo = "更新时间: " + Common::getCurrentDateTimeStr();
+    char timeBuf[32] = "";
+    time_t refreshedAt = stats->refreshedAt;
+    struct tm refreshedTm;
+    if (refreshedAt != 0 && localtime_s(&refreshedTm, &refreshedAt) == 0) {
+        strftime(timeBuf, sizeof(timeBuf), "%Y-%m-%d %H:%M:%S", &refreshedTm);
+    }
+    std::string timeInfo = "更新时间: " + Common::getCurrentDateTimeStr() + "  (全量校准: " + timeBuf + ")";
     outtextxy(100, startY + gap * 5 + 20, _T(timeInfo.c_str()));
 }
 
@@ -1254,4 +1587,62 @@ void showStudentInfoQueryResult(const Student& student) {
     }
     //重新绘制当前界面来清除对话框
     drawCurrentScreen("", BLACK);
-}
\ No newline at end of file
+}
+
+//显示多行文本结果对话框
+void showInfoLinesDialog(const std::string& title, const std::vector<std::string>& lines) {
+    const int DIALOG_W = 760;
+    const int DIALOG_H = 520;
+    const int ROW_H = 25;
+
+    int dialogX = (WINDOW_W - DIALOG_W) / 2;
+    int dialogY = (WINDOW_H - DIALOG_H) / 2;
+
+    //绘制对话框背景
+    setfillcolor(0xFFFFFF); //WHITE
+    fillrectangle(dialogX, dialogY, dialogX + DIALOG_W, dialogY + DIALOG_H);
+
+    //绘制标题栏
+    setfillcolor(0x0066CC);
+    fillrectangle(dialogX, dialogY, dialogX + DIALOG_W, dialogY + 30);
+
+    settextcolor(WHITE);
+    settextstyle(16, 0, _T("宋体"));
+    outtextxy(dialogX + 10, dialogY + 7, _T(title.c_str()));
+
+    //绘制关闭按钮
+    setfillcolor(0xCC0000);
+    fillrectangle(dialogX + DIALOG_W - 30, dialogY + 5, dialogX + DIALOG_W - 10, dialogY + 25);
+    settextcolor(WHITE);
+    settextstyle(12, 0, "宋体");
+    outtextxy(dialogX + DIALOG_W - 25, dialogY + 8, _T("X"));
+
+    //逐行显示，超出对话框的行不再绘制
+    int y = dialogY + 45;
+    settextcolor(BLACK);
+    settextstyle(14, 0, _T("宋体"));
+    if (lines.empty()) outtextxy(dialogX + 20, y, _T("没有记录"));
+    for (const auto& line : lines) {
+        if (y > dialogY + DIALOG_H - ROW_H) break;
+        outtextxy(dialogX + 20, y, _T(line.c_str()));
+        y += ROW_H;
+    }
+
+    //等待用户点击关闭
+    bool dialogActive = true;
+    while (dialogActive) {
+        ExMessage msg;
+        if (peekmessage(&msg, EX_MOUSE)) {
+            if (msg.message == WM_LBUTTONDOWN) {
+                //检查是否点击关闭按钮
+                if (msg.x >= dialogX + DIALOG_W - 30 && msg.x <= dialogX + DIALOG_W - 10 &&
+                    msg.y >= dialogY + 5 && msg.y <= dialogY + 25) {
+                    dialogActive = false;
+                }
+            }
+        }
+        Sleep(10);
+    }
+    //重新绘制当前界面来清除对话框
+    drawCurrentScreen("", BLACK);
+}
@@ -30,6 +30,9 @@ void drawStatistics();
 void drawMultiTableQuery();
 void drawCurrentScreen(const std::string& tip = "", COLORREF tipColor = BLACK);
 
+// 列表数据返回后只重绘变化的表格行（无法局部重绘时返回false）
+bool refreshCurrentTable();
+
 void handleMainMenu(int x, int y);
 void handleStudentEvent(int x, int y);
 void handleDormEvent(int x, int y);
@@ -0,0 +1,41 @@
+# 生成GbkTable.inc：GBK双字节编码 → Unicode码点对照表
+# 用法：python GenGbkTable.py（在项目目录下运行，覆盖GbkTable.inc）
+# 反向表（Unicode → GBK）在程序首次使用时由本表构建，GBK与Unicode一一对应。
+
+LEAD_FIRST, LEAD_LAST = 0x81, 0xFE
+TRAIL_FIRST, TRAIL_LAST = 0x40, 0xFE
+TRAIL_COUNT = TRAIL_LAST - TRAIL_FIRST + 1
+
+
+def build_table():
+    table = []
+    for lead in range(LEAD_FIRST, LEAD_LAST + 1):
+        for trail in range(TRAIL_FIRST, TRAIL_LAST + 1):
+            code = 0
+            if trail != 0x7F:
+                try:
+                    ch = bytes([lead, trail]).decode('gbk')
+                    code = ord(ch)
+                except UnicodeDecodeError:
+                    pass
+            table.append(code)
+    return table
+
+
+def main():
+    table = build_table()
+    lines = [
+        '// 由GenGbkTable.py生成，请勿手工修改',
+        '// GBK双字节编码 → Unicode码点，下标为(首字节-0x81)*191+(次字节-0x40)，0表示未定义',
+        'static const uint16_t GBK_TO_UNICODE[%d] = {' % len(table),
+    ]
+    for i in range(0, len(table), 16):
+        lines.append('    ' + ', '.join('0x%04X' % v for v in table[i:i + 16]) + ',')
+    lines.append('};')
+    with open('GbkTable.inc', 'w', encoding='utf-8', newline='\r\n') as f:
+        f.write('\n'.join(lines) + '\n')
+    print('GbkTable.inc: %d entries, %d mapped' % (len(table), sum(1 for v in table if v)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,104 @@
+#include "IdAllocator.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include <sstream>
+
+//拆分/组合可用区间
+static inline uint32_t windowNext(uint64_t w) { return static_cast<uint32_t>(w & 0xFFFFFFFFu); }
+static inline uint32_t windowEnd(uint64_t w) { return static_cast<uint32_t>(w >> 32); }
+static inline uint64_t makeWindow(uint32_t next, uint32_t end) {
+    return (static_cast<uint64_t>(end) << 32) | next;
+}
+
+IdSequence::IdSequence(const std::string& name, const std::string& seed)
+    : seqName(name), seedSql(seed), seeded(false), window(0) {
+}
+
+//向数据库预留新块：UPDATE ... LAST_INSERT_ID(next_val + n) 一条语句完成，多进程并发安全
+bool IdSequence::refill(uint32_t count) {
+    DBHelper& db = DBHelper::getInstance();
+    if (!IdAllocator::getInstance().ensureTable()) return false;
+
+    //首次使用：以现有表中的最大ID作为初始值（行已存在则忽略）
+    if (!seeded) {
+        std::ostringstream seedStream;
+        seedStream << "INSERT IGNORE INTO id_sequence (seq_name, next_val) "
+            << "SELECT '" << seqName << "', (" << seedSql << ")";
+        if (db.executeUpdate(seedStream.str()) == -1) return false;
+        seeded = true;
+    }
+
+    uint32_t blockSize = count > ID_BLOCK_SIZE ? count : ID_BLOCK_SIZE;
+    std::ostringstream sqlStream;
+    sqlStream << "UPDATE id_sequence SET next_val = LAST_INSERT_ID(next_val + " << blockSize << ") "
+        << "WHERE seq_name = '" << seqName << "'";
+
+    uint64_t hi = 0;
+    int affectedRows = db.executeUpdate(sqlStream.str(), hi);
+    if (affectedRows <= 0 || hi < blockSize || hi >= 0xFFFFFFFFull) return false;
+
+    //本进程获得 (hi - blockSize, hi] 区间
+    uint32_t start = static_cast<uint32_t>(hi - blockSize + 1);
+    uint32_t end = static_cast<uint32_t>(hi + 1);
+    window.store(makeWindow(start, end), std::memory_order_release);
+    return true;
+}
+
+int64_t IdSequence::next() {
+    return nextBlock(1);
+}
+
+int64_t IdSequence::nextBlock(uint32_t count) {
+    if (count == 0) return 0;
+
+    uint64_t cur = window.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t nextVal = windowNext(cur);
+        uint32_t endVal = windowEnd(cur);
+        if (nextVal != 0 && static_cast<uint64_t>(nextVal) + count <= endVal) {
+            //快速路径：CAS推进区间下界，无锁
+            if (window.compare_exchange_weak(cur, makeWindow(nextVal + count, endVal),
+                std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return nextVal;
+            }
+            continue;
+        }
+
+        //慢速路径：区间不足，加锁后再确认一次，避免重复预留
+        {
+            std::lock_guard<std::mutex> lock(refillMutex);
+            uint64_t latest = window.load(std::memory_order_acquire);
+            uint32_t latestNext = windowNext(latest);
+            if (latestNext == 0 || static_cast<uint64_t>(latestNext) + count > windowEnd(latest)) {
+                if (!refill(count)) return 0;
+            }
+        }
+        cur = window.load(std::memory_order_acquire);
+    }
+}
+
+IdAllocator& IdAllocator::getInstance() {
+    static IdAllocator instance;
+    return instance;
+}
+
+bool IdAllocator::ensureTable() {
+    if (tableReady.load(std::memory_order_acquire)) return true;
+
+    std::string sql = "CREATE TABLE IF NOT EXISTS id_sequence ("
+        "seq_name VARCHAR(32) NOT NULL PRIMARY KEY, "
+        "next_val BIGINT NOT NULL DEFAULT 0)";
+    if (DBHelper::getInstance().executeUpdate(sql) == -1) return false;
+
+    tableReady.store(true, std::memory_order_release);
+    return true;
+}
+
+IdSequence& IdAllocator::getSequence(const std::string& seqName, const std::string& seedSql) {
+    std::lock_guard<std::mutex> lock(mapMutex);
+    auto it = sequences.find(seqName);
+    if (it == sequences.end()) {
+        it = sequences.emplace(seqName, std::unique_ptr<IdSequence>(new IdSequence(seqName, seedSql))).first;
+    }
+    return *it->second;
+}
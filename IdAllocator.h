@@ -0,0 +1,62 @@
+#ifndef IDALLOCATOR_H
+#define IDALLOCATOR_H
+
+#include <string>
+#include <map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+// 每次向序列表预留的ID数量（hi/lo中的lo范围）
+constexpr uint32_t ID_BLOCK_SIZE = 50;
+
+// --------------- 单个序列（进程内无锁发放已预留的ID块）---------------
+class IdSequence {
+public:
+    IdSequence(const std::string& name, const std::string& seedSql);
+
+    // 获取下一个ID，预留失败返回0
+    int64_t next();
+
+    // 一次取出连续count个ID，返回首个ID（批量写入用），失败返回0
+    int64_t nextBlock(uint32_t count);
+
+    const std::string& getName() const { return seqName; }
+
+private:
+    std::string seqName;   // 序列名，对应id_sequence.seq_name
+    std::string seedSql;   // 首次使用时计算初始值的查询（返回当前最大ID）
+    bool seeded;           // 是否已写入初始值
+
+    // 当前可用区间：高32位为区间上界（不含），低32位为下一个可用值
+    std::atomic<uint64_t> window;
+    std::mutex refillMutex; // 仅在区间用尽、向数据库预留新块时使用
+
+    // 向数据库预留至少count个ID（已持有refillMutex）
+    bool refill(uint32_t count);
+};
+
+
+// --------------- ID分配服务（单例）---------------
+class IdAllocator {
+public:
+    static IdAllocator& getInstance();
+
+    // 获取（不存在则创建）指定序列，返回的引用在进程生命周期内有效
+    IdSequence& getSequence(const std::string& seqName, const std::string& seedSql);
+
+    // 确保序列表存在
+    bool ensureTable();
+
+private:
+    IdAllocator() : tableReady(false) {}
+    IdAllocator(const IdAllocator&) = delete;
+    IdAllocator& operator=(const IdAllocator&) = delete;
+
+    std::mutex mapMutex;                                        // 保护序列表
+    std::map<std::string, std::unique_ptr<IdSequence>> sequences; // 序列名 → 序列
+    std::atomic<bool> tableReady;
+};
+
+#endif // IDALLOCATOR_H
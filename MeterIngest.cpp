@@ -0,0 +1,340 @@
+#include "MeterIngest.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include "ExistenceCache.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+//每批读取的行数
+static const size_t METER_BATCH_LINES = 65536;
+//每个事务写入的费用记录数
+static const size_t METER_CHUNK_FEES = 1000;
+//最多保留的拒绝说明条数
+static const size_t METER_MAX_REJECT_NOTES = 100;
+
+//某月天数
+static int daysOfMonth(int year, int month) {
+    static const int days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || year % 400 == 0)) return 29;
+    return days[(month - 1) % 12];
+}
+
+bool MeterIngest::ensureTable() {
+    std::string sql =
+        "CREATE TABLE IF NOT EXISTS meter_reading ("
+        "dorm_id VARCHAR(10) NOT NULL, "
+        "period VARCHAR(7) NOT NULL, "
+        "water_m3 DECIMAL(12,3) NOT NULL, "
+        "kwh DECIMAL(12,3) NOT NULL, "
+        "PRIMARY KEY (dorm_id, period))";
+    if (DBHelper::getInstance().executeUpdate(sql) == -1) {
+        lastError = "创建抄表读数表失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+    return true;
+}
+
+void MeterIngest::reject(const std::string& reason) {
+    stats.rejectedCount++;
+    if (stats.rejectedLines.size() < METER_MAX_REJECT_NOTES) {
+        stats.rejectedLines.push_back(reason);
+    }
+}
+
+bool MeterIngest::parseLine(const std::string& line, MeterReading& reading, std::string& err) {
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ',')) fields.push_back(Common::trim(field));
+    if (fields.size() != 4) {
+        err = "字段数应为4";
+        return false;
+    }
+
+    reading.dormId = fields[0];
+    reading.period = fields[1];
+    if (!Common::isValidDormID(reading.dormId)) {
+        err = "宿舍号格式错误";
+        return false;
+    }
+    if (!Common::isValidFeeMonth(reading.period)) {
+        err = "月份格式错误";
+        return false;
+    }
+    if (!Common::stringToDouble(fields[2], reading.waterM3) || !Common::stringToDouble(fields[3], reading.kwh)
+        || reading.waterM3 < 0.0 || reading.kwh < 0.0) {
+        err = "读数格式错误";
+        return false;
+    }
+    if (!ExistenceCache::getInstance().isDormExist(reading.dormId)) {
+        err = "宿舍" + reading.dormId + "不存在";
+        return false;
+    }
+    return true;
+}
+
+std::vector<long long> MeterIngest::splitCents(long long cents, const std::vector<int>& weights) {
+    std::vector<long long> shares(weights.size(), 0);
+    long long totalWeight = 0;
+    for (int w : weights) totalWeight += w;
+    if (totalWeight <= 0 || cents <= 0) return shares;
+
+    //先按比例向下取整，剩余的分按余数从大到小补齐
+    std::vector<std::pair<long long, size_t>> remainders;
+    long long assigned = 0;
+    for (size_t i = 0; i < weights.size(); ++i) {
+        long long product = cents * weights[i];
+        shares[i] = product / totalWeight;
+        assigned += shares[i];
+        remainders.push_back(std::make_pair(product % totalWeight, i));
+    }
+    std::stable_sort(remainders.begin(), remainders.end(),
+        [](const std::pair<long long, size_t>& a, const std::pair<long long, size_t>& b) { return a.first > b.first; });
+    for (size_t i = 0; assigned < cents && i < remainders.size(); ++i, ++assigned) {
+        shares[remainders[i].second]++;
+    }
+    return shares;
+}
+
+void MeterIngest::processDorm(DormJob& job, const std::vector<Occupant>& occupants,
+    const MeterIngestParams& params) {
+    bool hasPrev = job.hasPrevious;
+    MeterReading prev = job.previous;
+
+    for (const auto& reading : job.readings) {
+        if (!hasPrev) {
+            job.baselineCount++;
+            job.accepted.push_back(reading);
+            hasPrev = true;
+            prev = reading;
+            continue;
+        }
+        double waterUsed = reading.waterM3 - prev.waterM3;
+        double kwhUsed = reading.kwh - prev.kwh;
+        if (waterUsed < 0.0 || kwhUsed < 0.0) {
+            job.errors.push_back("宿舍" + job.dormId + " " + reading.period + "：读数小于上期，已跳过");
+            continue;
+        }
+        prev = reading;
+        job.accepted.push_back(reading);
+
+        //按本月入住天数计算权重，月末之后入住的不分摊
+        int year = 0, month = 0;
+        Common::stringToInt(reading.period.substr(0, 4), year);
+        Common::stringToInt(reading.period.substr(5, 2), month);
+        int monthDays = daysOfMonth(year, month);
+        Date monthStart(year, month, 1);
+        Date monthEnd(year, month, monthDays);
+
+        std::vector<int> weights;
+        for (const auto& occupant : occupants) {
+            const Date& in = occupant.checkInDate;
+            if (monthEnd < in) weights.push_back(0);
+            else if (in < monthStart) weights.push_back(monthDays);
+            else weights.push_back(monthDays - in.day() + 1);
+        }
+
+        long long waterCents = std::llround(waterUsed * params.waterPrice * 100);
+        long long electricCents = std::llround(kwhUsed * params.electricPrice * 100);
+        std::vector<long long> waterShares = splitCents(waterCents, weights);
+        std::vector<long long> electricShares = splitCents(electricCents, weights);
+        for (size_t i = 0; i < occupants.size(); ++i) {
+            if (waterShares[i] == 0 && electricShares[i] == 0) continue;
+            job.fees.push_back(Fee("", occupants[i].studentId, job.dormId, reading.period,
+                waterShares[i] / 100.0, electricShares[i] / 100.0));
+        }
+    }
+}
+
+bool MeterIngest::ingestFile(const std::string& filePath, const MeterIngestParams& params) {
+    lastError.clear();
+    stats = MeterIngestStats();
+
+    std::ifstream file(filePath);
+    if (!file.is_open()) {
+        lastError = "无法打开读数文件：" + filePath;
+        return false;
+    }
+    if (!ensureTable()) return false;
+    //解析线程共用宿舍索引，先在主线程加载
+    if (!ExistenceCache::getInstance().isLoaded()) ExistenceCache::getInstance().rebuild();
+
+    int threadCount = params.threadCount > 0 ? params.threadCount
+        : static_cast<int>(std::thread::hardware_concurrency());
+
+    //1. 分批读取，每批多线程解析校验
+    std::vector<DormJob> jobs;
+    std::unordered_map<std::string, size_t> jobOfDorm;
+    std::vector<std::string> lines;
+    lines.reserve(METER_BATCH_LINES);
+    size_t lineNo = 0;
+    bool firstLine = true;
+    while (file) {
+        lines.clear();
+        std::string line;
+        while (lines.size() < METER_BATCH_LINES && std::getline(file, line)) {
+            if (firstLine) {
+                firstLine = false;
+                if (Common::startsWith(Common::toLower(Common::trim(line)), "dorm_id")) { ++lineNo; continue; }
+            }
+            lines.push_back(line);
+        }
+        if (lines.empty()) break;
+
+        std::vector<MeterReading> parsed(lines.size());
+        std::vector<std::string> errors(lines.size());
+        std::vector<char> valid(lines.size(), 0);
+        Common::parallelFor(lines.size(), threadCount, [&](size_t i) {
+            if (Common::trim(lines[i]).empty()) return;
+            valid[i] = parseLine(lines[i], parsed[i], errors[i]) ? 1 : 2;
+        });
+
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if (valid[i] == 0) continue;
+            if (valid[i] == 2) {
+                reject("第" + std::to_string(lineNo + i + 1) + "行：" + errors[i]);
+                continue;
+            }
+            auto it = jobOfDorm.find(parsed[i].dormId);
+            if (it == jobOfDorm.end()) {
+                it = jobOfDorm.emplace(parsed[i].dormId, jobs.size()).first;
+                jobs.push_back(DormJob());
+                jobs.back().dormId = parsed[i].dormId;
+            }
+            jobs[it->second].readings.push_back(parsed[i]);
+            stats.readingCount++;
+        }
+        lineNo += lines.size();
+    }
+
+    //同一宿舍同一月份出现多次时以最后一条为准
+    std::set<std::string> periods;
+    for (auto& job : jobs) {
+        std::stable_sort(job.readings.begin(), job.readings.end(),
+            [](const MeterReading& a, const MeterReading& b) { return a.period < b.period; });
+        std::vector<MeterReading> unique;
+        for (const auto& reading : job.readings) {
+            if (!unique.empty() && unique.back().period == reading.period) unique.back() = reading;
+            else unique.push_back(reading);
+        }
+        job.readings.swap(unique);
+        for (const auto& reading : job.readings) periods.insert(reading.period);
+    }
+
+    //2. 一次扫描取出各宿舍在本次首个月份之前的最近读数
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT dorm_id, period, water_m3, kwh FROM meter_reading",
+        [&](const DBRowView& row) {
+            auto it = jobOfDorm.find(row.getString(0));
+            if (it == jobOfDorm.end()) return;
+            DormJob& job = jobs[it->second];
+            std::string period = row.getString(1);
+            if (job.readings.empty() || !(period < job.readings.front().period)) return;
+            if (job.hasPrevious && !(job.previous.period < period)) return;
+            job.hasPrevious = true;
+            job.previous.dormId = job.dormId;
+            job.previous.period = period;
+            Common::stringToDouble(row.getString(2), job.previous.waterM3);
+            Common::stringToDouble(row.getString(3), job.previous.kwh);
+        });
+    if (rowCount < 0) {
+        lastError = "读取上期读数失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    //3. 一次扫描取出这些宿舍的当前住户
+    std::unordered_map<std::string, std::vector<Occupant>> occupantsOfDorm;
+    rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT student_id, dorm_id, check_in_date FROM student WHERE dorm_id IS NOT NULL ORDER BY student_id",
+        [&](const DBRowView& row) {
+            std::string dormId = row.getString(1);
+            if (jobOfDorm.count(dormId) == 0) return;
+            Occupant occupant;
+            occupant.studentId = row.getString(0);
+            occupant.checkInDate = row.getDate(2);
+            occupantsOfDorm[dormId].push_back(occupant);
+        });
+    if (rowCount < 0) {
+        lastError = "读取住户失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    //4. 多线程计算各宿舍用量和分摊
+    const std::vector<Occupant> noOccupants;
+    Common::parallelFor(jobs.size(), threadCount, [&](size_t i) {
+        auto it = occupantsOfDorm.find(jobs[i].dormId);
+        processDorm(jobs[i], it == occupantsOfDorm.end() ? noOccupants : it->second, params);
+    });
+
+    //5. 按月份集合去重，已出账的学生不再生成
+    FeeManager feeMgr;
+    std::map<std::string, std::unordered_set<std::string>> billedOfPeriod;
+    for (const auto& period : periods) {
+        if (!feeMgr.getBilledStudents(period, billedOfPeriod[period])) {
+            lastError = feeMgr.getLastError();
+            return false;
+        }
+    }
+
+    //6. 按宿舍分块，费用和读数在同一事务内写入
+    std::vector<Fee> chunkFees;
+    std::ostringstream readingSql;
+    size_t readingRows = 0;
+    auto flush = [&]() -> bool {
+        if (chunkFees.empty() && readingRows == 0) return true;
+        std::vector<std::string> extraSql;
+        if (readingRows > 0) {
+            extraSql.push_back(readingSql.str() +
+                " ON DUPLICATE KEY UPDATE water_m3 = VALUES(water_m3), kwh = VALUES(kwh)");
+        }
+        if (!feeMgr.addFeesBulk(chunkFees, extraSql)) {
+            lastError = feeMgr.getLastError();
+            return false;
+        }
+        stats.feeCount += static_cast<int>(chunkFees.size());
+        chunkFees.clear();
+        readingSql.str("");
+        readingRows = 0;
+        return true;
+    };
+
+    for (auto& job : jobs) {
+        for (const auto& err : job.errors) reject(err);
+        stats.baselineCount += job.baselineCount;
+
+        //有住户该月已出账时整条读数按冲突拒绝：不保存读数，也不生成该宿舍该月的其余费用，
+        //否则已出账住户的这部分用量会被新读数覆盖而无法再计费
+        std::set<std::string> conflictPeriods;
+        for (const auto& fee : job.fees) {
+            if (billedOfPeriod[fee.feeMonth].count(fee.studentId)) conflictPeriods.insert(fee.feeMonth);
+        }
+        for (const auto& period : conflictPeriods) {
+            stats.conflictCount++;
+            reject("宿舍" + job.dormId + " " + period + "：有住户该月已出账，读数未保存");
+        }
+        for (const auto& fee : job.fees) {
+            if (conflictPeriods.count(fee.feeMonth)) continue;
+            billedOfPeriod[fee.feeMonth].insert(fee.studentId);
+            chunkFees.push_back(fee);
+        }
+        for (const auto& reading : job.accepted) {
+            if (conflictPeriods.count(reading.period)) continue;
+            readingSql << (readingRows == 0 ? "INSERT INTO meter_reading (dorm_id, period, water_m3, kwh) VALUES " : ", ")
+                << std::fixed << std::setprecision(3)
+                << "('" << reading.dormId << "', '" << reading.period << "', "
+                << reading.waterM3 << ", " << reading.kwh << ")";
+            readingRows++;
+        }
+        if (chunkFees.size() >= METER_CHUNK_FEES || readingRows >= METER_CHUNK_FEES) {
+            if (!flush()) return false;
+        }
+    }
+    return flush();
+}
@@ -0,0 +1,96 @@
+#ifndef METERINGEST_H
+#define METERINGEST_H
+
+#include "FeeManager.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+// 一条宿舍表计读数
+struct MeterReading {
+    std::string dormId;  // 宿舍号
+    std::string period;  // 抄表月份（YYYY-MM）
+    double waterM3;      // 水表读数（立方米）
+    double kwh;          // 电表读数（千瓦时）
+
+    MeterReading() : waterM3(0.0), kwh(0.0) {}
+};
+
+// 抄表导入参数
+struct MeterIngestParams {
+    double waterPrice;    // 水价（元/立方米）
+    double electricPrice; // 电价（元/千瓦时）
+    int threadCount;      // 工作线程数，0表示按CPU核数
+
+    MeterIngestParams() : waterPrice(0.0), electricPrice(0.0), threadCount(0) {}
+};
+
+// 导入统计
+struct MeterIngestStats {
+    int readingCount;   // 读入的有效读数
+    int rejectedCount;  // 被拒绝的行（格式错误、宿舍不存在、读数倒退、住户已出账）
+    int conflictCount;  // 其中因住户该月已出账而未保存的读数
+    int baselineCount;  // 没有上期读数、只作为基准保存的读数
+    int feeCount;       // 生成的费用记录
+    std::vector<std::string> rejectedLines; // 被拒绝行的说明（最多保留100条）
+
+    MeterIngestStats() : readingCount(0), rejectedCount(0), conflictCount(0), baselineCount(0), feeCount(0) {}
+};
+
+// --------------- 宿舍抄表导入与费用分摊 ---------------
+// 分批读取CSV（dorm_id,period,water_m3,kwh），多线程解析和校验；
+// 与上期读数求差得到用量，按入住日期折算天数分摊给当前住户，批量生成Fee记录。
+class MeterIngest {
+public:
+    // 导入一个读数文件（返回true成功，统计见getStats）
+    bool ingestFile(const std::string& filePath, const MeterIngestParams& params);
+
+    // 获取导入统计
+    const MeterIngestStats& getStats() const { return stats; }
+
+    // 获取最近一次错误信息
+    std::string getLastError() const { return lastError; }
+
+private:
+    std::string lastError;
+    MeterIngestStats stats;
+
+    // 一名住户
+    struct Occupant {
+        std::string studentId;
+        Date checkInDate;
+    };
+
+    // 一间宿舍的计算任务
+    struct DormJob {
+        std::string dormId;
+        std::vector<MeterReading> readings; // 本次导入的读数（按月份排序）
+        bool hasPrevious;                   // 数据库中是否有上期读数
+        MeterReading previous;              // 上期读数
+        std::vector<MeterReading> accepted; // 通过校验、需要保存的读数
+        std::vector<Fee> fees;              // 计算结果
+        std::vector<std::string> errors;    // 读数倒退等错误
+        int baselineCount;
+
+        DormJob() : hasPrevious(false), baselineCount(0) {}
+    };
+
+    // 确保读数表存在
+    bool ensureTable();
+
+    // 解析一行CSV，失败返回false并写入err
+    static bool parseLine(const std::string& line, MeterReading& reading, std::string& err);
+
+    // 计算一间宿舍的费用
+    static void processDorm(DormJob& job, const std::vector<Occupant>& occupants,
+        const MeterIngestParams& params);
+
+    // 按天数加权把cents分给各住户（最大余数法）
+    static std::vector<long long> splitCents(long long cents, const std::vector<int>& weights);
+
+    // 记录被拒绝的行
+    void reject(const std::string& reason);
+};
+
+#endif // METERINGEST_H
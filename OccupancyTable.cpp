@@ -0,0 +1,105 @@
+#include "OccupancyTable.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include <vector>
+
+OccupancyTable& OccupancyTable::getInstance() {
+    static OccupancyTable instance;
+    return instance;
+}
+
+OccupancyTable::Counter* OccupancyTable::find(const std::string& dormId) {
+    std::lock_guard<std::mutex> lock(tableMutex);
+    auto it = counters.find(dormId);
+    if (it == counters.end()) return nullptr;
+    if (it->second->maxCapacity.load() < 0) return nullptr;
+    return it->second.get();
+}
+
+OccupancyAdjust OccupancyTable::tryAdjust(const std::string& dormId, int delta) {
+    Counter* counter = find(Common::trim(dormId));
+    if (counter == nullptr) return OccupancyAdjust::UNKNOWN;
+
+    //CAS循环：只有结果仍在合法范围内才写回
+    int current = counter->occupancy.load();
+    while (true) {
+        int maxCap = counter->maxCapacity.load();
+        if (maxCap < 0) return OccupancyAdjust::UNKNOWN;
+        int newCount = current + delta;
+        if (newCount < 0) return OccupancyAdjust::UNDERFLOW;
+        if (newCount > maxCap) return OccupancyAdjust::OVERFLOW;
+        if (counter->occupancy.compare_exchange_weak(current, newCount)) {
+            return OccupancyAdjust::OK;
+        }
+    }
+}
+
+void OccupancyTable::forceAdjust(const std::string& dormId, int delta) {
+    Counter* counter = find(Common::trim(dormId));
+    if (counter != nullptr) {
+        counter->occupancy.fetch_add(delta);
+    }
+}
+
+bool OccupancyTable::get(const std::string& dormId, int& occupancy, int& maxCapacity) {
+    Counter* counter = find(Common::trim(dormId));
+    if (counter == nullptr) return false;
+    maxCapacity = counter->maxCapacity.load();
+    occupancy = counter->occupancy.load();
+    return maxCapacity >= 0;
+}
+
+void OccupancyTable::set(const std::string& dormId, int occupancy, int maxCapacity) {
+    std::string trimmedId = Common::trim(dormId);
+    std::lock_guard<std::mutex> lock(tableMutex);
+    auto it = counters.find(trimmedId);
+    if (it == counters.end()) {
+        counters.emplace(trimmedId, std::unique_ptr<Counter>(new Counter(occupancy, maxCapacity)));
+    }
+    else {
+        it->second->occupancy.store(occupancy);
+        it->second->maxCapacity.store(maxCapacity);
+    }
+}
+
+void OccupancyTable::remove(const std::string& dormId) {
+    //只做删除标记，其他线程可能仍持有计数器指针
+    std::lock_guard<std::mutex> lock(tableMutex);
+    auto it = counters.find(Common::trim(dormId));
+    if (it != counters.end()) {
+        it->second->maxCapacity.store(-1);
+        it->second->occupancy.store(0);
+    }
+}
+
+bool OccupancyTable::ensureLoaded() {
+    if (loaded.load()) return true;
+    return rebuild();
+}
+
+bool OccupancyTable::rebuild() {
+    struct DormCount {
+        std::string dormId;
+        int occupancy;
+        int maxCapacity;
+    };
+    std::vector<DormCount> rows;
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT dorm_id, current_occupancy, max_capacity FROM dorm",
+        [&rows](const DBRowView& row) {
+            DormCount item;
+            item.dormId = row.getString(0);
+            item.occupancy = 0;
+            item.maxCapacity = 0;
+            Common::stringToInt(row.getString(1), item.occupancy);
+            Common::stringToInt(row.getString(2), item.maxCapacity);
+            rows.push_back(item);
+        });
+    if (rowCount < 0) return false;
+
+    for (const auto& item : rows) {
+        set(item.dormId, item.occupancy, item.maxCapacity);
+    }
+    loaded.store(true);
+    return true;
+}
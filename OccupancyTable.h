@@ -0,0 +1,67 @@
+#ifndef OCCUPANCYTABLE_H
+#define OCCUPANCYTABLE_H
+
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+
+// 入住人数调整结果
+enum class OccupancyAdjust {
+    OK = 0,        // 调整成功
+    UNDERFLOW = 1, // 调整后小于0
+    OVERFLOW = 2,  // 调整后超过最大容量
+    UNKNOWN = 3    // 表中没有该宿舍
+};
+
+// --------------- 宿舍入住人数原子计数表（单例）---------------
+// 数据库中的current_occupancy通过条件UPDATE原子修改，
+// 本表在进程内镜像该值，读取无需访问数据库；
+// 各宿舍计数器独立做CAS，不同宿舍的入住互不阻塞。
+class OccupancyTable {
+public:
+    static OccupancyTable& getInstance();
+
+    // 在[0, 最大容量]范围内原子调整入住人数，越界时不修改
+    OccupancyAdjust tryAdjust(const std::string& dormId, int delta);
+
+    // 无条件调整（数据库更新失败时撤销tryAdjust用）
+    void forceAdjust(const std::string& dormId, int delta);
+
+    // 读取入住人数和最大容量，表中没有该宿舍返回false
+    bool get(const std::string& dormId, int& occupancy, int& maxCapacity);
+
+    // 写入（或覆盖）某宿舍的计数
+    void set(const std::string& dormId, int occupancy, int maxCapacity);
+
+    // 删除宿舍时调用
+    void remove(const std::string& dormId);
+
+    // 首次使用时从数据库加载（返回true表示表可用）
+    bool ensureLoaded();
+
+    // 从数据库流式扫描重建
+    bool rebuild();
+
+private:
+    OccupancyTable() : loaded(false) {}
+    OccupancyTable(const OccupancyTable&) = delete;
+    OccupancyTable& operator=(const OccupancyTable&) = delete;
+
+    struct Counter {
+        std::atomic<int> occupancy;   // 当前入住人数
+        std::atomic<int> maxCapacity; // 最大容量（-1表示宿舍已删除）
+        Counter(int occ, int maxCap) : occupancy(occ), maxCapacity(maxCap) {}
+    };
+
+    // 计数器创建后不再释放，取得指针后可在锁外做CAS
+    std::mutex tableMutex;
+    std::unordered_map<std::string, std::unique_ptr<Counter>> counters;
+    std::atomic<bool> loaded;
+
+    // 查找计数器（不存在或已删除返回nullptr）
+    Counter* find(const std::string& dormId);
+};
+
+#endif // OCCUPANCYTABLE_H
@@ -0,0 +1,71 @@
+#include "PageCache.h"
+#include "ChangeFeed.h"
+
+std::atomic<uint64_t> PageCacheVersion::versions[static_cast<int>(PageScreen::COUNT)];
+
+void PageCacheVersion::invalidate(PageScreen screen) {
+    versions[static_cast<int>(screen)].fetch_add(1);
+}
+
+uint64_t PageCacheVersion::get(PageScreen screen) {
+    return versions[static_cast<int>(screen)].load();
+}
+
+void PageCacheVersion::subscribeChanges() {
+    static std::once_flag once;
+    std::call_once(once, []() {
+        ChangeFeed::getInstance().subscribe("分页缓存", ChangeDelivery::INLINE, [](const ChangeEvent& event) {
+            switch (event.table) {
+            case ChangeTable::STUDENT:
+                //学生变动影响宿舍界面的入住人数
+                invalidate(PageScreen::STUDENT);
+                invalidate(PageScreen::DORM);
+                break;
+            case ChangeTable::DORM: invalidate(PageScreen::DORM); break;
+            case ChangeTable::FEE: invalidate(PageScreen::FEE); break;
+            case ChangeTable::REPAIR: invalidate(PageScreen::REPAIR); break;
+            case ChangeTable::VISITOR: invalidate(PageScreen::VISITOR); break;
+            default: break;
+            }
+        });
+    });
+}
+
+PagePrefetcher& PagePrefetcher::getInstance() {
+    static PagePrefetcher instance;
+    return instance;
+}
+
+void PagePrefetcher::submit(std::function<void()> task) {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    if (stopped) return;
+    tasks.push_back(std::move(task));
+    if (!running) {
+        running = true;
+        worker = std::thread(&PagePrefetcher::run, this);
+    }
+    wakeup.notify_one();
+}
+
+void PagePrefetcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopped = true;
+        tasks.clear();
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void PagePrefetcher::run() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        wakeup.wait(lock, [this] { return stopped || !tasks.empty(); });
+        if (stopped) break;
+        std::function<void()> task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
@@ -0,0 +1,217 @@
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+
+#include "Common.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <deque>
+#include <tuple>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+// 分页缓存所属界面
+enum class PageScreen {
+    STUDENT = 0,
+    DORM,
+    FEE,
+    REPAIR,
+    VISITOR,
+    COUNT
+};
+
+// --------------- 各界面缓存版本号 ---------------
+// 写库成功后递增对应界面的版本号，旧版本的缓存页和总数全部视为失效。
+class PageCacheVersion {
+public:
+    static void invalidate(PageScreen screen);
+    static uint64_t get(PageScreen screen);
+
+    // 订阅数据变更，按变更的表使对应界面失效（启动时调用一次）
+    static void subscribeChanges();
+
+private:
+    static std::atomic<uint64_t> versions[static_cast<int>(PageScreen::COUNT)];
+};
+
+// --------------- 相邻页预取线程（单例）---------------
+// 单个后台线程依次执行预取任务。
+class PagePrefetcher {
+public:
+    static PagePrefetcher& getInstance();
+
+    // 提交预取任务（首次提交时启动线程）
+    void submit(std::function<void()> task);
+
+    // 停止线程，未执行的任务直接丢弃
+    void stop();
+
+private:
+    PagePrefetcher() : running(false), stopped(false) {}
+    PagePrefetcher(const PagePrefetcher&) = delete;
+    PagePrefetcher& operator=(const PagePrefetcher&) = delete;
+    ~PagePrefetcher() { stop(); }
+
+    std::mutex queueMutex;
+    std::condition_variable wakeup;
+    std::deque<std::function<void()>> tasks;
+    std::thread worker;
+    bool running;
+    bool stopped;
+
+    void run();
+};
+
+// --------------- 分页缓存 ---------------
+// 按(过滤条件, 页码, 每页条数)缓存一个界面的查询结果，容量满时淘汰最久未用的页；
+// 取当前页后把前后两页交给预取线程加载，翻页时直接命中。
+// 加载函数由调用方提供，会在预取线程中执行，因此不能使用界面线程的管理类对象。
+template <typename T>
+class PageCache {
+public:
+    typedef std::function<std::vector<T>(const PageParam&)> PageLoader;
+    typedef std::function<int()> CountLoader;
+
+    PageCache(PageScreen screen, PageLoader loadPage, CountLoader loadCount, size_t capacity = 16)
+        : screen(screen), loadPage(loadPage), loadCount(loadCount), capacity(capacity),
+          useClock(0), hitCount(0), missCount(0) {}
+
+    // 取一页：先确定总数并修正页码，再取当前页（未命中同步加载），最后预取相邻页
+    std::vector<T> getPage(const std::string& filter, PageParam& pageParam) {
+        uint64_t version = PageCacheVersion::get(screen);
+        pageParam.totalCount = getTotal(filter, version);
+        pageParam.calcTotalPage();
+
+        std::vector<T> rows;
+        if (lookup(filter, pageParam.pageIndex, pageParam.pageSize, version, rows)) {
+            hitCount++;
+        }
+        else {
+            missCount++;
+            rows = loadPage(pageParam);
+            store(filter, pageParam.pageIndex, pageParam.pageSize, version, rows);
+        }
+
+        if (pageParam.pageIndex < pageParam.totalPage) prefetch(filter, pageParam, pageParam.pageIndex + 1);
+        if (pageParam.pageIndex > 1) prefetch(filter, pageParam, pageParam.pageIndex - 1);
+        return rows;
+    }
+
+    PageScreen getScreen() const { return screen; }
+    size_t getHitCount() const { return hitCount.load(); }
+    size_t getMissCount() const { return missCount.load(); }
+
+private:
+    typedef std::tuple<std::string, int, int> Key;   // 过滤条件, 页码, 每页条数
+
+    struct Entry {
+        uint64_t version;
+        uint64_t lastUse;
+        std::vector<T> rows;
+    };
+
+    struct CountEntry {
+        uint64_t version;
+        int total;
+    };
+
+    PageScreen screen;
+    PageLoader loadPage;
+    CountLoader loadCount;
+    size_t capacity;
+
+    std::mutex cacheMutex;
+    std::map<Key, Entry> pages;
+    std::map<std::string, CountEntry> totals;
+    std::set<Key> inflight;                 // 已提交尚未完成的预取
+    uint64_t useClock;
+    std::atomic<size_t> hitCount;
+    std::atomic<size_t> missCount;
+
+    int getTotal(const std::string& filter, uint64_t version) {
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            auto it = totals.find(filter);
+            if (it != totals.end() && it->second.version == version) return it->second.total;
+        }
+        int total = loadCount();
+        if (total < 0) total = 0;
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (PageCacheVersion::get(screen) == version) {
+            CountEntry& entry = totals[filter];
+            entry.version = version;
+            entry.total = total;
+        }
+        return total;
+    }
+
+    bool lookup(const std::string& filter, int pageIndex, int pageSize, uint64_t version, std::vector<T>& rows) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = pages.find(Key(filter, pageIndex, pageSize));
+        if (it == pages.end()) return false;
+        if (it->second.version != version) {
+            pages.erase(it);
+            return false;
+        }
+        it->second.lastUse = ++useClock;
+        rows = it->second.rows;
+        return true;
+    }
+
+    bool contains(const Key& key, uint64_t version) {
+        auto it = pages.find(key);
+        return it != pages.end() && it->second.version == version;
+    }
+
+    // 加载期间版本号变化说明结果可能已过时，不写入
+    void store(const std::string& filter, int pageIndex, int pageSize, uint64_t version, const std::vector<T>& rows) {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        if (PageCacheVersion::get(screen) != version) return;
+
+        while (pages.size() >= capacity && !pages.empty()) {
+            auto oldest = pages.begin();
+            for (auto it = pages.begin(); it != pages.end(); ++it) {
+                if (it->second.version != version) { oldest = it; break; }
+                if (it->second.lastUse < oldest->second.lastUse) oldest = it;
+            }
+            pages.erase(oldest);
+        }
+        Entry& entry = pages[Key(filter, pageIndex, pageSize)];
+        entry.version = version;
+        entry.lastUse = ++useClock;
+        entry.rows = rows;
+    }
+
+    void prefetch(const std::string& filter, const PageParam& current, int pageIndex) {
+        uint64_t version = PageCacheVersion::get(screen);
+        Key key(filter, pageIndex, current.pageSize);
+        {
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            if (contains(key, version) || inflight.count(key) > 0) return;
+            inflight.insert(key);
+        }
+
+        PageParam target = current;
+        target.pageIndex = pageIndex;
+        PagePrefetcher::getInstance().submit([this, key, target, version]() {
+            bool needed;
+            {
+                std::lock_guard<std::mutex> lock(cacheMutex);
+                needed = PageCacheVersion::get(screen) == version && !contains(key, version);
+            }
+            if (needed) {
+                std::vector<T> rows = loadPage(target);
+                store(std::get<0>(key), target.pageIndex, target.pageSize, version, rows);
+            }
+            std::lock_guard<std::mutex> lock(cacheMutex);
+            inflight.erase(key);
+        });
+    }
+};
+
+#endif // PAGECACHE_H
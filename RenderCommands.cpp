@@ -0,0 +1,224 @@
+#include "RenderCommands.h"
+#include <chrono>
+#include <algorithm>
+
+//FNV-1a
+static uint64_t fnvMix(uint64_t h, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        h ^= (value >> (i * 8)) & 0xFF;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+uint64_t RenderList::hashCommand(const RenderCommand& command) {
+    uint64_t h = 0xcbf29ce484222325ull;
+    h = fnvMix(h, static_cast<uint64_t>(command.op));
+    h = fnvMix(h, (static_cast<uint64_t>(static_cast<uint32_t>(command.x1)) << 32) | static_cast<uint32_t>(command.y1));
+    h = fnvMix(h, (static_cast<uint64_t>(static_cast<uint32_t>(command.x2)) << 32) | static_cast<uint32_t>(command.y2));
+    h = fnvMix(h, (static_cast<uint64_t>(command.color) << 32) | command.fillColor);
+    h = fnvMix(h, (static_cast<uint64_t>(static_cast<uint32_t>(command.fontSize)) << 32) | static_cast<uint32_t>(command.imageId));
+    for (unsigned char c : command.text) {
+        h ^= c;
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+void RenderList::push(RenderCommand command) {
+    if (openRegion >= 0) {
+        RenderRegion& region = regions[openRegion];
+        region.hash = fnvMix(region.hash, hashCommand(command));
+    }
+    commands.push_back(std::move(command));
+}
+
+void RenderList::text(int x, int y, const std::string& str, uint32_t color, int fontSize) {
+    RenderCommand command;
+    command.op = RenderOp::TEXT;
+    command.x1 = x;
+    command.y1 = y;
+    command.color = color;
+    command.fontSize = fontSize;
+    command.text = str;
+    push(std::move(command));
+}
+
+void RenderList::rect(int left, int top, int right, int bottom, uint32_t color) {
+    RenderCommand command;
+    command.op = RenderOp::RECT;
+    command.x1 = left;
+    command.y1 = top;
+    command.x2 = right;
+    command.y2 = bottom;
+    command.color = color;
+    push(std::move(command));
+}
+
+void RenderList::fillRect(int left, int top, int right, int bottom, uint32_t color, uint32_t fillColor) {
+    RenderCommand command;
+    command.op = RenderOp::FILL_RECT;
+    command.x1 = left;
+    command.y1 = top;
+    command.x2 = right;
+    command.y2 = bottom;
+    command.color = color;
+    command.fillColor = fillColor;
+    push(std::move(command));
+}
+
+void RenderList::line(int x1, int y1, int x2, int y2, uint32_t color) {
+    RenderCommand command;
+    command.op = RenderOp::LINE;
+    command.x1 = x1;
+    command.y1 = y1;
+    command.x2 = x2;
+    command.y2 = y2;
+    command.color = color;
+    push(std::move(command));
+}
+
+void RenderList::blit(int imageId, int x, int y, int w, int h) {
+    RenderCommand command;
+    command.op = RenderOp::IMAGE;
+    command.x1 = x;
+    command.y1 = y;
+    command.x2 = w;
+    command.y2 = h;
+    command.imageId = imageId;
+    push(std::move(command));
+}
+
+void RenderList::beginRegion(int regionId, int x, int y, int w, int h) {
+    if (openRegion >= 0) endRegion();
+    RenderRegion& region = regions[regionId];
+    region.x = x;
+    region.y = y;
+    region.w = w;
+    region.h = h;
+    region.begin = commands.size();
+    region.end = commands.size();
+    region.hash = fnvMix(0xcbf29ce484222325ull, (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y));
+    openRegion = regionId;
+}
+
+void RenderList::endRegion() {
+    if (openRegion < 0) return;
+    regions[openRegion].end = commands.size();
+    openRegion = -1;
+}
+
+void RenderList::clear() {
+    commands.clear();
+    regions.clear();
+    openRegion = -1;
+}
+
+std::vector<int> RenderList::diffRegions(const RenderList& previous) const {
+    std::vector<int> changed;
+    auto it = regions.begin();
+    auto prevIt = previous.regions.begin();
+    //两边都按编号有序，归并比较
+    while (it != regions.end() || prevIt != previous.regions.end()) {
+        if (prevIt == previous.regions.end() || (it != regions.end() && it->first < prevIt->first)) {
+            changed.push_back(it->first);
+            ++it;
+        }
+        else if (it == regions.end() || prevIt->first < it->first) {
+            changed.push_back(prevIt->first);
+            ++prevIt;
+        }
+        else {
+            if (it->second.hash != prevIt->second.hash) changed.push_back(it->first);
+            ++it;
+            ++prevIt;
+        }
+    }
+    return changed;
+}
+
+void RenderBackend::submit(const RenderList& list) {
+    for (const RenderCommand& command : list.getCommands()) {
+        execute(command);
+    }
+}
+
+void RenderBackend::submitRegions(const RenderList& list, const RenderList& previous, const std::vector<int>& regionIds) {
+    const std::vector<RenderCommand>& commands = list.getCommands();
+    for (int id : regionIds) {
+        auto prevIt = previous.getRegions().find(id);
+        auto it = list.getRegions().find(id);
+
+        //用背景覆盖旧内容（两帧范围不同时都要覆盖）
+        RenderCommand clearCommand;
+        clearCommand.op = RenderOp::IMAGE;
+        clearCommand.imageId = RENDER_IMAGE_BACKGROUND;
+        if (prevIt != previous.getRegions().end()) {
+            const RenderRegion& region = prevIt->second;
+            clearCommand.x1 = region.x;
+            clearCommand.y1 = region.y;
+            clearCommand.x2 = region.w;
+            clearCommand.y2 = region.h;
+            execute(clearCommand);
+        }
+        if (it == list.getRegions().end()) continue;
+        const RenderRegion& region = it->second;
+        if (prevIt == previous.getRegions().end() || prevIt->second.x != region.x || prevIt->second.y != region.y
+            || prevIt->second.w != region.w || prevIt->second.h != region.h) {
+            clearCommand.x1 = region.x;
+            clearCommand.y1 = region.y;
+            clearCommand.x2 = region.w;
+            clearCommand.y2 = region.h;
+            execute(clearCommand);
+        }
+
+        for (size_t i = region.begin; i < region.end; ++i) {
+            execute(commands[i]);
+        }
+    }
+}
+
+void HeadlessBackend::execute(const RenderCommand& command) {
+    counts[static_cast<int>(command.op)]++;
+    if (command.op == RenderOp::TEXT) textBytes += command.text.size();
+    if (command.op == RenderOp::IMAGE) blitArea += static_cast<uint64_t>(std::max(0, command.x2)) * std::max(0, command.y2);
+}
+
+void HeadlessBackend::reset() {
+    for (size_t& count : counts) count = 0;
+    textBytes = 0;
+    blitArea = 0;
+}
+
+size_t HeadlessBackend::getTotalCount() const {
+    size_t total = 0;
+    for (size_t count : counts) total += count;
+    return total;
+}
+
+RenderBenchResult benchmarkRender(const std::function<void(RenderList&)>& build, int iterations) {
+    RenderBenchResult result;
+    if (iterations <= 0) return result;
+    result.iterations = iterations;
+
+    typedef std::chrono::steady_clock Clock;
+    RenderList list;
+    HeadlessBackend backend;
+    Clock::duration buildTime(0), submitTime(0);
+    for (int i = 0; i < iterations; ++i) {
+        list.clear();
+        Clock::time_point start = Clock::now();
+        build(list);
+        Clock::time_point built = Clock::now();
+        backend.submit(list);
+        Clock::time_point submitted = Clock::now();
+        buildTime += built - start;
+        submitTime += submitted - built;
+    }
+
+    result.buildMicros = std::chrono::duration<double, std::micro>(buildTime).count() / iterations;
+    result.submitMicros = std::chrono::duration<double, std::micro>(submitTime).count() / iterations;
+    result.commandCount = list.getCommands().size();
+    result.regionCount = list.getRegions().size();
+    return result;
+}
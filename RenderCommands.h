@@ -0,0 +1,127 @@
+#ifndef RENDERCOMMANDS_H
+#define RENDERCOMMANDS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstdint>
+
+// 绘制命令类型
+enum class RenderOp {
+    TEXT = 0,     // 文字
+    RECT,         // 矩形边框
+    FILL_RECT,    // 填充矩形（带边框）
+    LINE,         // 直线
+    IMAGE,        // 图片区域贴图
+    COUNT
+};
+
+// 贴图使用的图片编号
+const int RENDER_IMAGE_BACKGROUND = 0;
+
+// 一条绘制命令（颜色为0x00BBGGRR，与EasyX的COLORREF一致）
+struct RenderCommand {
+    RenderOp op;
+    int x1, y1, x2, y2;      // TEXT/IMAGE只用(x1,y1)和宽高(x2,y2)；RECT/LINE为两个端点
+    uint32_t color;          // 文字/线条颜色
+    uint32_t fillColor;      // FILL_RECT填充色
+    int fontSize;            // TEXT字号
+    int imageId;             // IMAGE图片编号
+    std::string text;
+
+    RenderCommand() : op(RenderOp::TEXT), x1(0), y1(0), x2(0), y2(0), color(0), fillColor(0), fontSize(0), imageId(0) {}
+};
+
+// 命令列表中的一个区域（如表格的一行），按区域比较前后两帧
+struct RenderRegion {
+    int x, y, w, h;          // 区域范围，局部重绘时先用背景覆盖
+    size_t begin, end;       // 命令下标区间[begin, end)
+    uint64_t hash;           // 区域内命令的哈希
+
+    RenderRegion() : x(0), y(0), w(0), h(0), begin(0), end(0), hash(0) {}
+};
+
+// --------------- 保留模式绘制命令列表 ---------------
+// 界面代码只生成命令，由后端执行；命令可按区域分组，用于前后两帧比较后只重绘变化的区域。
+class RenderList {
+public:
+    RenderList() : openRegion(-1) {}
+
+    void text(int x, int y, const std::string& str, uint32_t color, int fontSize);
+    void rect(int left, int top, int right, int bottom, uint32_t color);
+    void fillRect(int left, int top, int right, int bottom, uint32_t color, uint32_t fillColor);
+    void line(int x1, int y1, int x2, int y2, uint32_t color);
+    void blit(int imageId, int x, int y, int w, int h);
+
+    // 开始/结束一个区域（区域不能嵌套，编号在一帧内唯一）
+    void beginRegion(int regionId, int x, int y, int w, int h);
+    void endRegion();
+
+    void clear();
+
+    const std::vector<RenderCommand>& getCommands() const { return commands; }
+    const std::map<int, RenderRegion>& getRegions() const { return regions; }
+
+    // 与上一帧比较，返回内容变化、新增或消失的区域编号
+    std::vector<int> diffRegions(const RenderList& previous) const;
+
+private:
+    std::vector<RenderCommand> commands;
+    std::map<int, RenderRegion> regions;
+    int openRegion;
+
+    void push(RenderCommand command);
+    static uint64_t hashCommand(const RenderCommand& command);
+};
+
+// --------------- 绘制后端接口 ---------------
+class RenderBackend {
+public:
+    virtual ~RenderBackend() {}
+
+    // 执行单条命令
+    virtual void execute(const RenderCommand& command) = 0;
+
+    // 执行整个列表
+    void submit(const RenderList& list);
+
+    // 只重绘指定区域：先用背景覆盖上一帧该区域的范围，再执行本帧该区域的命令
+    void submitRegions(const RenderList& list, const RenderList& previous, const std::vector<int>& regionIds);
+};
+
+// --------------- 无界面后端（用于测试和性能测量）---------------
+// 不实际绘制，只统计各类命令的条数、文字字节数和贴图面积。
+class HeadlessBackend : public RenderBackend {
+public:
+    HeadlessBackend() { reset(); }
+
+    void execute(const RenderCommand& command) override;
+
+    void reset();
+    size_t getCount(RenderOp op) const { return counts[static_cast<int>(op)]; }
+    size_t getTotalCount() const;
+    size_t getTextBytes() const { return textBytes; }
+    uint64_t getBlitArea() const { return blitArea; }
+
+private:
+    size_t counts[static_cast<int>(RenderOp::COUNT)];
+    size_t textBytes;
+    uint64_t blitArea;
+};
+
+// 一次性能测量的结果
+struct RenderBenchResult {
+    int iterations;
+    double buildMicros;      // 每帧生成命令的平均耗时（微秒）
+    double submitMicros;     // 每帧无界面后端执行的平均耗时（微秒）
+    size_t commandCount;     // 每帧命令数
+    size_t regionCount;      // 每帧区域数
+
+    RenderBenchResult() : iterations(0), buildMicros(0), submitMicros(0), commandCount(0), regionCount(0) {}
+};
+
+// 重复生成并执行iterations帧，测量平均耗时
+RenderBenchResult benchmarkRender(const std::function<void(RenderList&)>& build, int iterations);
+
+#endif // RENDERCOMMANDS_H
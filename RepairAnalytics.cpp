@@ -0,0 +1,199 @@
+#include "RepairAnalytics.h"
+#include "DBHelper.h"
+#include "ExistenceCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+//逐天计数的上限
+static const int EXACT_DAYS = 64;
+
+int TurnaroundSketch::bucketOf(int days) {
+    if (days < EXACT_DAYS) return days;
+    //最高位所在幂次（>=6），再取其后3位作为段内桶号
+    int exp = 6;
+    while ((days >> (exp + 1)) != 0) ++exp;
+    int sub = (days >> (exp - 3)) & 7;
+    return EXACT_DAYS + (exp - 6) * 8 + sub;
+}
+
+int TurnaroundSketch::bucketUpper(int index) {
+    if (index < EXACT_DAYS) return index;
+    int exp = (index - EXACT_DAYS) / 8 + 6;
+    int sub = (index - EXACT_DAYS) % 8;
+    return ((9 + sub) << (exp - 3)) - 1;
+}
+
+void TurnaroundSketch::add(int days) {
+    if (days < 0) days = 0;
+    size_t index = static_cast<size_t>(bucketOf(days));
+    if (buckets.size() <= index) buckets.resize(index + 1, 0);
+    buckets[index]++;
+    count++;
+    sumDays += days;
+}
+
+void TurnaroundSketch::merge(const TurnaroundSketch& other) {
+    if (buckets.size() < other.buckets.size()) buckets.resize(other.buckets.size(), 0);
+    for (size_t i = 0; i < other.buckets.size(); ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sumDays += other.sumDays;
+}
+
+int TurnaroundSketch::quantile(double q) const {
+    if (count == 0) return 0;
+    //第ceil(q*count)个值所在的桶
+    int64_t rank = static_cast<int64_t>(std::ceil(q * count));
+    if (rank < 1) rank = 1;
+    int64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) return bucketUpper(static_cast<int>(i));
+    }
+    return bucketUpper(static_cast<int>(buckets.size()) - 1);
+}
+
+RepairAnalytics& RepairAnalytics::getInstance() {
+    static RepairAnalytics instance;
+    return instance;
+}
+
+std::string RepairAnalytics::getLastError() {
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    return lastError;
+}
+
+std::string RepairAnalytics::monthOf(const Date& date) {
+    //取YYYY-MM-DD的前7位
+    char buf[10];
+    date.format(buf);
+    return std::string(buf, 7);
+}
+
+TurnaroundStats RepairAnalytics::toStats(const TurnaroundSketch& sketch) {
+    TurnaroundStats stats;
+    stats.count = sketch.getCount();
+    if (stats.count > 0) {
+        stats.meanDays = static_cast<double>(sketch.getSumDays()) / stats.count;
+        stats.p50Days = sketch.quantile(0.5);
+        stats.p90Days = sketch.quantile(0.9);
+    }
+    return stats;
+}
+
+int RepairAnalytics::commitCompletion(const std::string& dormId, const Date& repairDate, const Date& handleDate,
+    const std::function<int()>& commit) {
+    //楼栋在加锁前查好
+    std::string building = ExistenceCache::getInstance().getBuildingOfDorm(Common::trim(dormId));
+    int days = Common::dateToDays(handleDate) - Common::dateToDays(repairDate);
+
+    //提交与计入同在锁内，重建要么已扫到这条记录，要么在其后才开始，不会重复计数
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    int affectedRows = commit();
+    if (affectedRows > 0 && loaded) sketches[monthOf(handleDate)][building].add(days);
+    return affectedRows;
+}
+
+TurnaroundStats RepairAnalytics::getStats(const std::string& month, const std::string& building) {
+    if (!ensureLoaded()) return TurnaroundStats();
+    std::string trimmedMonth = Common::trim(month);
+    std::string trimmedBuilding = Common::trim(building);
+
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    TurnaroundSketch merged;
+    for (const auto& monthItem : sketches) {
+        if (!trimmedMonth.empty() && monthItem.first != trimmedMonth) continue;
+        for (const auto& buildingItem : monthItem.second) {
+            if (!trimmedBuilding.empty() && buildingItem.first != trimmedBuilding) continue;
+            merged.merge(buildingItem.second);
+        }
+    }
+    return toStats(merged);
+}
+
+std::map<std::string, TurnaroundStats> RepairAnalytics::getBuildingStats(const std::string& month) {
+    std::map<std::string, TurnaroundStats> result;
+    if (!ensureLoaded()) return result;
+
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    auto monthIt = sketches.find(Common::trim(month));
+    if (monthIt == sketches.end()) return result;
+    for (const auto& buildingItem : monthIt->second) {
+        result[buildingItem.first] = toStats(buildingItem.second);
+    }
+    return result;
+}
+
+std::map<std::string, TurnaroundStats> RepairAnalytics::getMonthlyStats(const std::string& building) {
+    std::map<std::string, TurnaroundStats> result;
+    if (!ensureLoaded()) return result;
+    std::string trimmedBuilding = Common::trim(building);
+
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+    for (const auto& monthItem : sketches) {
+        TurnaroundSketch merged;
+        for (const auto& buildingItem : monthItem.second) {
+            if (!trimmedBuilding.empty() && buildingItem.first != trimmedBuilding) continue;
+            merged.merge(buildingItem.second);
+        }
+        if (merged.getCount() > 0) result[monthItem.first] = toStats(merged);
+    }
+    return result;
+}
+
+bool RepairAnalytics::ensureLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(analyticsMutex);
+        if (loaded) return true;
+    }
+    return rebuild();
+}
+
+bool RepairAnalytics::rebuild(int threadCount) {
+    std::lock_guard<std::mutex> lock(analyticsMutex);
+
+    //1. 一次联表扫描取出已完成报修（日期直接解码为天数）
+    struct RepairRow {
+        std::string building;
+        Date repairDate;
+        Date handleDate;
+    };
+    std::vector<RepairRow> rows;
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT IFNULL(d.building, ''), r.repair_date, r.handle_date "
+        "FROM repair r LEFT JOIN dorm d ON d.dorm_id = r.dorm_id "
+        "WHERE r.handle_status = 2 AND r.handle_date IS NOT NULL",
+        [&rows](const DBRowView& row) {
+            RepairRow item;
+            item.building = row.getString(0);
+            item.repairDate = row.getDate(1);
+            item.handleDate = row.getDate(2);
+            rows.push_back(item);
+        });
+    if (rowCount < 0) {
+        lastError = "读取报修记录失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    //2. 扫描是单条串行流，仅内存聚合按行区间分片并行，再合并
+    SketchMap rebuilt = Common::parallelAggregate<SketchMap>(rows.size(), threadCount,
+        [&rows](SketchMap& part, size_t i) {
+            const RepairRow& item = rows[i];
+            if (item.repairDate.isEmpty() || item.handleDate.isEmpty()) return;
+            int days = Common::dateToDays(item.handleDate) - Common::dateToDays(item.repairDate);
+            part[monthOf(item.handleDate)][item.building].add(days);
+        },
+        [](SketchMap& into, const SketchMap& from) {
+            for (const auto& monthItem : from) {
+                for (const auto& buildingItem : monthItem.second) {
+                    into[monthItem.first][buildingItem.first].merge(buildingItem.second);
+                }
+            }
+        });
+
+    sketches.swap(rebuilt);
+    loaded = true;
+    return true;
+}
@@ -0,0 +1,100 @@
+#ifndef REPAIRANALYTICS_H
+#define REPAIRANALYTICS_H
+
+#include "Common.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+// 报修处理时长统计结果（单位：天）
+struct TurnaroundStats {
+    int64_t count;     // 已完成报修数
+    double meanDays;   // 平均处理时长
+    int p50Days;       // 中位数
+    int p90Days;       // 90分位
+
+    TurnaroundStats() : count(0), meanDays(0), p50Days(0), p90Days(0) {}
+};
+
+// --------------- 处理时长分位数草图 ---------------
+// 0~63天逐天计数，更长的时长按2的幂分段、每段8个桶，相对误差不超过1/8；
+// 两个草图可直接相加合并。
+class TurnaroundSketch {
+public:
+    TurnaroundSketch() : count(0), sumDays(0) {}
+
+    // 记录一次处理时长（负数按0计）
+    void add(int days);
+
+    // 合并另一个草图
+    void merge(const TurnaroundSketch& other);
+
+    // 分位数（q取0~1），无数据返回0
+    int quantile(double q) const;
+
+    int64_t getCount() const { return count; }
+    int64_t getSumDays() const { return sumDays; }
+
+private:
+    int64_t count;
+    int64_t sumDays;
+    std::vector<uint32_t> buckets;
+
+    static int bucketOf(int days);
+    static int bucketUpper(int index);   // 桶内最大天数
+};
+
+// --------------- 报修处理时长分析（单例）---------------
+// 按完成月份和楼栋维护处理时长草图，updateHandleStatus置为已完成时增量更新，
+// 历史数据可通过多线程扫描回填；查询时只合并草图，不访问数据库。
+class RepairAnalytics {
+public:
+    static RepairAnalytics& getInstance();
+
+    // 在锁内执行commit（把报修标记为完成），成功后计入统计（完成日期为handleDate）
+    // 返回commit的结果
+    int commitCompletion(const std::string& dormId, const Date& repairDate, const Date& handleDate,
+        const std::function<int()>& commit);
+
+    // 指定月份（YYYY-MM）和楼栋的统计，为空表示不限
+    TurnaroundStats getStats(const std::string& month = "", const std::string& building = "");
+
+    // 某月各楼栋的统计
+    std::map<std::string, TurnaroundStats> getBuildingStats(const std::string& month);
+
+    // 某楼栋各月的统计（building为空表示全部楼栋）
+    std::map<std::string, TurnaroundStats> getMonthlyStats(const std::string& building = "");
+
+    // 首次使用时加载
+    bool ensureLoaded();
+
+    // 是否已加载（不等待正在进行的加载，界面据此显示加载状态）
+    bool isLoaded() const { return loaded.load(); }
+
+    // 从repair表回填（threadCount<=0时按CPU核数）
+    bool rebuild(int threadCount = 0);
+
+    std::string getLastError();
+
+private:
+    RepairAnalytics() : loaded(false) {}
+    RepairAnalytics(const RepairAnalytics&) = delete;
+    RepairAnalytics& operator=(const RepairAnalytics&) = delete;
+
+    // 月份 → 楼栋 → 草图
+    typedef std::map<std::string, std::map<std::string, TurnaroundSketch>> SketchMap;
+
+    std::mutex analyticsMutex;
+    SketchMap sketches;
+    std::atomic<bool> loaded;   // 加载期间持有analyticsMutex，标志单独可读
+    std::string lastError;
+
+    static TurnaroundStats toStats(const TurnaroundSketch& sketch);
+    static std::string monthOf(const Date& date);
+};
+
+#endif // REPAIRANALYTICS_H
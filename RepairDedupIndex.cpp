@@ -0,0 +1,225 @@
+#include "RepairDedupIndex.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include "Transcode.h"
+#include "ChangeFeed.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cctype>
+
+//64位混合函数（splitmix64）
+static uint64_t mix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+RepairDedupIndex& RepairDedupIndex::getInstance() {
+    static RepairDedupIndex instance;
+    return instance;
+}
+
+std::vector<uint64_t> RepairDedupIndex::shingle(const std::string& content) {
+    //1. 按GBK切分字符并查表解码为Unicode码点（签名与存储编码无关）
+    std::vector<uint32_t> chars;
+    chars.reserve(content.size());
+    size_t pos = 0;
+    while (pos < content.size()) {
+        unsigned char c1 = static_cast<unsigned char>(content[pos]);
+        uint32_t code = Transcode::decodeGbkChar(content.data(), content.size(), pos);
+        if (c1 >= 0x80) {
+            //A1~A9区为全角标点和符号
+            if (code == 0 || (c1 >= 0xA1 && c1 <= 0xA9)) continue;
+            chars.push_back(code);
+        }
+        else if (std::isalnum(c1)) {
+            chars.push_back(static_cast<uint32_t>(std::tolower(c1)));
+        }
+    }
+
+    //2. 相邻字符二元组（只有一个字符时取单字）
+    std::vector<uint64_t> shingles;
+    if (chars.size() == 1) {
+        shingles.push_back(mix64(chars[0]));
+    }
+    for (size_t i = 0; i + 1 < chars.size(); ++i) {
+        shingles.push_back(mix64((static_cast<uint64_t>(chars[i]) << 32) | chars[i + 1]));
+    }
+    std::sort(shingles.begin(), shingles.end());
+    shingles.erase(std::unique(shingles.begin(), shingles.end()), shingles.end());
+    return shingles;
+}
+
+RepairDedupIndex::Signature RepairDedupIndex::minHash(const std::vector<uint64_t>& shingles) {
+    Signature signature;
+    signature.fill(UINT32_MAX);
+    for (uint64_t value : shingles) {
+        for (int i = 0; i < MINHASH_SIZE; ++i) {
+            uint32_t h = static_cast<uint32_t>(mix64(value ^ (0x5bd1e995ull * (i + 1))));
+            if (h < signature[i]) signature[i] = h;
+        }
+    }
+    return signature;
+}
+
+uint64_t RepairDedupIndex::bandKey(const Signature& signature, int band) {
+    uint64_t h = static_cast<uint64_t>(band);
+    for (int r = 0; r < LSH_ROWS; ++r) {
+        h = mix64(h ^ signature[band * LSH_ROWS + r]);
+    }
+    return h;
+}
+
+double RepairDedupIndex::overlap(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+    //较短的描述被较长的描述包含也算重复，如"灯坏了"和"宿舍的灯坏了"
+    size_t common = 0;
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] == b[j]) { ++common; ++i; ++j; }
+        else if (a[i] < b[j]) ++i;
+        else ++j;
+    }
+    if (common < DUPLICATE_MIN_COMMON && common < std::min(a.size(), b.size())) return 0;
+    return static_cast<double>(common) / std::min(a.size(), b.size());
+}
+
+void RepairDedupIndex::insertLocked(Entry entry) {
+    DormBucket& bucket = dorms[entry.dormId];
+    for (int band = 0; band < LSH_BANDS; ++band) {
+        bucket.bands[bandKey(entry.signature, band)].push_back(entry.repairId);
+    }
+    int64_t id = entry.repairId;
+    entries[id] = std::move(entry);
+}
+
+void RepairDedupIndex::eraseLocked(int64_t repairId) {
+    auto it = entries.find(repairId);
+    if (it == entries.end()) return;
+
+    auto dormIt = dorms.find(it->second.dormId);
+    if (dormIt != dorms.end()) {
+        for (int band = 0; band < LSH_BANDS; ++band) {
+            auto bandIt = dormIt->second.bands.find(bandKey(it->second.signature, band));
+            if (bandIt == dormIt->second.bands.end()) continue;
+            std::vector<int64_t>& ids = bandIt->second;
+            ids.erase(std::remove(ids.begin(), ids.end(), repairId), ids.end());
+            if (ids.empty()) dormIt->second.bands.erase(bandIt);
+        }
+        if (dormIt->second.bands.empty()) dorms.erase(dormIt);
+    }
+    entries.erase(it);
+}
+
+bool RepairDedupIndex::findDuplicate(const std::string& dormId, const std::string& content, DuplicateMatch& match) {
+    if (!ensureLoaded()) return false;
+
+    //签名在加锁前算好
+    std::vector<uint64_t> shingles = shingle(Common::trim(content));
+    if (shingles.empty()) return false;
+    Signature signature = minHash(shingles);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    auto dormIt = dorms.find(Common::trim(dormId));
+    if (dormIt == dorms.end()) return false;
+
+    std::vector<int64_t> candidates;
+    for (int band = 0; band < LSH_BANDS; ++band) {
+        auto bandIt = dormIt->second.bands.find(bandKey(signature, band));
+        if (bandIt == dormIt->second.bands.end()) continue;
+        candidates.insert(candidates.end(), bandIt->second.begin(), bandIt->second.end());
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    //候选再精确计算重合度，取最相似的一条
+    bool found = false;
+    for (int64_t id : candidates) {
+        const Entry& entry = entries[id];
+        double similarity = overlap(shingles, entry.shingles);
+        if (similarity >= DUPLICATE_THRESHOLD && similarity > match.similarity) {
+            match.repairId = std::to_string(id);
+            match.content = entry.content;
+            match.similarity = similarity;
+            found = true;
+        }
+    }
+    return found;
+}
+
+void RepairDedupIndex::add(const std::string& repairId, const std::string& dormId, const std::string& content) {
+    Entry entry;
+    entry.repairId = std::strtoll(Common::trim(repairId).c_str(), nullptr, 10);
+    entry.dormId = Common::trim(dormId);
+    entry.content = Common::trim(content);
+    entry.shingles = shingle(entry.content);
+    entry.signature = minHash(entry.shingles);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    eraseLocked(entry.repairId);
+    insertLocked(std::move(entry));
+}
+
+void RepairDedupIndex::remove(const std::string& repairId) {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    eraseLocked(std::strtoll(Common::trim(repairId).c_str(), nullptr, 10));
+}
+
+void RepairDedupIndex::subscribeChanges() {
+    static std::once_flag once;
+    std::call_once(once, [this]() {
+        //查重允许滞后几毫秒，分词和签名计算放到后台线程
+        ChangeFeed::getInstance().subscribe("报修查重索引", ChangeDelivery::BACKGROUND, [this](const ChangeEvent& event) {
+            if (event.table != ChangeTable::REPAIR) return;
+            if (event.kind == ChangeKind::REMOVE) {
+                remove(event.key);
+                return;
+            }
+            static const std::string completed = std::to_string(static_cast<int>(RepairStatus::COMPLETED));
+            if (event.value("handle_status") == completed) {
+                if (event.isChanged("handle_status")) remove(event.key);
+                return;
+            }
+            if (event.kind == ChangeKind::INSERT || event.isChanged("dorm_id") || event.isChanged("repair_content")) {
+                add(event.key, event.value("dorm_id"), event.value("repair_content"));
+            }
+        });
+    });
+}
+
+bool RepairDedupIndex::ensureLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (loaded) return true;
+    }
+    return rebuild();
+}
+
+bool RepairDedupIndex::rebuild() {
+    std::lock_guard<std::mutex> lock(indexMutex);
+
+    std::vector<Entry> rows;
+    int64_t rowCount = DBHelper::getInstance().executeQueryStream(
+        "SELECT repair_id, dorm_id, repair_content FROM repair WHERE handle_status != 2",
+        [&rows](const DBRowView& row) {
+            Entry entry;
+            entry.repairId = std::strtoll(row.getString(0).c_str(), nullptr, 10);
+            entry.dormId = row.getString(1);
+            entry.content = row.getString(2);
+            rows.push_back(std::move(entry));
+        });
+    if (rowCount < 0) return false;
+
+    entries.clear();
+    dorms.clear();
+    entries.reserve(rows.size() * 2);
+    for (Entry& entry : rows) {
+        entry.shingles = shingle(entry.content);
+        entry.signature = minHash(entry.shingles);
+        insertLocked(std::move(entry));
+    }
+    loaded = true;
+    return true;
+}
@@ -0,0 +1,91 @@
+#ifndef REPAIRDEDUPINDEX_H
+#define REPAIRDEDUPINDEX_H
+
+#include <string>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+// MinHash签名长度，分为LSH_BANDS段、每段LSH_ROWS个值
+constexpr int MINHASH_SIZE = 32;
+constexpr int LSH_BANDS = 16;
+constexpr int LSH_ROWS = MINHASH_SIZE / LSH_BANDS;
+
+// 重合度达到此值且至少有DUPLICATE_MIN_COMMON个相同二元组视为重复报修
+constexpr double DUPLICATE_THRESHOLD = 0.7;
+constexpr size_t DUPLICATE_MIN_COMMON = 2;
+
+// 疑似重复的报修
+struct DuplicateMatch {
+    std::string repairId;     // 已有报修ID
+    std::string content;      // 已有报修内容
+    double similarity;        // 相同二元组占较短一方的比例
+
+    DuplicateMatch() : similarity(0) {}
+};
+
+// --------------- 重复报修检测索引（单例）---------------
+// 报修内容按GBK字符切分并解码为Unicode码点（双字节汉字不被拆开，符号区字符和ASCII标点忽略），
+// 取相邻字符二元组计算MinHash签名，并按宿舍分桶做LSH；
+// 新报修只与同宿舍、至少一段签名相同的未完成报修比较，再精确计算重合度确认。
+class RepairDedupIndex {
+public:
+    static RepairDedupIndex& getInstance();
+
+    // 查找同宿舍未完成报修中最相似的一条，相似度不低于阈值返回true
+    bool findDuplicate(const std::string& dormId, const std::string& content, DuplicateMatch& match);
+
+    // 未完成报修的增删
+    void add(const std::string& repairId, const std::string& dormId, const std::string& content);
+    void remove(const std::string& repairId);
+
+    // 订阅报修的数据变更，由后台线程调用add/remove（启动时调用一次）
+    void subscribeChanges();
+
+    // 首次使用时加载
+    bool ensureLoaded();
+
+    // 从repair表重建
+    bool rebuild();
+
+    // 把报修内容切分为字符二元组哈希（已排序去重）
+    static std::vector<uint64_t> shingle(const std::string& content);
+
+private:
+    RepairDedupIndex() : loaded(false) {}
+    RepairDedupIndex(const RepairDedupIndex&) = delete;
+    RepairDedupIndex& operator=(const RepairDedupIndex&) = delete;
+
+    typedef std::array<uint32_t, MINHASH_SIZE> Signature;
+
+    // 一条未完成报修
+    struct Entry {
+        int64_t repairId;
+        std::string dormId;
+        std::string content;
+        std::vector<uint64_t> shingles;
+        Signature signature;
+    };
+
+    // 一个宿舍的LSH分桶
+    struct DormBucket {
+        std::unordered_map<uint64_t, std::vector<int64_t>> bands;   // 段号+段哈希 → 报修ID
+    };
+
+    std::mutex indexMutex;
+    std::unordered_map<int64_t, Entry> entries;
+    std::unordered_map<std::string, DormBucket> dorms;
+    bool loaded;
+
+    static Signature minHash(const std::vector<uint64_t>& shingles);
+    static uint64_t bandKey(const Signature& signature, int band);
+    static double overlap(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b);
+
+    // 以下需持有indexMutex
+    void insertLocked(Entry entry);
+    void eraseLocked(int64_t repairId);
+};
+
+#endif // REPAIRDEDUPINDEX_H
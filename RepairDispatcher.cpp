@@ -0,0 +1,247 @@
+#include "RepairDispatcher.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include "ExistenceCache.h"
+#include <algorithm>
+#include <cstdlib>
+
+//各紧急程度的处理时限（天）
+static const int SLA_DAYS[] = { 1, 3, 7 };
+
+RepairDispatcher& RepairDispatcher::getInstance() {
+    static RepairDispatcher instance;
+    return instance;
+}
+
+std::string RepairDispatcher::getLastError() {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    return lastError;
+}
+
+void RepairDispatcher::setError(const std::string& message) {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    lastError = message;
+}
+
+RepairUrgency RepairDispatcher::classify(const std::string& content) {
+    static const char* urgentWords[] = { "漏水", "跑水", "断电", "停电", "漏电", "着火", "冒烟", "燃气", "门锁", "门坏" };
+    static const char* normalWords[] = { "灯", "空调", "热水", "马桶", "堵", "网络", "插座", "窗" };
+    for (const char* word : urgentWords) {
+        if (content.find(word) != std::string::npos) return RepairUrgency::URGENT;
+    }
+    for (const char* word : normalWords) {
+        if (content.find(word) != std::string::npos) return RepairUrgency::NORMAL;
+    }
+    return RepairUrgency::LOW;
+}
+
+DispatchTicket RepairDispatcher::toTicket(const Job& job) {
+    DispatchTicket ticket;
+    ticket.repairId = std::to_string(job.id);
+    ticket.dormId = job.dormId;
+    ticket.building = job.building;
+    ticket.content = job.content;
+    ticket.repairDate = job.repairDate;
+    ticket.urgency = job.urgency;
+    ticket.dueDate = Common::daysToDate(job.dueDay);
+    return ticket;
+}
+
+void RepairDispatcher::publishLocked(std::vector<JobPtr> jobs) {
+    //最迟处理日期→紧急程度→楼栋→报修ID
+    std::sort(jobs.begin(), jobs.end(), [](const JobPtr& a, const JobPtr& b) {
+        if (a->dueDay != b->dueDay) return a->dueDay < b->dueDay;
+        if (a->urgency != b->urgency) return a->urgency < b->urgency;
+        if (a->building != b->building) return a->building < b->building;
+        return a->id < b->id;
+    });
+
+    std::shared_ptr<Snapshot> snapshot = std::make_shared<Snapshot>();
+    snapshot->jobs = std::move(jobs);
+    snapshot->byId.reserve(snapshot->jobs.size() * 2);
+    snapshot->all.jobs.reserve(snapshot->jobs.size());
+    for (const JobPtr& job : snapshot->jobs) {
+        snapshot->byId[job->id] = job.get();
+        snapshot->all.jobs.push_back(job.get());
+
+        std::unique_ptr<Lane>& lane = snapshot->byBuilding[job->building];
+        if (!lane) lane.reset(new Lane());
+        lane->jobs.push_back(job.get());
+    }
+    std::atomic_store(&current, snapshot);
+}
+
+std::vector<RepairDispatcher::JobPtr> RepairDispatcher::liveJobsLocked() {
+    std::vector<JobPtr> jobs;
+    std::shared_ptr<Snapshot> snapshot = std::atomic_load(&current);
+    if (!snapshot) return jobs;
+    jobs.reserve(snapshot->jobs.size() + 1);
+    for (const JobPtr& job : snapshot->jobs) {
+        if (job->state.load() != JOB_DONE) jobs.push_back(job);
+    }
+    return jobs;
+}
+
+bool RepairDispatcher::rebuild() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+
+    std::vector<JobPtr> jobs;
+    int64_t rows = DBHelper::getInstance().executeQueryStream(
+        "SELECT r.repair_id, r.dorm_id, IFNULL(d.building, ''), r.repair_content, r.repair_date, r.handle_status "
+        "FROM repair r LEFT JOIN dorm d ON r.dorm_id = d.dorm_id WHERE r.handle_status != 2",
+        [&jobs](const DBRowView& row) {
+            JobPtr job = std::make_shared<Job>();
+            job->id = std::strtoll(row.getString(0).c_str(), nullptr, 10);
+            job->dormId = row.getString(1);
+            job->building = row.getString(2);
+            job->content = row.getString(3);
+            job->repairDate = row.getDate(4);
+            job->urgency = classify(job->content);
+            job->dueDay = Common::dateToDays(job->repairDate) + SLA_DAYS[static_cast<int>(job->urgency)];
+            //处理中的报修已有人负责，只保留在队列中等待完成
+            job->state.store(row.getString(5) == "1" ? JOB_CLAIMED : JOB_OPEN);
+            jobs.push_back(job);
+        });
+    if (rows < 0) {
+        setError("加载报修队列失败：" + DBHelper::getInstance().getLastError().errorMsg);
+        return false;
+    }
+
+    publishLocked(std::move(jobs));
+    loaded.store(true);
+    return true;
+}
+
+bool RepairDispatcher::ensureLoaded() {
+    if (loaded.load()) return true;
+    return rebuild();
+}
+
+RepairDispatcher::Job* RepairDispatcher::claimFromLane(Lane& lane) {
+    size_t index = lane.cursor.load();
+    for (; index < lane.jobs.size(); ++index) {
+        Job* job = lane.jobs[index];
+        int expected = JOB_OPEN;
+        if (job->state.load() == JOB_OPEN && job->state.compare_exchange_strong(expected, JOB_CLAIMED)) {
+            //游标只前移，其他领取者跳过已领取的前缀
+            size_t seen = lane.cursor.load();
+            while (seen < index && !lane.cursor.compare_exchange_weak(seen, index)) {}
+            return job;
+        }
+    }
+    size_t seen = lane.cursor.load();
+    while (seen < index && !lane.cursor.compare_exchange_weak(seen, index)) {}
+    return nullptr;
+}
+
+bool RepairDispatcher::claimNext(const std::string& building, DispatchTicket& ticket) {
+    if (!ensureLoaded()) return false;
+    std::string trimmedBuilding = Common::trim(building);
+
+    RepairManager repairMgr;
+    while (true) {
+        std::shared_ptr<Snapshot> snapshot = std::atomic_load(&current);
+        Lane* lane = &snapshot->all;
+        if (!trimmedBuilding.empty()) {
+            auto it = snapshot->byBuilding.find(trimmedBuilding);
+            if (it == snapshot->byBuilding.end()) {
+                setError("楼栋" + trimmedBuilding + "暂无待领取的报修！");
+                return false;
+            }
+            lane = it->second.get();
+        }
+
+        Job* job = claimFromLane(*lane);
+        if (job == nullptr) {
+            setError("暂无待领取的报修！");
+            return false;
+        }
+
+        //持久化：未处理→处理中
+        if (repairMgr.updateHandleStatus(std::to_string(job->id), RepairStatus::HANDLING)) {
+            ticket = toTicket(*job);
+            return true;
+        }
+
+        //已被其他途径处理或删除则跳过，否则退回任务
+        Repair existRepair = repairMgr.getRepairById(std::to_string(job->id));
+        if (existRepair.repairId.empty() || existRepair.handleStatus == RepairStatus::COMPLETED) {
+            if (job->state.exchange(JOB_DONE) != JOB_DONE) snapshot->doneCount.fetch_add(1);
+            continue;
+        }
+        if (existRepair.handleStatus == RepairStatus::HANDLING) {
+            continue;
+        }
+        job->state.store(JOB_OPEN);
+        setError("领取失败：" + repairMgr.getLastError());
+        //游标可能已越过该任务，重新发布快照
+        std::lock_guard<std::mutex> lock(writerMutex);
+        publishLocked(liveJobsLocked());
+        return false;
+    }
+}
+
+bool RepairDispatcher::complete(const std::string& repairId) {
+    RepairManager repairMgr;
+    if (!repairMgr.updateHandleStatus(repairId, RepairStatus::COMPLETED)) {
+        setError("完成失败：" + repairMgr.getLastError());
+        return false;
+    }
+    return true;
+}
+
+void RepairDispatcher::onRepairAdded(const Repair& repair) {
+    if (!loaded.load()) return;
+    //楼栋在加锁前查好
+    JobPtr job = std::make_shared<Job>();
+    job->id = std::strtoll(Common::trim(repair.repairId).c_str(), nullptr, 10);
+    job->dormId = Common::trim(repair.dormId);
+    job->building = ExistenceCache::getInstance().getBuildingOfDorm(job->dormId);
+    job->content = Common::trim(repair.repairContent);
+    job->repairDate = repair.repairDate;
+    job->urgency = classify(job->content);
+    job->dueDay = Common::dateToDays(job->repairDate) + SLA_DAYS[static_cast<int>(job->urgency)];
+
+    std::lock_guard<std::mutex> lock(writerMutex);
+    std::vector<JobPtr> jobs = liveJobsLocked();
+    jobs.push_back(job);
+    publishLocked(std::move(jobs));
+}
+
+void RepairDispatcher::onRepairRemoved(const std::string& repairId) {
+    onStatusChanged(repairId, RepairStatus::COMPLETED);
+}
+
+void RepairDispatcher::onStatusChanged(const std::string& repairId, RepairStatus newStatus) {
+    std::shared_ptr<Snapshot> snapshot = std::atomic_load(&current);
+    if (!snapshot) return;
+    auto it = snapshot->byId.find(std::strtoll(Common::trim(repairId).c_str(), nullptr, 10));
+    if (it == snapshot->byId.end()) return;
+
+    if (newStatus == RepairStatus::HANDLING) {
+        int expected = JOB_OPEN;
+        it->second->state.compare_exchange_strong(expected, JOB_CLAIMED);
+        return;
+    }
+    if (newStatus == RepairStatus::COMPLETED) {
+        if (it->second->state.exchange(JOB_DONE) == JOB_DONE) return;
+
+        //已完成任务超过四分之一时压缩快照
+        size_t done = snapshot->doneCount.fetch_add(1) + 1;
+        if (done * 4 <= snapshot->jobs.size()) return;
+        std::unique_lock<std::mutex> lock(writerMutex, std::try_to_lock);
+        if (lock.owns_lock() && std::atomic_load(&current) == snapshot) {
+            publishLocked(liveJobsLocked());
+        }
+    }
+}
+
+int RepairDispatcher::getPendingCount() {
+    if (!ensureLoaded()) return 0;
+    std::shared_ptr<Snapshot> snapshot = std::atomic_load(&current);
+    int count = 0;
+    for (size_t i = snapshot->all.cursor.load(); i < snapshot->all.jobs.size(); ++i) {
+        if (snapshot->all.jobs[i]->state.load() == JOB_OPEN) ++count;
+    }
+    return count;
+}
@@ -0,0 +1,132 @@
+#ifndef REPAIRDISPATCHER_H
+#define REPAIRDISPATCHER_H
+
+#include "RepairManager.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+// 紧急程度（数值越小越紧急）
+enum class RepairUrgency {
+    URGENT = 0,   // 漏水、断电、门锁等，1天内处理
+    NORMAL = 1,   // 灯具、空调、热水等，3天内处理
+    LOW = 2       // 其他，7天内处理
+};
+
+// 派单结果
+struct DispatchTicket {
+    std::string repairId;     // 报修ID
+    std::string dormId;       // 宿舍号
+    std::string building;     // 楼栋
+    std::string content;      // 报修内容
+    Date repairDate;          // 报修日期
+    RepairUrgency urgency;    // 紧急程度
+    Date dueDate;             // 最迟处理日期
+
+    DispatchTicket() : repairDate(0, 0, 0), urgency(RepairUrgency::LOW), dueDate(0, 0, 0) {}
+};
+
+// --------------- 报修派单队列（单例）---------------
+// 未处理/处理中的报修按"最迟处理日期→紧急程度→楼栋→报修ID"排成不可变快照，
+// 维修人员领取时只对任务状态做CAS，多人并发领取互不加锁；
+// 新增/删除/状态变化时写者复制出新快照整体替换，已完成的任务在此时清除。
+// 领取后通过RepairManager::updateHandleStatus持久化（未处理→处理中）。
+class RepairDispatcher {
+public:
+    static RepairDispatcher& getInstance();
+
+    // 领取下一个任务（building为空表示不限楼栋），队列为空返回false
+    bool claimNext(const std::string& building, DispatchTicket& ticket);
+
+    // 完成已领取的任务（处理中→已完成）
+    bool complete(const std::string& repairId);
+
+    // RepairManager写操作后同步
+    void onRepairAdded(const Repair& repair);
+    void onRepairRemoved(const std::string& repairId);
+    void onStatusChanged(const std::string& repairId, RepairStatus newStatus);
+
+    // 待领取任务数
+    int getPendingCount();
+
+    // 按报修内容判断紧急程度
+    static RepairUrgency classify(const std::string& content);
+
+    // 首次使用时加载
+    bool ensureLoaded();
+
+    // 从repair表重建
+    bool rebuild();
+
+    std::string getLastError();
+
+private:
+    RepairDispatcher() : loaded(false) {}
+    RepairDispatcher(const RepairDispatcher&) = delete;
+    RepairDispatcher& operator=(const RepairDispatcher&) = delete;
+
+    // 任务状态
+    enum JobState { JOB_OPEN = 0, JOB_CLAIMED = 1, JOB_DONE = 2 };
+
+    // 一个任务（除state外创建后不再修改）
+    struct Job {
+        int64_t id;
+        std::string dormId;
+        std::string building;
+        std::string content;
+        Date repairDate;
+        RepairUrgency urgency;
+        int dueDay;                   // 最迟处理日（自1970-01-01起天数）
+        std::atomic<int> state;
+
+        Job() : id(0), repairDate(0, 0, 0), urgency(RepairUrgency::LOW), dueDay(0), state(JOB_OPEN) {}
+    };
+    typedef std::shared_ptr<Job> JobPtr;
+
+    // 一条按优先级排好的领取队列
+    struct Lane {
+        std::vector<Job*> jobs;
+        std::atomic<size_t> cursor;   // 此前的任务均已被领取
+
+        Lane() : cursor(0) {}
+    };
+
+    // 不可变快照（只有任务状态和游标会变化）
+    struct Snapshot {
+        std::vector<JobPtr> jobs;                               // 按优先级排序
+        std::unordered_map<int64_t, Job*> byId;
+        Lane all;
+        std::map<std::string, std::unique_ptr<Lane>> byBuilding;
+        std::atomic<size_t> doneCount;                          // 已完成但仍在快照中的任务数
+
+        Snapshot() : doneCount(0) {}
+    };
+
+    std::shared_ptr<Snapshot> current;   // 通过std::atomic_load/atomic_store读写
+    std::mutex writerMutex;              // 写者之间互斥
+    std::atomic<bool> loaded;
+    std::mutex errorMutex;
+    std::string lastError;
+
+    // 从任务列表生成新快照并发布（已持有writerMutex）
+    void publishLocked(std::vector<JobPtr> jobs);
+
+    // 当前快照中未完成的任务
+    std::vector<JobPtr> liveJobsLocked();
+
+    // 在一条队列上领取
+    static Job* claimFromLane(Lane& lane);
+
+    // 设置错误信息
+    void setError(const std::string& message);
+
+    // 任务转为派单结果
+    static DispatchTicket toTicket(const Job& job);
+};
+
+#endif // REPAIRDISPATCHER_H
@@ -1,6 +1,13 @@
 #include "RepairManager.h"
 #include "Common.h"
 #include "DBHelper.h"
+#include "ExistenceCache.h"
+#include "IdAllocator.h"
+#include "RepairDispatcher.h"
+#include "RepairAnalytics.h"
+#include "RepairDedupIndex.h"
+#include "AuditJournal.h"
+#include "ChangeFeed.h"
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
@@ -36,7 +43,7 @@ bool RepairManager::validateRepair(const Repair& repair, bool isAdd) {
         lastError = "学号格式错误！";
         return false;
     }
-    if (!isStudentExist(trimmedStuId)) {
+    if (!ExistenceCache::getInstance().isStudentExist(trimmedStuId)) {
         lastError = "学号" + trimmedStuId + "对应的学生不存在！";
         return false;
     }
@@ -51,7 +58,7 @@ bool RepairManager::validateRepair(const Repair& repair, bool isAdd) {
         lastError = "宿舍号格式错误！";
         return false;
     }
-    if (!isDormExist(trimmedDormId)) {
+    if (!ExistenceCache::getInstance().isDormExist(trimmedDormId)) {
         lastError = "宿舍号" + trimmedDormId + "对应的宿舍不存在！";
         return false;
     }
@@ -118,56 +125,18 @@ Repair RepairManager::rowToRepair(const std::map<std::string, std::string>& row)
     return repair;
 }
 
-//辅助函数：生成报修ID
+//辅助函数：生成报修ID（从ID分配服务的预留块中取号，无需额外查询）
 std::string RepairManager::generateRepairId() {
-    //查询当前最大报修ID
-    std::string sql = "SELECT MAX(repair_id) AS max_id FROM repair";
+    static IdSequence& repairSeq = IdAllocator::getInstance().getSequence(
+        "repair", "SELECT IFNULL(MAX(repair_id), 0) FROM repair");
 
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) {
-        return "1"; //查询失败时默认返回1
+    int64_t id = repairSeq.next();
+    if (id <= 0) {
+        return ""; //预留失败
     }
 
-    //2. 解析最大序号并+1
-    int maxSeq = 0;
-    if (result->rowCount > 0 && !result->rows[0]["max_id"].empty()) {
-        std::string maxId = result->rows[0]["max_id"];
-        Common::stringToInt(maxId, maxSeq);
-    }
-
-    DBHelper::getInstance().freeResultset(result);
-    maxSeq++;
-
-    //3. 返回纯数字ID
-    return std::to_string(maxSeq);
-}
-
-//辅助函数：校验学号是否存在 
-bool RepairManager::isStudentExist(const std::string& studentId) {
-    std::string trimmedId = Common::trim(studentId);
-    if (trimmedId.empty()) return false;
-
-    std::string sql = "SELECT student_id FROM student WHERE student_id = '" + trimmedId + "' LIMIT 1";
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) return false;
-
-    bool exist = result->rowCount > 0;
-    DBHelper::getInstance().freeResultset(result);
-    return exist;
-}
-
-//辅助函数：校验宿舍号是否存在 
-bool RepairManager::isDormExist(const std::string& dormId) {
-    std::string trimmedId = Common::trim(dormId);
-    if (trimmedId.empty()) return false;
-
-    std::string sql = "SELECT dorm_id FROM dorm WHERE dorm_id = '" + trimmedId + "' LIMIT 1";
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) return false;
-
-    bool exist = result->rowCount > 0;
-    DBHelper::getInstance().freeResultset(result);
-    return exist;
+    //返回纯数字ID
+    return std::to_string(id);
 }
 
 //辅助函数：校验报修状态流转合法性 
@@ -179,15 +148,36 @@ bool RepairManager::isValidStatusTransition(RepairStatus prevStatus, RepairStatu
     return false;
 }
 
+//报修的各列值（列名与数据库一致），用于审计日志和变更通知
+static AuditValues repairColumns(const Repair& repair) {
+    return AuditValues{
+        { "student_id", Common::trim(repair.studentId) },
+        { "dorm_id", Common::trim(repair.dormId) },
+        { "repair_content", Common::trim(repair.repairContent) },
+        { "repair_date", repair.repairDate.isEmpty() ? std::string() : Common::dateToString(repair.repairDate) },
+        { "handle_status", std::to_string(static_cast<int>(repair.handleStatus)) },
+        { "handle_date", repair.handleDate.isEmpty() ? std::string() : Common::dateToString(repair.handleDate) }
+    };
+}
+
 //提交报修申请实现 
-bool RepairManager::addRepair(const Repair& repair) {
+bool RepairManager::addRepair(const Repair& repair, bool allowDuplicate) {
     lastError.clear();
+    lastDuplicate.clear();
 
     //校验数据合法性（添加模式）
     if (!validateRepair(repair, true)) {
         return false;
     }
 
+    //同宿舍未完成报修中查重
+    DuplicateMatch match;
+    if (!allowDuplicate && RepairDedupIndex::getInstance().findDuplicate(repair.dormId, repair.repairContent, match)) {
+        lastDuplicate = match.repairId;
+        lastError = "疑似重复报修：与报修" + match.repairId + "（" + match.content + "）内容相近！";
+        return false;
+    }
+
     //生成报修ID
     std::string repairId = generateRepairId();
     if (repairId.empty()) {
@@ -199,7 +189,9 @@ bool RepairManager::addRepair(const Repair& repair) {
     std::ostringstream sqlStream;
     std::string trimmedContent = Common::trim(repair.repairContent);
 
-    std::string repairDateStr = Common::dateToString(repair.repairDate);
+    //未填写报修日期时取当天
+    Date repairDate = repair.repairDate.orToday();
+    std::string repairDateStr = Common::dateToString(repairDate);
 
     sqlStream << "INSERT INTO repair (repair_id, student_id, dorm_id, repair_content, repair_date, "
         << "handle_status, handle_date) "
@@ -222,6 +214,16 @@ bool RepairManager::addRepair(const Repair& repair) {
         return false;
     }
 
+    //加入派单队列，记录审计日志并发布变更
+    Repair added(repairId, Common::trim(repair.studentId), Common::trim(repair.dormId), trimmedContent,
+        repairDate, RepairStatus::UNHANDLED, Date(0, 0, 0));
+    RepairDispatcher::getInstance().onRepairAdded(added);
+    if (affectedRows > 0) {
+        ChangeValues columns = repairColumns(added);
+        AuditJournal::getInstance().recordInsert(AuditEntity::REPAIR, repairId, columns);
+        ChangeFeed::getInstance().publishInsert(ChangeTable::REPAIR, repairId, columns);
+    }
+
     return affectedRows >= 0;
 }
 
@@ -255,9 +257,7 @@ bool RepairManager::updateRepair(const Repair& repair) {
     sqlStream << "UPDATE repair SET "
         << "student_id = '" << Common::trim(repair.studentId) << "', "
         << "dorm_id = '" << Common::trim(repair.dormId) << "', "
-        << "repair_content = '" << trimmedContent << "', ";
-
-   
+        << "repair_content = '" << trimmedContent << "' ";
 
     sqlStream << "WHERE repair_id = " << Common::trim(repair.repairId);
 
@@ -269,6 +269,16 @@ bool RepairManager::updateRepair(const Repair& repair) {
         return false;
     }
 
+    if (affectedRows > 0) {
+        Repair updated = existRepair;
+        updated.studentId = repair.studentId;
+        updated.dormId = repair.dormId;
+        updated.repairContent = trimmedContent;
+        ChangeValues before = repairColumns(existRepair);
+        ChangeValues after = repairColumns(updated);
+        AuditJournal::getInstance().recordUpdate(AuditEntity::REPAIR, existRepair.repairId, before, after);
+        ChangeFeed::getInstance().publishUpdate(ChangeTable::REPAIR, existRepair.repairId, before, after);
+    }
     return affectedRows >= 0;
 }
 
@@ -313,7 +323,7 @@ bool RepairManager::updateHandleStatus(const std::string& repairId, RepairStatus
 
     //构建UPDATE SQL
     std::ostringstream sqlStream;
-    Date now;
+    Date now = Date::today();
     std::string handleDateStr = Common::dateToString(now);
 
     sqlStream << "UPDATE repair SET "
@@ -324,19 +334,36 @@ bool RepairManager::updateHandleStatus(const std::string& repairId, RepairStatus
     std::string sqlStr = sqlStream.str();
     //执行SQL
     std::string sql = sqlStream.str();
-    int affectedRows = DBHelper::getInstance().executeUpdate(sql);
+    int affectedRows = 0;
+    if (newStatus == RepairStatus::COMPLETED) {
+        //完成时与统计重建串行，避免重复计数
+        affectedRows = RepairAnalytics::getInstance().commitCompletion(existRepair.dormId, existRepair.repairDate, now,
+            [&sql]() { return DBHelper::getInstance().executeUpdate(sql); });
+    }
+    else {
+        affectedRows = DBHelper::getInstance().executeUpdate(sql);
+    }
     if (affectedRows == -1) {
         DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
         lastError = "更新失败：" + dbErr.errorMsg;
         return false;
     }
-    
+
     //检查是否有行被更新
     if (affectedRows == 0) {
         lastError = "更新失败：未找到匹配的记录";
         return false;
     }
 
+    RepairDispatcher::getInstance().onStatusChanged(trimmedId, newStatus);
+    Repair handled = existRepair;
+    handled.handleStatus = newStatus;
+    handled.handleDate = now;
+    ChangeValues before = repairColumns(existRepair);
+    ChangeValues after = repairColumns(handled);
+    AuditJournal::getInstance().recordStatus(AuditEntity::REPAIR, existRepair.repairId, before, after);
+    ChangeFeed::getInstance().publishUpdate(ChangeTable::REPAIR, existRepair.repairId, before, after);
+
     //强制刷新数据库缓存，确保Navicat等工具能立即看到更新
     DBHelper::getInstance().executeUpdate("FLUSH TABLES");
     
@@ -390,6 +417,12 @@ bool RepairManager::deleteRepair(const std::string& repairId) {
         return false;
     }
 
+    RepairDispatcher::getInstance().onRepairRemoved(trimmedId);
+    if (affectedRows > 0) {
+        ChangeValues columns = repairColumns(existRepair);
+        AuditJournal::getInstance().recordRemove(AuditEntity::REPAIR, existRepair.repairId, columns);
+        ChangeFeed::getInstance().publishRemove(ChangeTable::REPAIR, existRepair.repairId, columns);
+    }
     return affectedRows >= 0;
 }
 
@@ -623,4 +656,8 @@ int RepairManager::getFilterTotalCount(const std::string& studentId, const std::
 //获取最后一次操作错误信息实现 
 std::string RepairManager::getLastError() const {
     return lastError;
+}
+
+std::string RepairManager::getLastDuplicate() const {
+    return lastDuplicate;
 }
\ No newline at end of file
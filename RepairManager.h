@@ -34,7 +34,8 @@ struct Repair {
 
 class RepairManager {
 public:
-    bool addRepair(const Repair& repair);
+    //allowDuplicate为false时，与同宿舍未完成报修疑似重复则拒绝提交（见getLastDuplicate）
+    bool addRepair(const Repair& repair, bool allowDuplicate = false);
     bool updateRepair(const Repair& repair);
     bool updateHandleStatus(const std::string& repairId, RepairStatus newStatus);
     bool deleteRepair(const std::string& repairId);
@@ -47,14 +48,15 @@ public:
     int getFilterTotalCount(const std::string& studentId, const std::string& dormId,
         RepairStatus handleStatus);
     std::string getLastError() const;
+    //最近一次被判为重复时匹配到的已有报修ID（未判重为空）
+    std::string getLastDuplicate() const;
 
 private:
     std::string lastError; 
+    std::string lastDuplicate;
     bool validateRepair(const Repair& repair, bool isAdd = true);
     Repair rowToRepair(const std::map<std::string, std::string>& row);
     std::string generateRepairId();
-    bool isStudentExist(const std::string& studentId);
-    bool isDormExist(const std::string& dormId);
     bool isValidStatusTransition(RepairStatus prevStatus, RepairStatus newStatus);
 };
 
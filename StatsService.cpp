@@ -0,0 +1,197 @@
+#include "StatsService.h"
+#include "StudentManager.h"
+#include "DormManager.h"
+#include "FeeManager.h"
+#include "RepairManager.h"
+#include "VisitorManager.h"
+#include "DBHelper.h"
+#include "ChangeFeed.h"
+#include <chrono>
+
+StatsService& StatsService::getInstance() {
+    static StatsService instance;
+    return instance;
+}
+
+std::shared_ptr<const StatsSnapshot> StatsService::getSnapshot() const {
+    std::shared_ptr<const StatsSnapshot> snapshot = std::atomic_load(&current);
+    if (!snapshot) {
+        static const std::shared_ptr<const StatsSnapshot> empty = std::make_shared<StatsSnapshot>();
+        return empty;
+    }
+    return snapshot;
+}
+
+template <typename Fn>
+void StatsService::update(Fn fn) {
+    writeEpoch.fetch_add(1);
+    std::shared_ptr<const StatsSnapshot> expected = std::atomic_load(&current);
+    while (expected) {
+        std::shared_ptr<StatsSnapshot> next = std::make_shared<StatsSnapshot>(*expected);
+        fn(*next);
+        next->updatedAt = time(nullptr);
+        std::shared_ptr<const StatsSnapshot> desired = next;
+        if (std::atomic_compare_exchange_weak(&current, &expected, desired)) return;
+    }
+}
+
+void StatsService::adjust(StatsCounter counter, int delta) {
+    if (delta == 0) return;
+    update([counter, delta](StatsSnapshot& snapshot) {
+        int& count = snapshot.counts[static_cast<int>(counter)];
+        count += delta;
+        if (count < 0) count = 0;
+    });
+}
+
+void StatsService::set(StatsCounter counter, int value) {
+    update([counter, value](StatsSnapshot& snapshot) {
+        snapshot.counts[static_cast<int>(counter)] = value < 0 ? 0 : value;
+    });
+}
+
+void StatsService::subscribeChanges() {
+    static std::once_flag once;
+    std::call_once(once, [this]() {
+        ChangeFeed::getInstance().subscribe("统计计数", ChangeDelivery::INLINE,
+            [this](const ChangeEvent& event) { onChange(event); },
+            [this]() { applyPending(); });
+    });
+}
+
+void StatsService::onChange(const ChangeEvent& event) {
+    static const std::string unpaid = std::to_string(static_cast<int>(PayStatus::UNPAID));
+    static const std::string completed = std::to_string(static_cast<int>(RepairStatus::COMPLETED));
+    int sign = event.kind == ChangeKind::INSERT ? 1 : (event.kind == ChangeKind::REMOVE ? -1 : 0);
+    auto add = [this](StatsCounter counter, int delta) { pendingDelta[static_cast<int>(counter)] += delta; };
+
+    switch (event.table) {
+    case ChangeTable::STUDENT:
+        add(StatsCounter::STUDENTS, sign);
+        break;
+    case ChangeTable::DORM:
+        add(StatsCounter::DORMS, sign);
+        break;
+    case ChangeTable::FEE: {
+        add(StatsCounter::FEES, sign);
+        const ChangeColumn* status = event.find("pay_status");
+        if (!status) break;
+        if (sign != 0) {
+            if (status->value == unpaid) add(StatsCounter::UNPAID_FEES, sign);
+        }
+        else if (status->changed) {
+            add(StatsCounter::UNPAID_FEES, (status->value == unpaid) - (status->previous == unpaid));
+        }
+        break;
+    }
+    case ChangeTable::REPAIR: {
+        add(StatsCounter::REPAIRS, sign);
+        const ChangeColumn* status = event.find("handle_status");
+        if (!status) break;
+        if (sign != 0) {
+            if (status->value != completed) add(StatsCounter::UNFINISHED_REPAIRS, sign);
+        }
+        else if (status->changed) {
+            add(StatsCounter::UNFINISHED_REPAIRS, (status->value != completed) - (status->previous != completed));
+        }
+        break;
+    }
+    case ChangeTable::VISITOR: {
+        //未登记离开时间的为在访访客
+        add(StatsCounter::VISITORS, sign);
+        const ChangeColumn* leave = event.find("leave_time");
+        if (!leave) break;
+        if (sign != 0) {
+            if (leave->value.empty()) add(StatsCounter::ACTIVE_VISITORS, sign);
+        }
+        else if (leave->changed) {
+            add(StatsCounter::ACTIVE_VISITORS, static_cast<int>(leave->value.empty()) - static_cast<int>(leave->previous.empty()));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void StatsService::applyPending() {
+    bool any = false;
+    for (int delta : pendingDelta) any = any || delta != 0;
+    if (!any) return;
+
+    int deltas[static_cast<int>(StatsCounter::COUNT)];
+    for (int i = 0; i < static_cast<int>(StatsCounter::COUNT); ++i) {
+        deltas[i] = pendingDelta[i];
+        pendingDelta[i] = 0;
+    }
+    update([&deltas](StatsSnapshot& snapshot) {
+        for (int i = 0; i < static_cast<int>(StatsCounter::COUNT); ++i) {
+            snapshot.counts[i] += deltas[i];
+            if (snapshot.counts[i] < 0) snapshot.counts[i] = 0;
+        }
+    });
+}
+
+bool StatsService::refreshNow() {
+    if (!DBHelper::getInstance().isConnected()) return false;
+    std::lock_guard<std::mutex> lock(refreshMutex);
+
+    //查询期间有增量写入时结果可能已过时，重试一次，仍冲突则保留增量结果等下次刷新
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        uint64_t epoch = writeEpoch.load();
+
+        StudentManager studentMgr;
+        DormManager dormMgr;
+        FeeManager feeMgr;
+        RepairManager repairMgr;
+        VisitorManager visitorMgr;
+
+        std::shared_ptr<StatsSnapshot> snapshot = std::make_shared<StatsSnapshot>();
+        snapshot->counts[static_cast<int>(StatsCounter::STUDENTS)] = studentMgr.getStudentTotalCount();
+        snapshot->counts[static_cast<int>(StatsCounter::DORMS)] = dormMgr.getDormTotalCount();
+        snapshot->counts[static_cast<int>(StatsCounter::FEES)] = feeMgr.getFeeTotalCount();
+        snapshot->counts[static_cast<int>(StatsCounter::UNPAID_FEES)] = feeMgr.getUnpaidFeeCount();
+        snapshot->counts[static_cast<int>(StatsCounter::REPAIRS)] = repairMgr.getRepairTotalCount();
+        snapshot->counts[static_cast<int>(StatsCounter::UNFINISHED_REPAIRS)] = repairMgr.getUnfinishedRepairCount();
+        snapshot->counts[static_cast<int>(StatsCounter::VISITORS)] = visitorMgr.getVisitorTotalCount();
+        snapshot->counts[static_cast<int>(StatsCounter::ACTIVE_VISITORS)] = visitorMgr.getActiveVisitorCount();
+
+        std::shared_ptr<const StatsSnapshot> expected = std::atomic_load(&current);
+        if (writeEpoch.load() != epoch && expected) continue;
+
+        snapshot->valid = true;
+        snapshot->refreshedAt = time(nullptr);
+        snapshot->updatedAt = snapshot->refreshedAt;
+        std::shared_ptr<const StatsSnapshot> desired = snapshot;
+        if (std::atomic_compare_exchange_strong(&current, &expected, desired)) return true;
+    }
+    return false;
+}
+
+void StatsService::start(int ttl) {
+    std::lock_guard<std::mutex> lock(threadMutex);
+    if (running) return;
+    ttlSeconds = ttl > 0 ? ttl : 60;
+    running = true;
+    worker = std::thread(&StatsService::run, this);
+}
+
+void StatsService::stop() {
+    {
+        std::lock_guard<std::mutex> lock(threadMutex);
+        if (!running) return;
+        running = false;
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void StatsService::run() {
+    std::unique_lock<std::mutex> lock(threadMutex);
+    while (running) {
+        lock.unlock();
+        refreshNow();
+        lock.lock();
+        wakeup.wait_for(lock, std::chrono::seconds(ttlSeconds), [this] { return !running; });
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef STATSSERVICE_H
+#define STATSSERVICE_H
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <ctime>
+#include <cstdint>
+
+struct ChangeEvent;
+
+// 统计计数项
+enum class StatsCounter {
+    STUDENTS = 0,          // 学生总数
+    DORMS,                 // 宿舍总数
+    FEES,                  // 收费记录数
+    UNPAID_FEES,           // 未支付费用数
+    REPAIRS,               // 报修记录数
+    UNFINISHED_REPAIRS,    // 未完成报修数
+    VISITORS,              // 访客记录数
+    ACTIVE_VISITORS,       // 在访访客数
+    COUNT
+};
+
+// 统计快照（发布后不再修改）
+struct StatsSnapshot {
+    int counts[static_cast<int>(StatsCounter::COUNT)];
+    bool valid;              // 是否已从数据库加载过
+    time_t refreshedAt;      // 最近一次全量刷新时间
+    time_t updatedAt;        // 最近一次变化时间（含增量）
+
+    StatsSnapshot() : valid(false), refreshedAt(0), updatedAt(0) {
+        for (int& count : counts) count = 0;
+    }
+
+    int get(StatsCounter counter) const { return counts[static_cast<int>(counter)]; }
+};
+
+// --------------- 系统统计快照服务（单例）---------------
+// 订阅数据变更增量修正计数，后台线程按TTL全量重查作为兜底；
+// 快照整体替换发布，界面读取时只做一次原子加载，不访问数据库。
+class StatsService {
+public:
+    static StatsService& getInstance();
+
+    // 当前快照（未加载时valid为false）
+    std::shared_ptr<const StatsSnapshot> getSnapshot() const;
+
+    // 计数增量修正（快照未加载时忽略）
+    void adjust(StatsCounter counter, int delta);
+
+    // 直接设置某项计数（来源本身已在内存中维护时使用）
+    void set(StatsCounter counter, int value);
+
+    // 订阅数据变更（启动时调用一次），同一批事件的增量合并后一次发布
+    void subscribeChanges();
+
+    // 启动后台刷新线程，立即刷新一次，之后每ttlSeconds秒刷新
+    void start(int ttlSeconds = 60);
+
+    // 停止后台线程
+    void stop();
+
+    // 同步全量刷新（执行8条COUNT查询）
+    bool refreshNow();
+
+private:
+    StatsService() : running(false), ttlSeconds(60), writeEpoch(0) {
+        for (int& delta : pendingDelta) delta = 0;
+    }
+    StatsService(const StatsService&) = delete;
+    StatsService& operator=(const StatsService&) = delete;
+    ~StatsService() { stop(); }
+
+    std::shared_ptr<const StatsSnapshot> current;
+    std::mutex refreshMutex;              // 串行化全量刷新
+    std::mutex threadMutex;
+    std::condition_variable wakeup;
+    std::thread worker;
+    bool running;
+    int ttlSeconds;
+    std::atomic<uint64_t> writeEpoch;     // 每次增量修正加一，用于发现刷新期间的并发写入
+    int pendingDelta[static_cast<int>(StatsCounter::COUNT)];    // 当前批次的增量（只在变更处理中访问）
+
+    // 在当前快照基础上修改并以CAS发布
+    template <typename Fn>
+    void update(Fn fn);
+
+    void run();
+
+    // 累计一个变更事件的增量
+    void onChange(const ChangeEvent& event);
+
+    // 发布并清空当前批次的增量
+    void applyPending();
+};
+
+#endif // STATSSERVICE_H
@@ -2,14 +2,21 @@
 #include "DormManager.h"
 #include "Common.h"
 #include "DBHelper.h"
+#include "ExistenceCache.h"
+#include "OccupancyTable.h"
+#include "FreeBedIndex.h"
+#include "BatchValidation.h"
+#include "AuditJournal.h"
+#include "ChangeFeed.h"
 #include <sstream>
+#include <set>
 #include <algorithm>
 
 //化静态成员变量
 DormManager* StudentManager::dormManager = nullptr;
 
 //辅助函数：校验学生数据合法性 
-bool StudentManager::validateStudent(const Student& student) {
+bool StudentManager::validateStudent(const Student& student, bool formatChecked) {
     lastError.clear();
 
     //校验学号
@@ -18,7 +25,7 @@ bool StudentManager::validateStudent(const Student& student) {
         lastError = "学号不能为空！";
         return false;
     }
-    if (!Common::isValidStudentID(trimmedId)) {
+    if (!formatChecked && !Common::isValidStudentID(trimmedId)) {
         lastError = "学号格式错误！";
         return false;
     }
@@ -29,7 +36,7 @@ bool StudentManager::validateStudent(const Student& student) {
         lastError = "姓名不能为空！";
         return false;
     }
-    if (!Common::isValidName(trimmedName)) {
+    if (!formatChecked && !Common::isValidName(trimmedName)) {
         lastError = "姓名格式错误（2-20位中文或字母）！";
         return false;
     }
@@ -75,7 +82,7 @@ bool StudentManager::validateStudent(const Student& student) {
 
     //校验手机号（可选，非空则格式正确）
     std::string trimmedPhone = Common::trim(student.studentPhone);
-    if (!trimmedPhone.empty() && !Common::isValidPhone(trimmedPhone)) {
+    if (!formatChecked && !trimmedPhone.empty() && !Common::isValidPhone(trimmedPhone)) {
         lastError = "手机号格式错误（11位数字，以13/14/15/17/18/19开头）！";
         return false;
     }
@@ -109,6 +116,44 @@ Student StudentManager::rowToStudent(const std::map<std::string, std::string>& r
     return student;
 }
 
+//辅助函数：构建INSERT的一组VALUES（处理日期和空值）
+std::string StudentManager::buildInsertValues(const Student& student) {
+    std::ostringstream sqlStream;
+    std::string trimmedPhone = Common::trim(student.studentPhone);
+    sqlStream << "("
+        << "'" << Common::trim(student.studentId) << "', "
+        << "'" << Common::trim(student.studentName) << "', "
+        << "'" << Common::trim(student.gender) << "', "
+        << student.age << ", "  //年龄是数字，不需要引号
+        << "'" << Common::trim(student.major) << "', "
+        << "'" << Common::trim(student.dormId) << "', ";
+
+    //手机号空值处理
+    if (trimmedPhone.empty()) {
+        sqlStream << "NULL, ";
+    }
+    else {
+        sqlStream << "'" << trimmedPhone << "', ";
+    }
+    //入住日期转换为字符串（未填写取当天）
+    sqlStream << "'" << Common::dateToString(student.checkInDate.orToday()) << "'"
+        << ")";
+    return sqlStream.str();
+}
+
+//学生的各列值（列名与数据库一致），用于审计日志和变更通知
+static AuditValues studentColumns(const Student& student) {
+    return AuditValues{
+        { "student_name", Common::trim(student.studentName) },
+        { "gender", Common::trim(student.gender) },
+        { "age", std::to_string(student.age) },
+        { "major", Common::trim(student.major) },
+        { "dorm_id", Common::trim(student.dormId) },
+        { "student_phone", Common::trim(student.studentPhone) },
+        { "check_in_date", student.checkInDate.isEmpty() ? std::string() : Common::dateToString(student.checkInDate) }
+    };
+}
+
 //添加学生实现 
 bool StudentManager::addStudent(const Student& student) {
     lastError.clear();
@@ -119,40 +164,21 @@ bool StudentManager::addStudent(const Student& student) {
     }
 
     //检查学号是否已存在
-    Student existStudent = getStudentById(student.studentId);
-    if (!existStudent.studentId.empty()) {
+    if (ExistenceCache::getInstance().isStudentExist(student.studentId)) {
         lastError = "添加失败：学号" + student.studentId + "已存在！";
         return false;
     }
 
     //检查宿舍是否存在
-    if (!isDormExist(Common::trim(student.dormId))) {
+    if (!ExistenceCache::getInstance().isDormExist(Common::trim(student.dormId))) {
         lastError = "添加失败：该生要入住的宿舍不存在！";
         return false;
     }
 
-    //构建INSERT SQL（处理日期和空值）
+    //构建INSERT SQL
     std::ostringstream sqlStream;
-    std::string trimmedPhone = Common::trim(student.studentPhone);
     sqlStream << "INSERT INTO student (student_id, student_name, gender, age, major, dorm_id, student_phone, check_in_date) "
-        << "VALUES ("
-        << "'" << Common::trim(student.studentId) << "', "
-        << "'" << Common::trim(student.studentName) << "', "
-        << "'" << Common::trim(student.gender) << "', "
-        << student.age << ", "  //年龄是数字，不需要引号
-        << "'" << Common::trim(student.major) << "', "
-        << "'" << Common::trim(student.dormId) << "', ";
-
-    //手机号空值处理
-    if (trimmedPhone.empty()) {
-        sqlStream << "NULL, ";
-    }
-    else {
-        sqlStream << "'" << trimmedPhone << "', ";
-    }
-    //入住日期转换为字符串
-    sqlStream << "'" << Common::dateToString(student.checkInDate) << "'"
-        << ")";
+        << "VALUES " << buildInsertValues(student);
 
     //执行SQL
     int affectedRows = DBHelper::getInstance().executeUpdate(sqlStream.str());
@@ -167,6 +193,16 @@ bool StudentManager::addStudent(const Student& student) {
         return false;
     }
 
+    //审计日志和变更通知（入住日期未填写时按实际写入的当天记录）
+    if (affectedRows > 0) {
+        Student written = student;
+        written.checkInDate = student.checkInDate.orToday();
+        ChangeValues columns = studentColumns(written);
+        std::string trimmedId = Common::trim(student.studentId);
+        AuditJournal::getInstance().recordInsert(AuditEntity::STUDENT, trimmedId, columns);
+        ChangeFeed::getInstance().publishInsert(ChangeTable::STUDENT, trimmedId, columns);
+    }
+
     //更新宿舍人数
     if (affectedRows > 0 && dormManager != nullptr) {
         dormManager->updateCurrentCount(student.dormId, 1);
@@ -177,6 +213,117 @@ bool StudentManager::addStudent(const Student& student) {
     return affectedRows >= 0;
 }
 
+//批量添加学生实现（宿舍已分配好）
+bool StudentManager::addStudentsBulk(const std::vector<Student>& students) {
+    lastError.clear();
+    if (students.empty()) return true;
+
+    //1. 学号、姓名、手机号按列批量校验格式；有不合法的行时逐个校验该行，得到具体的错误信息
+    std::vector<StrRef> idColumn, nameColumn, phoneColumn;
+    idColumn.reserve(students.size());
+    nameColumn.reserve(students.size());
+    phoneColumn.reserve(students.size());
+    for (const auto& student : students) {
+        idColumn.push_back(student.studentId);
+        nameColumn.push_back(student.studentName);
+        phoneColumn.push_back(student.studentPhone);
+    }
+    RowBitmap formatValid, columnValid;
+    BatchValidation::validateStudentIds(idColumn.data(), students.size(), formatValid);
+    BatchValidation::validateNames(nameColumn.data(), students.size(), columnValid);
+    BatchValidation::intersect(formatValid, columnValid);
+    BatchValidation::validatePhones(phoneColumn.data(), students.size(), columnValid, true);
+    BatchValidation::intersect(formatValid, columnValid);
+    size_t badRow = BatchValidation::firstInvalid(formatValid, students.size());
+    if (badRow < students.size() && !validateStudent(students[badRow])) {
+        lastError = "学号" + students[badRow].studentId + "：" + lastError;
+        return false;
+    }
+
+    //2. 校验其余字段，并检查学号重复和宿舍存在性
+    ExistenceCache& cache = ExistenceCache::getInstance();
+    std::set<std::string> batchIds;
+    std::map<std::string, int> dormDelta; //宿舍号 → 新增人数
+    for (const auto& student : students) {
+        if (!validateStudent(student, true)) {
+            lastError = "学号" + student.studentId + "：" + lastError;
+            return false;
+        }
+        std::string trimmedId = Common::trim(student.studentId);
+        if (!batchIds.insert(trimmedId).second || cache.isStudentExist(trimmedId)) {
+            lastError = "添加失败：学号" + trimmedId + "已存在！";
+            return false;
+        }
+        std::string trimmedDorm = Common::trim(student.dormId);
+        if (!cache.isDormExist(trimmedDorm)) {
+            lastError = "添加失败：宿舍" + trimmedDorm + "不存在！";
+            return false;
+        }
+        dormDelta[trimmedDorm]++;
+    }
+
+    //3. 在计数表中按宿舍预占床位，任一宿舍容量不足则全部撤销
+    OccupancyTable& occTable = OccupancyTable::getInstance();
+    occTable.ensureLoaded();
+    std::vector<std::pair<std::string, int>> reserved;
+    for (const auto& item : dormDelta) {
+        OccupancyAdjust adjust = occTable.tryAdjust(item.first, item.second);
+        if (adjust == OccupancyAdjust::OVERFLOW || adjust == OccupancyAdjust::UNDERFLOW) {
+            for (const auto& undo : reserved) occTable.forceAdjust(undo.first, -undo.second);
+            lastError = "添加失败：宿舍" + item.first + "剩余床位不足！";
+            return false;
+        }
+        if (adjust == OccupancyAdjust::OK) reserved.push_back(item);
+    }
+
+    //4. 多行INSERT分块写入，每个宿舍只做一次条件UPDATE，整体在一个事务内
+    std::vector<std::string> sqlList;
+    const size_t rowsPerInsert = 500;
+    for (size_t begin = 0; begin < students.size(); begin += rowsPerInsert) {
+        std::ostringstream sqlStream;
+        sqlStream << "INSERT INTO student (student_id, student_name, gender, age, major, dorm_id, student_phone, check_in_date) VALUES ";
+        size_t end = std::min(students.size(), begin + rowsPerInsert);
+        for (size_t i = begin; i < end; ++i) {
+            if (i > begin) sqlStream << ", ";
+            sqlStream << buildInsertValues(students[i]);
+        }
+        sqlList.push_back(sqlStream.str());
+    }
+    for (const auto& item : dormDelta) {
+        std::ostringstream sqlStream;
+        sqlStream << "UPDATE dorm SET current_occupancy = current_occupancy + " << item.second
+            << " WHERE dorm_id = '" << item.first << "'"
+            << " AND current_occupancy + " << item.second << " <= max_capacity";
+        sqlList.push_back(sqlStream.str());
+    }
+
+    int affectedRows = DBHelper::getInstance().executeBatch(sqlList, true);
+    FreeBedIndex& freeBeds = FreeBedIndex::getInstance();
+    if (affectedRows == -1) {
+        for (const auto& undo : reserved) occTable.forceAdjust(undo.first, -undo.second);
+        for (const auto& item : dormDelta) freeBeds.refresh(item.first);
+        DBErrorInfo dbErr = DBHelper::getInstance().getLastError();
+        lastError = "批量添加失败：" + dbErr.errorMsg;
+        return false;
+    }
+
+    //5. 审计日志，整批发布变更通知
+    AuditJournal& audit = AuditJournal::getInstance();
+    std::vector<ChangeEvent> events;
+    events.reserve(students.size());
+    for (const auto& student : students) {
+        Student written = student;
+        written.checkInDate = student.checkInDate.orToday();
+        ChangeValues columns = studentColumns(written);
+        std::string trimmedId = Common::trim(student.studentId);
+        audit.recordInsert(AuditEntity::STUDENT, trimmedId, columns);
+        events.push_back(ChangeFeed::makeInsert(ChangeTable::STUDENT, trimmedId, columns));
+    }
+    ChangeFeed::getInstance().publish(events);
+    for (const auto& item : dormDelta) freeBeds.refresh(item.first);
+    return true;
+}
+
 //修改学生信息实现 
 bool StudentManager::updateStudent(const Student& student) {
     lastError.clear();
@@ -194,7 +341,7 @@ bool StudentManager::updateStudent(const Student& student) {
     }
 
     //检查宿舍是否存在
-    if (!isDormExist(Common::trim(student.dormId))) {
+    if (!ExistenceCache::getInstance().isDormExist(Common::trim(student.dormId))) {
         lastError = "修改失败：该生要入住的宿舍不存在！";
         return false;
     }
@@ -234,6 +381,14 @@ bool StudentManager::updateStudent(const Student& student) {
         return false;
     }
 
+    //审计日志和变更通知
+    if (affectedRows > 0) {
+        ChangeValues before = studentColumns(existStudent);
+        ChangeValues after = studentColumns(student);
+        AuditJournal::getInstance().recordUpdate(AuditEntity::STUDENT, existStudent.studentId, before, after);
+        ChangeFeed::getInstance().publishUpdate(ChangeTable::STUDENT, existStudent.studentId, before, after);
+    }
+
     //更新宿舍人数（如果宿舍号发生变化）
     if (affectedRows > 0 && dormManager != nullptr && existStudent.dormId != student.dormId) {
         dormManager->updateCurrentCount(existStudent.dormId, -1);  //原宿舍人数减1
@@ -279,6 +434,13 @@ bool StudentManager::deleteStudent(const std::string& studentId) {
         return false;
     }
 
+    //审计日志和变更通知
+    if (affectedRows > 0) {
+        ChangeValues columns = studentColumns(existStudent);
+        AuditJournal::getInstance().recordRemove(AuditEntity::STUDENT, trimmedId, columns);
+        ChangeFeed::getInstance().publishRemove(ChangeTable::STUDENT, trimmedId, columns);
+    }
+
     //更新宿舍人数
     if (affectedRows > 0 && dormManager != nullptr) {
         dormManager->updateCurrentCount(existStudent.dormId, -1);
@@ -459,18 +621,4 @@ std::string StudentManager::getLastError() const {
 
 void StudentManager::setDormManager(DormManager* dormMgr) {
     dormManager = dormMgr;
-}
-
-//校验宿舍号是否存在 
-bool StudentManager::isDormExist(const std::string& dormId) {
-    std::string trimmedId = Common::trim(dormId);
-    if (trimmedId.empty()) return false;
-
-    std::string sql = "SELECT dorm_id FROM dorm WHERE dorm_id = '" + trimmedId + "' LIMIT 1";
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) return false;
-
-    bool exist = result->rowCount > 0;
-    DBHelper::getInstance().freeResultset(result);
-    return exist;
 }
\ No newline at end of file
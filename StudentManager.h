@@ -21,7 +21,7 @@ struct Student {
     Date checkInDate;           // 入住日期
     std::string studentPhone;   // 手机号
 
-    // 默认构造函数 - 需要初始化checkInDate
+    // 默认构造函数 - checkInDate为空日期（写入时取当天）
     Student() : studentId(""), studentName(""), gender(""), age(0), 
                 major(""), dormId(""), checkInDate(), studentPhone("") {}
     
@@ -63,21 +63,24 @@ public:
     // 9. 获取最后一次操作错误信息
     std::string getLastError() const;
 
-    // 10. 设置DormManager实例指针（用于更新宿舍人数）
+    // 10. 批量添加已分配宿舍的学生（一个事务内多行INSERT，每个宿舍只更新一次人数）
+    bool addStudentsBulk(const std::vector<Student>& students);
+
+    // 11. 设置DormManager实例指针（用于更新宿舍人数）
     static void setDormManager(DormManager* dormMgr);
 
 private:
     std::string lastError; // 存储最后一次操作错误描述
     static DormManager* dormManager; // 静态DormManager指针
 
-    // 私有辅助函数：校验学生数据合法性
-    bool validateStudent(const Student& student);
+    // 私有辅助函数：校验学生数据合法性（formatChecked为true时跳过已批量校验过的学号/姓名/手机号格式）
+    bool validateStudent(const Student& student, bool formatChecked = false);
+
+    // 私有辅助函数：构建INSERT的一组VALUES
+    std::string buildInsertValues(const Student& student);
 
     // 私有辅助函数：将查询结果行转换为Student对象
     Student rowToStudent(const std::map<std::string, std::string>& row);
-
-    // 私有辅助函数：校验宿舍号是否存在
-    bool isDormExist(const std::string& dormId);
 };
 
 #endif // STUDENTMANAGER_H
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "TableRender.h"
+#include "Common.h"
+#include <sstream>
+#include <iomanip>
+
+//表格文字样式
+static const uint32_t TEXT_COLOR = 0x000000;
+static const int TEXT_SIZE = 20;
+
+//逐列写入一行的辅助类
+class RowWriter {
+public:
+    RowWriter(RenderList& list, const TableLayout& layout, int row, int colCount)
+        : list(list), x(layout.left), y(layout.top + row * layout.rowHeight), colWidth(layout.width / colCount) {
+        list.beginRegion(row, layout.left, y, colWidth * colCount, layout.rowHeight);
+    }
+    ~RowWriter() { list.endRegion(); }
+
+    void cell(const std::string& text) {
+        list.text(x + 5, y + 5, text, TEXT_COLOR, TEXT_SIZE);
+        x += colWidth;
+    }
+
+private:
+    RenderList& list;
+    int x;
+    int y;
+    int colWidth;
+};
+
+static std::string formatMoney(double value) {
+    std::stringstream stream;
+    stream << std::fixed << std::setprecision(2) << value;
+    return stream.str();
+}
+
+void buildStudentRows(RenderList& list, const TableLayout& layout, const std::vector<Student>& students) {
+    int row = 0;
+    for (const auto& s : students) {
+        RowWriter writer(list, layout, row++, 8);
+        writer.cell(s.studentId);
+        writer.cell(s.studentName);
+        writer.cell(s.gender);
+        writer.cell(std::to_string(s.age));
+        writer.cell(s.major);
+        writer.cell(s.dormId);
+        writer.cell(s.studentPhone);
+        writer.cell(Common::dateToString(s.checkInDate));
+    }
+}
+
+void buildDormRows(RenderList& list, const TableLayout& layout, const std::vector<Dorm>& dorms) {
+    int row = 0;
+    for (const auto& d : dorms) {
+        RowWriter writer(list, layout, row++, 6);
+        writer.cell(d.dormId);
+        writer.cell(d.building);
+        writer.cell(d.roomType);
+        writer.cell(std::to_string(d.maxCapacity));
+        writer.cell(std::to_string(d.currentOccupancy));
+        writer.cell(d.dormManager);
+    }
+}
+
+void buildFeeRows(RenderList& list, const TableLayout& layout, const std::vector<Fee>& fees) {
+    int row = 0;
+    for (const auto& f : fees) {
+        RowWriter writer(list, layout, row++, 9);
+        writer.cell(f.feeId);
+        writer.cell(f.studentId);
+        writer.cell(f.dormId);
+        writer.cell(f.feeMonth);
+        writer.cell(formatMoney(f.waterFee));
+        writer.cell(formatMoney(f.electricFee));
+        writer.cell(formatMoney(f.totalFee));
+        writer.cell((f.payStatus == PayStatus::PAID) ? "已付" : "未付");
+        //未付状态时支付日期为空，已付状态时显示支付日期
+        writer.cell((f.payStatus == PayStatus::PAID) ? Common::dateToString(f.payDate) : "");
+    }
+}
+
+void buildRepairRows(RenderList& list, const TableLayout& layout, const std::vector<Repair>& repairs) {
+    int row = 0;
+    for (const auto& r : repairs) {
+        RowWriter writer(list, layout, row++, 7);
+        writer.cell(r.repairId);
+        writer.cell(r.studentId);
+        writer.cell(r.dormId);
+        writer.cell(r.repairContent);
+        writer.cell(Common::dateToString(r.repairDate));
+
+        std::string statusStr;
+        if (r.handleStatus == RepairStatus::UNHANDLED) statusStr = "未处理";
+        else if (r.handleStatus == RepairStatus::HANDLING) statusStr = "处理中";
+        else statusStr = "已完成";
+        writer.cell(statusStr);
+
+        //未处理显示"未处理"，否则显示处理日期（0-0-0表示未设置）
+        std::string handleDateStr;
+        if (r.handleStatus == RepairStatus::UNHANDLED) {
+            handleDateStr = "未处理";
+        } else if (!r.handleDate.isEmpty()) {
+            handleDateStr = Common::dateToString(r.handleDate);
+        } else {
+            handleDateStr = "未设置";
+        }
+        writer.cell(handleDateStr);
+    }
+}
+
+void buildVisitorRows(RenderList& list, const TableLayout& layout, const std::vector<Visitor>& visitors) {
+    int row = 0;
+    for (const auto& v : visitors) {
+        RowWriter writer(list, layout, row++, 9);
+        writer.cell(v.visitorId);
+        writer.cell(v.visitorName);
+        writer.cell(v.gender);
+        writer.cell("***");
+        writer.cell(v.dormId);
+        writer.cell(v.visitReason);
+        writer.cell(v.visitTime.length() >= 16 ? v.visitTime.substr(11, 5) : v.visitTime);
+        writer.cell(v.leaveTime.length() >= 16 ? v.leaveTime.substr(11, 5) : "未离开");
+        writer.cell(v.registerAdmin);
+    }
+}
+
+void buildPageInfo(RenderList& list, const TableLayout& layout, const PageParam& pageParam, bool loading) {
+    //位于上一页/下一页按钮之间
+    int x = layout.windowW / 2 - 50;
+    list.beginRegion(PAGE_INFO_REGION, x - 8, layout.windowH - 92, 158, 56);
+    if (loading) {
+        list.text(x, layout.windowH - 90, "加载中...", 0x0066CC, TEXT_SIZE);
+    }
+    std::string pageInfo = "第 " + std::to_string(pageParam.pageIndex) + " / " + std::to_string(pageParam.totalPage) + " 页";
+    list.text(x, layout.windowH - 60, pageInfo, TEXT_COLOR, TEXT_SIZE);
+    list.endRegion();
+}
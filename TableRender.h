@@ -0,0 +1,39 @@
+#ifndef TABLERENDER_H
+#define TABLERENDER_H
+
+#include "RenderCommands.h"
+#include "StudentManager.h"
+#include "DormManager.h"
+#include "FeeManager.h"
+#include "RepairManager.h"
+#include "VisitorManager.h"
+#include <vector>
+
+// 页码区域的编号（表格行的区域编号为行号）
+const int PAGE_INFO_REGION = 1000;
+
+// 管理界面表格布局
+struct TableLayout {
+    int left;        // 表格左边
+    int top;         // 第一行数据的上边（表头之下）
+    int width;       // 表格总宽
+    int rowHeight;   // 行高
+    int windowW;     // 窗口宽，用于定位页码
+    int windowH;     // 窗口高
+
+    TableLayout(int left, int top, int width, int rowHeight, int windowW, int windowH)
+        : left(left), top(top), width(width), rowHeight(rowHeight), windowW(windowW), windowH(windowH) {}
+};
+
+// --------------- 管理界面表格的命令生成 ---------------
+// 每行生成一个区域，数据刷新时与上一帧比较只重绘变化的行；不依赖窗口库，可无界面测量。
+void buildStudentRows(RenderList& list, const TableLayout& layout, const std::vector<Student>& students);
+void buildDormRows(RenderList& list, const TableLayout& layout, const std::vector<Dorm>& dorms);
+void buildFeeRows(RenderList& list, const TableLayout& layout, const std::vector<Fee>& fees);
+void buildRepairRows(RenderList& list, const TableLayout& layout, const std::vector<Repair>& repairs);
+void buildVisitorRows(RenderList& list, const TableLayout& layout, const std::vector<Visitor>& visitors);
+
+// 页码和加载状态
+void buildPageInfo(RenderList& list, const TableLayout& layout, const PageParam& pageParam, bool loading);
+
+#endif // TABLERENDER_H
@@ -0,0 +1,331 @@
+#include "Transcode.h"
+#include <mutex>
+#include <cstring>
+#include <cctype>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSCODE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#include "GbkTable.inc"
+
+static const unsigned GBK_LEAD_FIRST = 0x81;
+static const unsigned GBK_TRAIL_FIRST = 0x40;
+static const unsigned GBK_TRAIL_COUNT = 191;
+
+//Unicode(BMP) → GBK，首次使用时由正向表构建，0表示无对应字符
+static uint16_t g_unicodeToGbk[65536];
+static std::once_flag g_reverseOnce;
+
+static const uint16_t* reverseTable() {
+    std::call_once(g_reverseOnce, []() {
+        for (unsigned i = 0; i < sizeof(GBK_TO_UNICODE) / sizeof(GBK_TO_UNICODE[0]); ++i) {
+            uint16_t code = GBK_TO_UNICODE[i];
+            if (code == 0) continue;
+            unsigned lead = GBK_LEAD_FIRST + i / GBK_TRAIL_COUNT;
+            unsigned trail = GBK_TRAIL_FIRST + i % GBK_TRAIL_COUNT;
+            g_unicodeToGbk[code] = static_cast<uint16_t>((lead << 8) | trail);
+        }
+    });
+    return g_unicodeToGbk;
+}
+
+//查正向表，不在表范围内返回0
+static inline uint32_t lookupGbk(unsigned lead, unsigned trail) {
+    if (lead < GBK_LEAD_FIRST || lead > 0xFE || trail < GBK_TRAIL_FIRST || trail > 0xFE) return 0;
+    return GBK_TO_UNICODE[(lead - GBK_LEAD_FIRST) * GBK_TRAIL_COUNT + (trail - GBK_TRAIL_FIRST)];
+}
+
+//UTF-8首字节对应的字符长度，非法首字节返回1
+static inline size_t utf8Length(unsigned char lead) {
+    if (lead >= 0xC2 && lead <= 0xDF) return 2;
+    if (lead >= 0xE0 && lead <= 0xEF) return 3;
+    if (lead >= 0xF0 && lead <= 0xF4) return 4;
+    return 1;
+}
+
+static inline char* putUtf8(char* out, uint32_t code) {
+    if (code < 0x800) {
+        *out++ = static_cast<char>(0xC0 | (code >> 6));
+        *out++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else {
+        *out++ = static_cast<char>(0xE0 | (code >> 12));
+        *out++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        *out++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+    return out;
+}
+
+//GBK → UTF-8；final为false时末尾被截断的字符不转换，consumed返回已转换的输入字节数
+static size_t gbkToUtf8Impl(const char* data, size_t len, std::string& out, bool final, size_t& consumed) {
+    //每2字节最多变为3字节，单字节不变
+    size_t base = out.size();
+    out.resize(base + len + len / 2 + 1);
+    char* dest = &out[base];
+    size_t replaced = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        size_t run = Transcode::asciiPrefix(data + pos, len - pos);
+        if (run > 0) {
+            std::memcpy(dest, data + pos, run);
+            dest += run;
+            pos += run;
+            if (pos >= len) break;
+        }
+
+        unsigned lead = static_cast<unsigned char>(data[pos]);
+        if (pos + 1 >= len) {
+            if (!final && lead >= GBK_LEAD_FIRST && lead <= 0xFE) break;
+            *dest++ = '?';
+            ++replaced;
+            ++pos;
+            continue;
+        }
+        unsigned trail = static_cast<unsigned char>(data[pos + 1]);
+        uint32_t code = lookupGbk(lead, trail);
+        if (code != 0) {
+            dest = putUtf8(dest, code);
+            pos += 2;
+        }
+        else {
+            //次字节在合法范围内（如自定义区）按一个字符替换，否则只跳过首字节
+            *dest++ = '?';
+            ++replaced;
+            pos += (lead >= GBK_LEAD_FIRST && lead <= 0xFE && trail >= GBK_TRAIL_FIRST && trail <= 0xFE && trail != 0x7F) ? 2 : 1;
+        }
+    }
+    out.resize(static_cast<size_t>(dest - out.data()));
+    consumed = pos;
+    return replaced;
+}
+
+//UTF-8 → GBK；final为false时末尾被截断的字符不转换
+static size_t utf8ToGbkImpl(const char* data, size_t len, std::string& out, bool final, size_t& consumed) {
+    //输出不会比输入长
+    const uint16_t* reverse = reverseTable();
+    size_t base = out.size();
+    out.resize(base + len);
+    char* dest = &out[base];
+    size_t replaced = 0;
+    size_t pos = 0;
+    while (pos < len) {
+        size_t run = Transcode::asciiPrefix(data + pos, len - pos);
+        if (run > 0) {
+            std::memcpy(dest, data + pos, run);
+            dest += run;
+            pos += run;
+            if (pos >= len) break;
+        }
+
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data + pos);
+        size_t need = utf8Length(p[0]);
+        size_t avail = len - pos;
+        size_t valid = 1;
+        while (valid < need && valid < avail && (p[valid] & 0xC0) == 0x80) ++valid;
+        if (valid < need) {
+            //后续字节都是延续字节，只是被截断
+            if (!final && valid == avail) break;
+            *dest++ = '?';
+            ++replaced;
+            ++pos;
+            continue;
+        }
+
+        uint32_t code;
+        bool ok;
+        if (need == 2) {
+            code = ((p[0] & 0x1Fu) << 6) | (p[1] & 0x3Fu);
+            ok = true;
+        }
+        else if (need == 3) {
+            code = ((p[0] & 0x0Fu) << 12) | ((p[1] & 0x3Fu) << 6) | (p[2] & 0x3Fu);
+            ok = code >= 0x800 && (code < 0xD800 || code > 0xDFFF);
+        }
+        else if (need == 4) {
+            code = ((p[0] & 0x07u) << 18) | ((p[1] & 0x3Fu) << 12) | ((p[2] & 0x3Fu) << 6) | (p[3] & 0x3Fu);
+            ok = code >= 0x10000 && code <= 0x10FFFF;
+        }
+        else {
+            code = 0;
+            ok = false;
+        }
+        if (!ok) {
+            *dest++ = '?';
+            ++replaced;
+            ++pos;
+            continue;
+        }
+
+        uint16_t gbk = code < 0x10000 ? reverse[code] : 0;
+        if (gbk != 0) {
+            *dest++ = static_cast<char>(gbk >> 8);
+            *dest++ = static_cast<char>(gbk & 0xFF);
+        }
+        else {
+            *dest++ = '?';
+            ++replaced;
+        }
+        pos += need;
+    }
+    out.resize(static_cast<size_t>(dest - out.data()));
+    consumed = pos;
+    return replaced;
+}
+
+size_t Transcode::asciiPrefix(const char* data, size_t len) {
+    size_t i = 0;
+#ifdef TRANSCODE_SSE2
+    for (; i + 16 <= len; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+        if (mask != 0) {
+            while ((mask & 1) == 0) {
+                mask >>= 1;
+                ++i;
+            }
+            return i;
+        }
+    }
+#endif
+    while (i < len && static_cast<unsigned char>(data[i]) < 0x80) ++i;
+    return i;
+}
+
+size_t Transcode::gbkToUtf8(const char* data, size_t len, std::string& out) {
+    size_t consumed = 0;
+    return gbkToUtf8Impl(data, len, out, true, consumed);
+}
+
+size_t Transcode::utf8ToGbk(const char* data, size_t len, std::string& out) {
+    size_t consumed = 0;
+    return utf8ToGbkImpl(data, len, out, true, consumed);
+}
+
+std::string Transcode::gbkToUtf8(const std::string& str) {
+    if (asciiPrefix(str.data(), str.size()) == str.size()) return str;
+    std::string out;
+    gbkToUtf8(str.data(), str.size(), out);
+    return out;
+}
+
+std::string Transcode::utf8ToGbk(const std::string& str) {
+    if (asciiPrefix(str.data(), str.size()) == str.size()) return str;
+    std::string out;
+    utf8ToGbk(str.data(), str.size(), out);
+    return out;
+}
+
+size_t Transcode::convert(TextEncoding from, TextEncoding to, const char* data, size_t len, std::string& out) {
+    if (from == to) {
+        out.append(data, len);
+        return 0;
+    }
+    return from == TextEncoding::GBK ? gbkToUtf8(data, len, out) : utf8ToGbk(data, len, out);
+}
+
+uint32_t Transcode::decodeGbkChar(const char* data, size_t len, size_t& pos) {
+    if (pos >= len) return 0;
+    unsigned lead = static_cast<unsigned char>(data[pos]);
+    if (lead < 0x80) {
+        ++pos;
+        return lead;
+    }
+    if (pos + 1 < len) {
+        uint32_t code = lookupGbk(lead, static_cast<unsigned char>(data[pos + 1]));
+        if (code != 0) {
+            pos += 2;
+            return code;
+        }
+    }
+    ++pos;
+    return 0;
+}
+
+bool Transcode::isUtf8Charset(const std::string& charset) {
+    std::string lower;
+    for (char c : charset) lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return lower == "utf8" || lower == "utf8mb3" || lower == "utf8mb4" || lower == "utf-8";
+}
+
+TranscodeStream::TranscodeStream(TextEncoding from, TextEncoding to)
+    : from(from), to(to), pendingLen(0), replaced(0) {
+}
+
+size_t TranscodeStream::pendingCharLength() const {
+    if (pendingLen == 0) return 0;
+    return from == TextEncoding::GBK ? 2 : utf8Length(static_cast<unsigned char>(pending[0]));
+}
+
+void TranscodeStream::feed(const char* data, size_t len, std::string& out) {
+    if (from == to) {
+        out.append(data, len);
+        return;
+    }
+
+    //先补全上一块留下的字符
+    if (pendingLen > 0) {
+        size_t need = pendingCharLength();
+        while (pendingLen < need && len > 0) {
+            pending[pendingLen++] = *data++;
+            --len;
+        }
+        if (pendingLen < need) return;
+        size_t consumed = 0;
+        replaced += (from == TextEncoding::GBK)
+            ? gbkToUtf8Impl(pending, pendingLen, out, true, consumed)
+            : utf8ToGbkImpl(pending, pendingLen, out, true, consumed);
+        pendingLen = 0;
+    }
+
+    size_t consumed = 0;
+    replaced += (from == TextEncoding::GBK)
+        ? gbkToUtf8Impl(data, len, out, false, consumed)
+        : utf8ToGbkImpl(data, len, out, false, consumed);
+    for (size_t i = consumed; i < len; ++i) pending[pendingLen++] = data[i];
+}
+
+void TranscodeStream::finish(std::string& out) {
+    if (pendingLen == 0) return;
+    size_t consumed = 0;
+    replaced += (from == TextEncoding::GBK)
+        ? gbkToUtf8Impl(pending, pendingLen, out, true, consumed)
+        : utf8ToGbkImpl(pending, pendingLen, out, true, consumed);
+    pendingLen = 0;
+}
+
+TranscodeWriter::TranscodeWriter(std::ostream& os, TextEncoding target, size_t bufferSize)
+    : os(os), target(target), stream(TextEncoding::GBK, target), bufferSize(bufferSize > 0 ? bufferSize : 1) {
+    buffer.reserve(this->bufferSize);
+}
+
+TranscodeWriter::~TranscodeWriter() {
+    flush();
+    converted.clear();
+    stream.finish(converted);
+    if (!converted.empty()) os.write(converted.data(), static_cast<std::streamsize>(converted.size()));
+}
+
+TranscodeWriter& TranscodeWriter::write(const char* data, size_t len) {
+    buffer.append(data, len);
+    if (buffer.size() >= bufferSize) flush();
+    return *this;
+}
+
+TranscodeWriter& TranscodeWriter::operator<<(const char* str) {
+    return str ? write(str, std::strlen(str)) : *this;
+}
+
+void TranscodeWriter::flush() {
+    if (buffer.empty()) return;
+    converted.clear();
+    stream.feed(buffer.data(), buffer.size(), converted);
+    os.write(converted.data(), static_cast<std::streamsize>(converted.size()));
+    buffer.clear();
+}
+
+void TranscodeWriter::writeBom() {
+    if (target != TextEncoding::UTF8) return;
+    flush();
+    os.write("\xEF\xBB\xBF", 3);
+}
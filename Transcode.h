@@ -0,0 +1,104 @@
+#ifndef TRANSCODE_H
+#define TRANSCODE_H
+
+#include <string>
+#include <ostream>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+// 文本编码
+enum class TextEncoding {
+    GBK = 0,    // GBK（兼容GB2312），程序内部和界面使用
+    UTF8        // UTF-8
+};
+
+// --------------- GBK与UTF-8互转 ---------------
+// 查表转换（GbkTable.inc由GenGbkTable.py生成），连续ASCII段用SSE2每次检查16字节后整段复制；
+// 非法字节或目标编码中不存在的字符输出为'?'，返回值为被替换的字符数。
+namespace Transcode {
+    // 从data开始连续ASCII字节（<0x80）的长度
+    size_t asciiPrefix(const char* data, size_t len);
+
+    // 转换结果追加到out
+    size_t gbkToUtf8(const char* data, size_t len, std::string& out);
+    size_t utf8ToGbk(const char* data, size_t len, std::string& out);
+
+    // 整串转换
+    std::string gbkToUtf8(const std::string& str);
+    std::string utf8ToGbk(const std::string& str);
+
+    // 按编码转换，from与to相同时原样追加
+    size_t convert(TextEncoding from, TextEncoding to, const char* data, size_t len, std::string& out);
+
+    // 解码pos处的一个GBK字符为Unicode码点并前移pos；非法字节返回0并前移1字节
+    uint32_t decodeGbkChar(const char* data, size_t len, size_t& pos);
+
+    // MySQL字符集名是否为UTF-8（utf8/utf8mb3/utf8mb4，不区分大小写）
+    bool isUtf8Charset(const std::string& charset);
+}
+
+// --------------- 流式转换 ---------------
+// 输入按任意大小分块送入，块末尾被截断的多字节字符保留到下一块再转换。
+class TranscodeStream {
+public:
+    TranscodeStream(TextEncoding from, TextEncoding to);
+
+    // 转换一块输入，结果追加到out
+    void feed(const char* data, size_t len, std::string& out);
+
+    // 输入结束，残留的不完整字符输出为'?'
+    void finish(std::string& out);
+
+    size_t getReplacedCount() const { return replaced; }
+
+private:
+    TextEncoding from;
+    TextEncoding to;
+    char pending[4];        // 上一块末尾不完整的字符
+    size_t pendingLen;
+    size_t replaced;
+
+    // 不完整字符还需要的总字节数
+    size_t pendingCharLength() const;
+};
+
+// --------------- 转码输出 ---------------
+// 按程序内部编码（GBK）写入，缓冲区满时整块转换为目标编码写到输出流；析构时自动flush。
+class TranscodeWriter {
+public:
+    TranscodeWriter(std::ostream& os, TextEncoding target, size_t bufferSize = 64 * 1024);
+    ~TranscodeWriter();
+
+    TranscodeWriter& write(const char* data, size_t len);
+    TranscodeWriter& operator<<(const std::string& str) { return write(str.data(), str.size()); }
+    TranscodeWriter& operator<<(const char* str);
+    TranscodeWriter& operator<<(char c) { return write(&c, 1); }
+
+    // 数值按std::to_string格式写入
+    template <typename T>
+    typename std::enable_if<std::is_arithmetic<T>::value, TranscodeWriter&>::type operator<<(T value) {
+        return (*this) << std::to_string(value);
+    }
+
+    // 转换并写出缓冲区内容
+    void flush();
+
+    // 写出UTF-8 BOM（目标为UTF-8时有效，便于Excel识别编码）
+    void writeBom();
+
+    size_t getReplacedCount() const { return stream.getReplacedCount(); }
+
+private:
+    std::ostream& os;
+    TextEncoding target;
+    TranscodeStream stream;
+    size_t bufferSize;
+    std::string buffer;       // 待转换的内部编码文本
+    std::string converted;    // 转换结果（复用）
+
+    TranscodeWriter(const TranscodeWriter&) = delete;
+    TranscodeWriter& operator=(const TranscodeWriter&) = delete;
+};
+
+#endif // TRANSCODE_H
@@ -0,0 +1,71 @@
+#include "ViewModel.h"
+
+ViewModel& ViewModel::getInstance() {
+    static ViewModel instance;
+    return instance;
+}
+
+uint64_t ViewModel::post(ViewWork work) {
+    start();
+    Request request;
+    request.id = nextRequestId;
+    request.work = std::move(work);
+    if (!requests.push(std::move(request))) return 0;
+    nextRequestId++;
+    pendingCount.fetch_add(1);
+
+    //加锁只为避免工作线程错过唤醒
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeup.notify_one();
+    return nextRequestId - 1;
+}
+
+int ViewModel::pollResults(int maxCount) {
+    int handled = 0;
+    Result result;
+    while (handled < maxCount && results.pop(result)) {
+        pendingCount.fetch_sub(1);
+        if (result.apply) result.apply();
+        result.apply = nullptr;
+        handled++;
+    }
+    return handled;
+}
+
+void ViewModel::start() {
+    if (running.load()) return;
+    running.store(true);
+    worker = std::thread(&ViewModel::run, this);
+}
+
+void ViewModel::stop() {
+    if (!running.exchange(false)) return;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeup.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void ViewModel::run() {
+    while (running.load()) {
+        Request request;
+        if (!requests.pop(request)) {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wakeup.wait(lock, [this] { return !running.load() || !requests.empty(); });
+            continue;
+        }
+
+        Result result;
+        result.id = request.id;
+        result.apply = request.work ? request.work() : ViewApply();
+
+        //信箱满时等待界面线程取走
+        while (!results.push(std::move(result))) {
+            if (!running.load()) return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
@@ -0,0 +1,180 @@
+#ifndef VIEWMODEL_H
+#define VIEWMODEL_H
+
+#include "Common.h"
+#include "PageCache.h"
+#include <string>
+#include <vector>
+#include <array>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+
+// --------------- 单生产者单消费者无锁环形队列 ---------------
+// 容量N必须是2的幂；push只能由一个线程调用，pop只能由另一个线程调用。
+template <typename T, size_t N>
+class SpscQueue {
+    static_assert((N & (N - 1)) == 0, "SpscQueue容量必须是2的幂");
+
+public:
+    SpscQueue() : head(0), tail(0) {}
+
+    // 队列满返回false
+    bool push(T&& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N) return false;
+        slots[t & (N - 1)] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 队列空返回false
+    bool pop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) return false;
+        item = std::move(slots[h & (N - 1)]);
+        slots[h & (N - 1)] = T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    std::array<T, N> slots;
+    std::atomic<size_t> head;   // 消费者位置
+    std::atomic<size_t> tail;   // 生产者位置
+};
+
+// 在工作线程执行的任务，返回在界面线程执行的收尾操作（可为空）
+typedef std::function<void()> ViewApply;
+typedef std::function<ViewApply()> ViewWork;
+
+// --------------- 界面视图模型（单例）---------------
+// 界面线程把管理类调用封装为任务投递到请求队列，由工作线程执行；
+// 执行结果（收尾操作）放入结果信箱，界面线程每帧pollResults取出并执行，
+// 期间isLoading为true，界面显示加载状态。不依赖任何窗口库，可在Linux下无界面测试。
+// post和pollResults只能在同一个（界面）线程调用。
+class ViewModel {
+public:
+    static ViewModel& getInstance();
+
+    // 投递任务，返回请求号；请求队列已满返回0
+    uint64_t post(ViewWork work);
+
+    // 执行信箱中已完成请求的收尾操作，返回处理的个数
+    int pollResults(int maxCount = 16);
+
+    // 是否有已投递但尚未取回结果的请求
+    bool isLoading() const { return pendingCount.load() > 0; }
+
+    // 启动/停止工作线程（post时会自动启动）
+    void start();
+    void stop();
+
+private:
+    ViewModel() : nextRequestId(1), pendingCount(0), running(false) {}
+    ViewModel(const ViewModel&) = delete;
+    ViewModel& operator=(const ViewModel&) = delete;
+    ~ViewModel() { stop(); }
+
+    struct Request {
+        uint64_t id;
+        ViewWork work;
+        Request() : id(0) {}
+    };
+
+    struct Result {
+        uint64_t id;
+        ViewApply apply;
+        Result() : id(0) {}
+    };
+
+    SpscQueue<Request, 64> requests;   // 界面线程 → 工作线程
+    SpscQueue<Result, 64> results;     // 工作线程 → 界面线程
+    uint64_t nextRequestId;
+    std::atomic<int> pendingCount;
+
+    std::mutex wakeMutex;              // 仅用于工作线程休眠，不保护队列
+    std::condition_variable wakeup;
+    std::thread worker;
+    std::atomic<bool> running;
+
+    void run();
+};
+
+// --------------- 列表界面视图模型 ---------------
+// 持有某个管理界面当前显示的一页数据；页码、过滤条件或缓存版本变化时通过ViewModel
+// 在工作线程经PageCache加载，加载完成前继续显示旧数据。只在界面线程访问。
+template <typename T>
+class ListViewModel {
+public:
+    explicit ListViewModel(PageCache<T>& cache)
+        : cache(cache), totalCount(0), pageIndex(1), hasData(false), waiting(false), requestSerial(0),
+          requestedVersion(0), loadedVersion(0), requestedPage(0), loadedPage(0), loadedAlias(0) {}
+
+    // 请求显示指定页（与已请求或已加载的相同时不重复投递）
+    void request(const std::string& filter, const PageParam& pageParam) {
+        uint64_t version = PageCacheVersion::get(cache.getScreen());
+        if (hasData && filter == loadedFilter && version == loadedVersion
+            && (pageParam.pageIndex == loadedPage || pageParam.pageIndex == loadedAlias)) return;
+        if (waiting && filter == requestedFilter && pageParam.pageIndex == requestedPage && version == requestedVersion) return;
+
+        PageCache<T>* target = &cache;
+        std::string key = filter;
+        PageParam page = pageParam;
+        uint64_t serial = requestSerial + 1;
+        ListViewModel<T>* self = this;
+        bool posted = ViewModel::getInstance().post([target, key, page, version, serial, self]() -> ViewApply {
+            PageParam loadedParam = page;
+            std::shared_ptr<std::vector<T>> rows = std::make_shared<std::vector<T>>(target->getPage(key, loadedParam));
+            return [self, rows, key, page, loadedParam, version, serial]() {
+                //只接受最近一次请求的结果
+                if (serial != self->requestSerial) return;
+                self->rows.swap(*rows);
+                self->totalCount = loadedParam.totalCount;
+                self->pageIndex = loadedParam.pageIndex;
+                self->loadedFilter = key;
+                self->loadedPage = loadedParam.pageIndex;
+                self->loadedAlias = page.pageIndex;     //页码超出范围被修正时，原请求页也视为已加载
+                self->loadedVersion = version;
+                self->hasData = true;
+                self->waiting = false;
+            };
+        }) != 0;
+        if (!posted) return;
+        requestSerial = serial;
+        waiting = true;
+        requestedFilter = filter;
+        requestedPage = pageParam.pageIndex;
+        requestedVersion = version;
+    }
+
+    const std::vector<T>& getRows() const { return rows; }
+    int getTotalCount() const { return totalCount; }
+    int getPageIndex() const { return pageIndex; }
+
+    // 已投递请求尚未返回
+    bool isLoading() const { return waiting; }
+
+private:
+    PageCache<T>& cache;
+    std::vector<T> rows;
+    int totalCount;
+    int pageIndex;
+    bool hasData;
+    bool waiting;
+    uint64_t requestSerial;
+
+    std::string requestedFilter, loadedFilter;
+    uint64_t requestedVersion, loadedVersion;
+    int requestedPage, loadedPage, loadedAlias;
+};
+
+#endif // VIEWMODEL_H
@@ -1,6 +1,13 @@
 #include "VisitorManager.h"
 #include "Common.h"
 #include "DBHelper.h"
+#include "ExistenceCache.h"
+#include "IdAllocator.h"
+#include "VisitorRegistry.h"
+#include "VisitorTimeIndex.h"
+#include "VisitorProfileIndex.h"
+#include "AuditJournal.h"
+#include "ChangeFeed.h"
 #include <sstream>
 #include <algorithm>
 #include <iomanip>
@@ -48,6 +55,13 @@ bool VisitorManager::validateVisitor(const Visitor& visitor, bool isAdd) {
         lastError = "身份证号格式错误（需18位，支持最后一位X）！";
         return false;
     }
+    //黑名单在内存中筛查，无需访问数据库
+    std::string blacklistReason;
+    if (isAdd && VisitorProfileIndex::getInstance().isBlacklisted(trimmedIdCard, &blacklistReason)) {
+        lastError = "该访客已被列入黑名单，禁止登记！";
+        if (!blacklistReason.empty()) lastError += "（" + blacklistReason + "）";
+        return false;
+    }
     std::string trimmedDormId = Common::trim(visitor.dormId);
     if (trimmedDormId.empty()) {
         lastError = "被访宿舍号不能为空！";
@@ -57,7 +71,7 @@ bool VisitorManager::validateVisitor(const Visitor& visitor, bool isAdd) {
         lastError = "被访宿舍号格式错误！";
         return false;
     }
-    if (!isDormExist(trimmedDormId)) {
+    if (!ExistenceCache::getInstance().isDormExist(trimmedDormId)) {
         lastError = "宿舍号" + trimmedDormId + "对应的宿舍不存在！";
         return false;
     }
@@ -108,55 +122,18 @@ Visitor VisitorManager::rowToVisitor(const std::map<std::string, std::string>& r
     return visitor;
 }
 
+//生成访客ID（从ID分配服务的预留块中取号，无需额外查询）
 std::string VisitorManager::generateVisitorId() {
-    //查询当前最大访客ID
-    std::string sql = "SELECT MAX(visitor_id) AS max_id FROM visitor";
-
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) {
-        return "1"; // 查询失败时默认返回1
-    }
+    static IdSequence& visitorSeq = IdAllocator::getInstance().getSequence(
+        "visitor", "SELECT IFNULL(MAX(CAST(visitor_id AS UNSIGNED)), 0) FROM visitor");
 
-    // 2. 解析最大序号并+1
-    int maxSeq = 0;
-    if (result->rowCount > 0 && !result->rows[0]["max_id"].empty()) {
-        std::string maxId = result->rows[0]["max_id"];
-        Common::stringToInt(maxId, maxSeq);
+    int64_t id = visitorSeq.next();
+    if (id <= 0) {
+        return ""; // 预留失败
     }
 
-    DBHelper::getInstance().freeResultset(result);
-    maxSeq++;
-
-    // 3. 返回纯数字ID
-    return std::to_string(maxSeq);
-}
-
-//校验学号是否存在
-bool VisitorManager::isStudentExist(const std::string& studentId) {
-    std::string trimmedId = Common::trim(studentId);
-    if (trimmedId.empty()) return false;
-
-    std::string sql = "SELECT student_id FROM student WHERE student_id = '" + trimmedId + "' LIMIT 1";
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) return false;
-
-    bool exist = result->rowCount > 0;
-    DBHelper::getInstance().freeResultset(result);
-    return exist;
-}
-
-//校验宿舍号是否存在
-bool VisitorManager::isDormExist(const std::string& dormId) {
-    std::string trimmedId = Common::trim(dormId);
-    if (trimmedId.empty()) return false;
-
-    std::string sql = "SELECT dorm_id FROM dorm WHERE dorm_id = '" + trimmedId + "' LIMIT 1";
-    DBResultset* result = DBHelper::getInstance().executeQuery(sql);
-    if (result == nullptr) return false;
-
-    bool exist = result->rowCount > 0;
-    DBHelper::getInstance().freeResultset(result);
-    return exist;
+    // 返回纯数字ID
+    return std::to_string(id);
 }
 
 //校验身份证号格式（18位，支持最后一位X）
@@ -186,16 +163,12 @@ bool VisitorManager::isValidTimeFormat(const std::string& time) {
 bool VisitorManager::isValidTimeLogic(const Date& visitDate, const std::string& visitTime,
     const Date& leaveDate, const std::string& leaveTime) {
     //拜访日期 > 离开日期：无效
-    if (visitDate.year > leaveDate.year ||
-        (visitDate.year == leaveDate.year && visitDate.month > leaveDate.month) ||
-        (visitDate.year == leaveDate.year && visitDate.month == leaveDate.month && visitDate.day > leaveDate.day)) {
+    if (leaveDate < visitDate) {
         return false;
     }
 
     //拜访日期 == 离开日期：校验时间
-    if (visitDate.year == leaveDate.year &&
-        visitDate.month == leaveDate.month &&
-        visitDate.day == leaveDate.day) {
+    if (visitDate == leaveDate) {
         int visitHour = std::stoi(visitTime.substr(0, 2));
         int visitMin = std::stoi(visitTime.substr(3, 2));
         int leaveHour = std::stoi(leaveTime.substr(0, 2));
@@ -208,6 +181,20 @@ bool VisitorManager::isValidTimeLogic(const Date& visitDate, const std::string&
 }
 
 //  新增访客登记实现 
+//访客的各列值（列名与数据库一致），用于审计日志和变更通知
+static AuditValues visitorColumns(const Visitor& visitor) {
+    return AuditValues{
+        { "visitor_name", Common::trim(visitor.visitorName) },
+        { "gender", Common::trim(visitor.gender) },
+        { "id_card", Common::trim(visitor.idCard) },
+        { "dorm_id", Common::trim(visitor.dormId) },
+        { "visit_reason", Common::trim(visitor.visitReason) },
+        { "visit_time", Common::trim(visitor.visitTime) },
+        { "leave_time", Common::trim(visitor.leaveTime) },
+        { "register_admin", Common::trim(visitor.registerAdmin) }
+    };
+}
+
 bool VisitorManager::addVisitor(const Visitor& visitor) {
     lastError.clear();
 
@@ -263,6 +250,25 @@ bool VisitorManager::addVisitor(const Visitor& visitor) {
         return false;
     }
 
+    //未填写离开时间即为在访访客
+    if (trimmedLeaveTime.empty()) {
+        Visitor active(visitorId, Common::trim(visitor.visitorName), Common::trim(visitor.gender),
+            Common::trim(visitor.idCard), Common::trim(visitor.dormId), Common::trim(visitor.visitReason),
+            visitDateTime + ":00", "", Common::trim(visitor.registerAdmin));
+        VisitorRegistry::getInstance().add(active);
+    }
+    VisitorTimeIndex::getInstance().addVisit(visitorId, visitor.dormId, visitDateTime,
+        trimmedLeaveTime.empty() ? "" : currentDate + " " + trimmedLeaveTime);
+    VisitorProfileIndex::getInstance().recordVisit(visitor.idCard, visitor.visitorName, visitor.dormId, visitDateTime);
+
+    if (affectedRows > 0) {
+        Visitor added(visitorId, visitor.visitorName, visitor.gender, visitor.idCard, visitor.dormId, visitor.visitReason,
+            visitDateTime + ":00", trimmedLeaveTime.empty() ? "" : currentDate + " " + trimmedLeaveTime + ":00", visitor.registerAdmin);
+        ChangeValues columns = visitorColumns(added);
+        AuditJournal::getInstance().recordInsert(AuditEntity::VISITOR, visitorId, columns);
+        ChangeFeed::getInstance().publishInsert(ChangeTable::VISITOR, visitorId, columns);
+    }
+
     return affectedRows >= 0;
 }
 
@@ -275,8 +281,11 @@ bool VisitorManager::updateVisitor(const Visitor& visitor) {
         return false;
     }
 
-    //检查访客记录是否存在
-    Visitor existVisitor = getVisitorById(visitor.visitorId);
+    //检查访客记录是否存在（在访访客直接从登记表确认）
+    Visitor existVisitor;
+    if (!VisitorRegistry::getInstance().find(visitor.visitorId, existVisitor)) {
+        existVisitor = getVisitorById(visitor.visitorId);
+    }
     if (existVisitor.visitorId.empty()) {
         lastError = "修改失败：未查询到访客ID" + visitor.visitorId + "对应的记录！";
         return false;
@@ -308,6 +317,23 @@ bool VisitorManager::updateVisitor(const Visitor& visitor) {
         return false;
     }
 
+    Visitor updated(Common::trim(visitor.visitorId), Common::trim(visitor.visitorName), Common::trim(visitor.gender),
+        Common::trim(visitor.idCard), Common::trim(visitor.dormId), Common::trim(visitor.visitReason),
+        visitDateTime + ":00", "", Common::trim(visitor.registerAdmin));
+    VisitorRegistry::getInstance().update(updated);
+    VisitorTimeIndex::getInstance().updateVisit(updated.visitorId, updated.dormId, visitDateTime);
+    VisitorProfileIndex::getInstance().removeVisit(existVisitor.idCard, existVisitor.dormId);
+    VisitorProfileIndex::getInstance().recordVisit(updated.idCard, updated.visitorName, updated.dormId, visitDateTime);
+
+    //审计日志和变更通知（离开时间不在本次修改范围内）
+    if (affectedRows > 0) {
+        updated.leaveTime = existVisitor.leaveTime;
+        ChangeValues before = visitorColumns(existVisitor);
+        ChangeValues after = visitorColumns(updated);
+        AuditJournal::getInstance().recordUpdate(AuditEntity::VISITOR, updated.visitorId, before, after);
+        ChangeFeed::getInstance().publishUpdate(ChangeTable::VISITOR, updated.visitorId, before, after);
+    }
+
     return affectedRows >= 0;
 }
 
@@ -333,8 +359,11 @@ bool VisitorManager::recordLeave(const std::string& visitorId, const Date& leave
         return false;
     }
 
-    // 2. 检查访客记录是否存在
-    Visitor existVisitor = getVisitorById(trimmedId);
+    // 2. 检查访客记录是否存在（在访访客直接命中登记表，无需查库）
+    Visitor existVisitor;
+    if (!VisitorRegistry::getInstance().find(trimmedId, existVisitor)) {
+        existVisitor = getVisitorById(trimmedId);
+    }
     if (existVisitor.visitorId.empty()) {
         lastError = "登记失败：未查询到访客ID" + trimmedId + "对应的记录！";
         return false;
@@ -359,6 +388,16 @@ bool VisitorManager::recordLeave(const std::string& visitorId, const Date& leave
         return false;
     }
 
+    VisitorRegistry::getInstance().remove(trimmedId);
+    VisitorTimeIndex::getInstance().closeVisit(trimmedId, leaveDateTime);
+    if (affectedRows > 0) {
+        Visitor left = existVisitor;
+        left.leaveTime = leaveDateTime + ":00";
+        ChangeValues before = visitorColumns(existVisitor);
+        ChangeValues after = visitorColumns(left);
+        AuditJournal::getInstance().recordStatus(AuditEntity::VISITOR, trimmedId, before, after);
+        ChangeFeed::getInstance().publishUpdate(ChangeTable::VISITOR, trimmedId, before, after);
+    }
     return affectedRows >= 0;
 }
 
@@ -381,7 +420,10 @@ bool VisitorManager::deleteVisitor(const std::string& visitorId) {
     }
 
     // 2. 检查访客记录是否存在
-    Visitor existVisitor = getVisitorById(trimmedId);
+    Visitor existVisitor;
+    if (!VisitorRegistry::getInstance().find(trimmedId, existVisitor)) {
+        existVisitor = getVisitorById(trimmedId);
+    }
     if (existVisitor.visitorId.empty()) {
         lastError = "删除失败：未查询到访客ID" + trimmedId + "对应的记录！";
         return false;
@@ -399,6 +441,14 @@ bool VisitorManager::deleteVisitor(const std::string& visitorId) {
         return false;
     }
 
+    VisitorRegistry::getInstance().remove(trimmedId);
+    VisitorTimeIndex::getInstance().removeVisit(trimmedId);
+    VisitorProfileIndex::getInstance().removeVisit(existVisitor.idCard, existVisitor.dormId);
+    if (affectedRows > 0) {
+        ChangeValues columns = visitorColumns(existVisitor);
+        AuditJournal::getInstance().recordRemove(AuditEntity::VISITOR, trimmedId, columns);
+        ChangeFeed::getInstance().publishRemove(ChangeTable::VISITOR, trimmedId, columns);
+    }
     return affectedRows >= 0;
 }
 
@@ -496,6 +546,12 @@ std::vector<Visitor> VisitorManager::filterVisitors(const std::string& studentId
         return visitorList;
     }
 
+    //只按宿舍筛选在访访客时直接从登记表分页
+    VisitorRegistry& registry = VisitorRegistry::getInstance();
+    if (status == VisitorStatus::VISITING && Common::trim(studentId).empty() && registry.ensureLoaded()) {
+        return registry.getPage(dormId, pageParam.getOffset(), pageParam.pageSize);
+    }
+
     std::ostringstream sqlStream;
     sqlStream << "SELECT visitor_id, visitor_name, gender, id_card, dorm_id, "
         << "visit_reason, visit_time, leave_time, register_admin "
@@ -563,6 +619,12 @@ int VisitorManager::getFilterTotalCount(const std::string& studentId, const std:
     VisitorStatus status) {
     lastError.clear();
 
+    VisitorRegistry& registry = VisitorRegistry::getInstance();
+    if (status == VisitorStatus::VISITING && Common::trim(studentId).empty() && registry.ensureLoaded()) {
+        std::string trimmedDormId = Common::trim(dormId);
+        return trimmedDormId.empty() ? registry.getActiveCount() : registry.getDormCount(trimmedDormId);
+    }
+
     std::ostringstream sqlStream;
     sqlStream << "SELECT COUNT(*) AS total FROM visitor WHERE 1=1 ";
 
@@ -608,6 +670,11 @@ std::string VisitorManager::getLastError() const {
 int VisitorManager::getActiveVisitorCount() {
     lastError.clear();
 
+    //登记表可用时直接读取原子计数
+    if (VisitorRegistry::getInstance().ensureLoaded()) {
+        return VisitorRegistry::getInstance().getActiveCount();
+    }
+
     std::string sql = "SELECT COUNT(*) AS total FROM visitor WHERE leave_time IS NULL";
     DBResultset* result = DBHelper::getInstance().executeQuery(sql);
     if (result == nullptr) {
@@ -90,15 +90,9 @@ private:
     // 私有辅助函数：将查询结果行转换为Visitor对象
     Visitor rowToVisitor(const std::map<std::string, std::string>& row);
 
-    // 私有辅助函数：生成访客ID（格式V+年月日+4位序号，如V2024110001）
+    // 私有辅助函数：生成访客ID（从ID分配服务的预留块中取号）
     std::string generateVisitorId();
 
-    // 私有辅助函数：校验学号是否存在
-    bool isStudentExist(const std::string& studentId);
-
-    // 私有辅助函数：校验宿舍号是否存在
-    bool isDormExist(const std::string& dormId);
-
     // 私有辅助函数：校验身份证号格式（18位）
     bool isValidIdCard(const std::string& idCard);
 
@@ -0,0 +1,274 @@
+#include "VisitorProfileIndex.h"
+#include "VisitorTimeIndex.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include "AuditJournal.h"
+#include "ChangeFeed.h"
+#include <sstream>
+
+//身份证号统一去空格、末位X大写
+static std::string normalizeIdCard(const std::string& idCard) {
+    return Common::toUpper(Common::trim(idCard));
+}
+
+VisitorProfileIndex& VisitorProfileIndex::getInstance() {
+    static VisitorProfileIndex instance;
+    return instance;
+}
+
+std::string VisitorProfileIndex::getLastError() {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    return lastError;
+}
+
+bool VisitorProfileIndex::ensureTable() {
+    std::string sql =
+        "CREATE TABLE IF NOT EXISTS visitor_blacklist ("
+        "id_card VARCHAR(18) NOT NULL PRIMARY KEY, "
+        "reason VARCHAR(100) NOT NULL DEFAULT '', "
+        "created_at DATETIME NOT NULL)";
+    if (DBHelper::getInstance().executeUpdate(sql) == -1) {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        lastError = "创建访客黑名单表失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+    return true;
+}
+
+void VisitorProfileIndex::rebuildBloomLocked() {
+    //预留一倍余量，新增名单时不必每次重建
+    bloomCapacity = blacklist.size() * 2 + 1024;
+    blacklistBloom.reset(bloomCapacity);
+    for (const auto& item : blacklist) {
+        blacklistBloom.add(item.first);
+    }
+}
+
+bool VisitorProfileIndex::loadBlacklist() {
+    if (!ensureTable()) return false;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    std::unordered_map<std::string, std::string> newList;
+    int64_t rows = DBHelper::getInstance().executeQueryStream(
+        "SELECT id_card, reason FROM visitor_blacklist",
+        [&newList](const DBRowView& row) {
+            newList[normalizeIdCard(row.getString(0))] = row.getString(1);
+        });
+    if (rows < 0) {
+        lastError = "加载访客黑名单失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    blacklist = std::move(newList);
+    rebuildBloomLocked();
+    blacklistLoaded = true;
+    return true;
+}
+
+bool VisitorProfileIndex::ensureBlacklistLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (blacklistLoaded) return true;
+    }
+    return loadBlacklist();
+}
+
+bool VisitorProfileIndex::isBlacklisted(const std::string& idCard, std::string* reason) {
+    if (!ensureBlacklistLoaded()) return false;
+    std::string key = normalizeIdCard(idCard);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    //过滤器判定不存在即可放行
+    if (!blacklistBloom.mayContain(key)) return false;
+    auto it = blacklist.find(key);
+    if (it == blacklist.end()) return false;
+    if (reason != nullptr) *reason = it->second;
+    return true;
+}
+
+bool VisitorProfileIndex::addToBlacklist(const std::string& idCard, const std::string& reason) {
+    std::string key = normalizeIdCard(idCard);
+    if (key.empty()) {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        lastError = "身份证号不能为空！";
+        return false;
+    }
+    //与访客登记相同的格式校验，避免写入永远匹配不上的号码（列宽18位）
+    if (!Common::isValidIDCard(key)) {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        lastError = "身份证号格式错误（需18位，支持最后一位X）！";
+        return false;
+    }
+    if (!ensureBlacklistLoaded()) return false;
+
+    std::ostringstream sqlStream;
+    sqlStream << "INSERT INTO visitor_blacklist (id_card, reason, created_at) VALUES ('"
+        << key << "', '" << Common::trim(reason) << "', NOW()) "
+        << "ON DUPLICATE KEY UPDATE reason = VALUES(reason)";
+    int affectedRows = DBHelper::getInstance().executeUpdate(sqlStream.str());
+
+    AuditValues before;
+    AuditValues after{ { "reason", Common::trim(reason) } };
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (affectedRows == -1) {
+            lastError = "加入黑名单失败：" + DBHelper::getInstance().getLastError().errorMsg;
+            return false;
+        }
+        //审计日志：已在名单中时为修改原因
+        AuditJournal& audit = AuditJournal::getInstance();
+        auto found = blacklist.find(key);
+        if (found == blacklist.end()) {
+            audit.recordInsert(AuditEntity::BLACKLIST, key, after);
+        }
+        else {
+            before.push_back(AuditValues::value_type("reason", found->second));
+            audit.recordUpdate(AuditEntity::BLACKLIST, key, before, after);
+        }
+        blacklist[key] = Common::trim(reason);
+        if (blacklist.size() > bloomCapacity) {
+            rebuildBloomLocked();
+        }
+        else {
+            blacklistBloom.add(key);
+        }
+    }
+
+    //变更通知在索引锁外发布
+    if (before.empty()) {
+        ChangeFeed::getInstance().publishInsert(ChangeTable::BLACKLIST, key, after);
+    }
+    else {
+        ChangeFeed::getInstance().publishUpdate(ChangeTable::BLACKLIST, key, before, after);
+    }
+    return true;
+}
+
+bool VisitorProfileIndex::removeFromBlacklist(const std::string& idCard) {
+    std::string key = normalizeIdCard(idCard);
+    if (!ensureBlacklistLoaded()) return false;
+
+    std::string sql = "DELETE FROM visitor_blacklist WHERE id_card = '" + key + "'";
+    int affectedRows = DBHelper::getInstance().executeUpdate(sql);
+
+    AuditValues removed;
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (affectedRows == -1) {
+            lastError = "移出黑名单失败：" + DBHelper::getInstance().getLastError().errorMsg;
+            return false;
+        }
+        if (affectedRows == 0) {
+            lastError = "身份证号" + key + "不在黑名单中！";
+            return false;
+        }
+        //布隆过滤器不支持删除，只需从名单移除
+        auto found = blacklist.find(key);
+        if (found != blacklist.end()) {
+            removed.push_back(AuditValues::value_type("reason", found->second));
+            AuditJournal::getInstance().recordRemove(AuditEntity::BLACKLIST, key, removed);
+            blacklist.erase(found);
+        }
+    }
+    if (!removed.empty()) ChangeFeed::getInstance().publishRemove(ChangeTable::BLACKLIST, key, removed);
+    return true;
+}
+
+void VisitorProfileIndex::applyVisit(Profile& profile, const std::string& visitorName,
+    const std::string& dormId, int32_t visitMinute) {
+    profile.visitCount++;
+    profile.dorms[dormId]++;
+    if (visitMinute >= profile.lastVisitMinute) {
+        profile.lastVisitMinute = visitMinute;
+        profile.visitorName = visitorName;
+    }
+}
+
+bool VisitorProfileIndex::rebuildProfiles() {
+    std::lock_guard<std::mutex> lock(indexMutex);
+
+    std::unordered_map<std::string, Profile> newProfiles;
+    int64_t rows = DBHelper::getInstance().executeQueryStream(
+        "SELECT id_card, visitor_name, dorm_id, visit_time FROM visitor",
+        [&newProfiles](const DBRowView& row) {
+            int32_t minute = -1;
+            VisitorTimeIndex::parseMinute(row.getString(3), minute);
+            applyVisit(newProfiles[normalizeIdCard(row.getString(0))], row.getString(1), row.getString(2), minute);
+        });
+    if (rows < 0) {
+        lastError = "加载访客档案失败：" + DBHelper::getInstance().getLastError().errorMsg;
+        return false;
+    }
+
+    profiles = std::move(newProfiles);
+    profilesLoaded = true;
+    return true;
+}
+
+bool VisitorProfileIndex::ensureProfilesLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (profilesLoaded) return true;
+    }
+    return rebuildProfiles();
+}
+
+bool VisitorProfileIndex::getProfile(const std::string& idCard, VisitorProfile& profile) {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        lastError.clear();
+    }
+    if (!ensureProfilesLoaded()) return false;
+    ensureBlacklistLoaded();
+    std::string key = normalizeIdCard(idCard);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    profile = VisitorProfile();
+    profile.idCard = key;
+
+    auto blackIt = blacklist.find(key);
+    if (blackIt != blacklist.end()) {
+        profile.blacklisted = true;
+        profile.blacklistReason = blackIt->second;
+    }
+
+    auto it = profiles.find(key);
+    if (it == profiles.end()) return profile.blacklisted;
+
+    profile.visitorName = it->second.visitorName;
+    profile.visitCount = it->second.visitCount;
+    if (it->second.lastVisitMinute >= 0) {
+        profile.lastVisit = VisitorTimeIndex::formatMinute(it->second.lastVisitMinute);
+    }
+    for (const auto& item : it->second.dorms) {
+        profile.dormsVisited.push_back(item.first);
+    }
+    return true;
+}
+
+void VisitorProfileIndex::recordVisit(const std::string& idCard, const std::string& visitorName,
+    const std::string& dormId, const std::string& visitTime) {
+    int32_t minute = -1;
+    VisitorTimeIndex::parseMinute(visitTime, minute);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!profilesLoaded) return;
+    applyVisit(profiles[normalizeIdCard(idCard)], Common::trim(visitorName), Common::trim(dormId), minute);
+}
+
+void VisitorProfileIndex::removeVisit(const std::string& idCard, const std::string& dormId) {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!profilesLoaded) return;
+    auto it = profiles.find(normalizeIdCard(idCard));
+    if (it == profiles.end()) return;
+
+    //最近来访时间保持不变，重建时再精确计算
+    Profile& profile = it->second;
+    auto dormIt = profile.dorms.find(Common::trim(dormId));
+    if (dormIt != profile.dorms.end() && --dormIt->second <= 0) {
+        profile.dorms.erase(dormIt);
+    }
+    if (--profile.visitCount <= 0) {
+        profiles.erase(it);
+    }
+}
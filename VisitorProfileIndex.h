@@ -0,0 +1,96 @@
+#ifndef VISITORPROFILEINDEX_H
+#define VISITORPROFILEINDEX_H
+
+#include "BloomFilter.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <mutex>
+#include <cstdint>
+
+// 按身份证号汇总的访客档案
+struct VisitorProfile {
+    std::string idCard;                   // 身份证号
+    std::string visitorName;              // 最近一次登记的姓名
+    int visitCount;                       // 来访次数
+    std::string lastVisit;                // 最近来访时间（YYYY-MM-DD HH:MM）
+    std::vector<std::string> dormsVisited;// 到访过的宿舍
+    bool blacklisted;                     // 是否在黑名单
+    std::string blacklistReason;          // 列入黑名单原因
+
+    VisitorProfile() : visitCount(0), blacklisted(false) {}
+};
+
+// --------------- 访客档案索引（单例）---------------
+// 按身份证号关联多次来访，记录来访次数、最近来访和到访宿舍；
+// 黑名单启动时全量载入，布隆过滤器判定"不在名单"即放行，
+// 命中时再查内存集合确认，登记访客时无需访问数据库。
+class VisitorProfileIndex {
+public:
+    static VisitorProfileIndex& getInstance();
+
+    // 是否在黑名单（reason返回列入原因）
+    bool isBlacklisted(const std::string& idCard, std::string* reason = nullptr);
+
+    // 加入/移出黑名单（写库后同步内存）
+    bool addToBlacklist(const std::string& idCard, const std::string& reason);
+    bool removeFromBlacklist(const std::string& idCard);
+
+    // 查询档案，无来访且不在黑名单返回false；档案加载失败也返回false并设置错误信息
+    bool getProfile(const std::string& idCard, VisitorProfile& profile);
+
+    // 来访登记/删除后同步（visitTime格式YYYY-MM-DD HH:MM[:SS]）
+    void recordVisit(const std::string& idCard, const std::string& visitorName,
+        const std::string& dormId, const std::string& visitTime);
+    void removeVisit(const std::string& idCard, const std::string& dormId);
+
+    // 加载黑名单（启动时调用）
+    bool loadBlacklist();
+
+    // 从visitor表重建档案
+    bool rebuildProfiles();
+
+    // 确保黑名单表存在
+    bool ensureTable();
+
+    std::string getLastError();
+
+private:
+    VisitorProfileIndex() : bloomCapacity(0), blacklistLoaded(false), profilesLoaded(false) {}
+    VisitorProfileIndex(const VisitorProfileIndex&) = delete;
+    VisitorProfileIndex& operator=(const VisitorProfileIndex&) = delete;
+
+    // 一名访客的汇总
+    struct Profile {
+        std::string visitorName;
+        int visitCount;
+        int32_t lastVisitMinute;            // 自1970-01-01起的分钟数，-1表示无
+        std::map<std::string, int> dorms;   // 宿舍号 → 来访次数
+
+        Profile() : visitCount(0), lastVisitMinute(-1) {}
+    };
+
+    std::mutex indexMutex;
+    std::unordered_map<std::string, Profile> profiles;            // 身份证号 → 档案
+    BloomFilter blacklistBloom;                                   // 否定判断
+    std::unordered_map<std::string, std::string> blacklist;       // 身份证号 → 原因
+    size_t bloomCapacity;                                         // 过滤器按此数量分配
+    bool blacklistLoaded;
+    bool profilesLoaded;
+    std::string lastError;
+
+    // 首次使用时加载（不持锁调用）
+    bool ensureBlacklistLoaded();
+    bool ensureProfilesLoaded();
+
+    // 按当前名单重建布隆过滤器（已持有indexMutex）
+    void rebuildBloomLocked();
+
+    // 累加一次来访（已持有indexMutex）
+    static void applyVisit(Profile& profile, const std::string& visitorName,
+        const std::string& dormId, int32_t visitMinute);
+};
+
+#endif // VISITORPROFILEINDEX_H
@@ -0,0 +1,149 @@
+#include "VisitorRegistry.h"
+#include "Common.h"
+#include "DBHelper.h"
+#include <iterator>
+
+VisitorRegistry& VisitorRegistry::getInstance() {
+    static VisitorRegistry instance;
+    return instance;
+}
+
+void VisitorRegistry::indexLocked(const Visitor& visitor) {
+    visitors[visitor.visitorId] = visitor;
+    orderedIds.insert(visitor.visitorId);
+    byDorm[visitor.dormId].insert(visitor.visitorId);
+    byIdCard[visitor.idCard].insert(visitor.visitorId);
+}
+
+void VisitorRegistry::unindexLocked(const Visitor& visitor) {
+    orderedIds.erase(visitor.visitorId);
+
+    auto dormIt = byDorm.find(visitor.dormId);
+    if (dormIt != byDorm.end()) {
+        dormIt->second.erase(visitor.visitorId);
+        if (dormIt->second.empty()) byDorm.erase(dormIt);
+    }
+    auto cardIt = byIdCard.find(visitor.idCard);
+    if (cardIt != byIdCard.end()) {
+        cardIt->second.erase(visitor.visitorId);
+        if (cardIt->second.empty()) byIdCard.erase(cardIt);
+    }
+    visitors.erase(visitor.visitorId);
+}
+
+bool VisitorRegistry::rebuild() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    std::vector<Visitor> rows;
+    int64_t count = DBHelper::getInstance().executeQueryStream(
+        "SELECT visitor_id, visitor_name, gender, id_card, dorm_id, visit_reason, visit_time, register_admin "
+        "FROM visitor WHERE leave_time IS NULL",
+        [&rows](const DBRowView& row) {
+            Visitor visitor;
+            visitor.visitorId = row.getString(0);
+            visitor.visitorName = row.getString(1);
+            visitor.gender = row.getString(2);
+            visitor.idCard = row.getString(3);
+            visitor.dormId = row.getString(4);
+            visitor.visitReason = row.getString(5);
+            visitor.visitTime = row.getString(6);
+            visitor.registerAdmin = row.getString(7);
+            rows.push_back(visitor);
+        });
+    if (count < 0) return false;
+
+    visitors.clear();
+    orderedIds.clear();
+    byDorm.clear();
+    byIdCard.clear();
+    visitors.reserve(rows.size() * 2);
+    for (const auto& visitor : rows) {
+        indexLocked(visitor);
+    }
+    activeCount.store(static_cast<int>(visitors.size()));
+    loaded.store(true);
+    return true;
+}
+
+bool VisitorRegistry::ensureLoaded() {
+    if (loaded.load()) return true;
+    return rebuild();
+}
+
+void VisitorRegistry::add(const Visitor& visitor) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (!loaded.load() || visitor.visitorId.empty()) return;
+    if (visitors.count(visitor.visitorId) > 0) return;
+
+    indexLocked(visitor);
+    activeCount.fetch_add(1);
+}
+
+void VisitorRegistry::update(const Visitor& visitor) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = visitors.find(visitor.visitorId);
+    if (it == visitors.end()) return;
+
+    //宿舍号或身份证号可能变化，先撤销旧索引
+    Visitor old = it->second;
+    unindexLocked(old);
+    indexLocked(visitor);
+}
+
+bool VisitorRegistry::remove(const std::string& visitorId) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = visitors.find(Common::trim(visitorId));
+    if (it == visitors.end()) return false;
+
+    Visitor old = it->second;
+    unindexLocked(old);
+    activeCount.fetch_sub(1);
+    return true;
+}
+
+bool VisitorRegistry::find(const std::string& visitorId, Visitor& visitor) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = visitors.find(Common::trim(visitorId));
+    if (it == visitors.end()) return false;
+    visitor = it->second;
+    return true;
+}
+
+std::vector<Visitor> VisitorRegistry::findByIdCard(const std::string& idCard) {
+    std::vector<Visitor> result;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = byIdCard.find(Common::trim(idCard));
+    if (it == byIdCard.end()) return result;
+    for (const auto& id : it->second) {
+        result.push_back(visitors[id]);
+    }
+    return result;
+}
+
+std::vector<Visitor> VisitorRegistry::getPage(const std::string& dormId, int offset, int limit) {
+    std::vector<Visitor> result;
+    if (offset < 0 || limit <= 0) return result;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const std::set<std::string>* ids = &orderedIds;
+    std::string trimmedDormId = Common::trim(dormId);
+    if (!trimmedDormId.empty()) {
+        auto it = byDorm.find(trimmedDormId);
+        if (it == byDorm.end()) return result;
+        ids = &it->second;
+    }
+    if (static_cast<size_t>(offset) >= ids->size()) return result;
+
+    auto it = ids->begin();
+    std::advance(it, offset);
+    for (; it != ids->end() && static_cast<int>(result.size()) < limit; ++it) {
+        result.push_back(visitors[*it]);
+    }
+    return result;
+}
+
+int VisitorRegistry::getDormCount(const std::string& dormId) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = byDorm.find(Common::trim(dormId));
+    return it == byDorm.end() ? 0 : static_cast<int>(it->second.size());
+}
@@ -0,0 +1,71 @@
+#ifndef VISITORREGISTRY_H
+#define VISITORREGISTRY_H
+
+#include "VisitorManager.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <atomic>
+#include <mutex>
+
+// --------------- 在访访客登记表（单例）---------------
+// 只保存尚未离开的访客，按访客ID、宿舍号、身份证号三路索引；
+// 在访人数用原子计数直接读取，前台登记离开时无需再查库。
+// 启动时流式加载，由VisitorManager的写操作保持同步。
+class VisitorRegistry {
+public:
+    static VisitorRegistry& getInstance();
+
+    // 新登记的在访访客
+    void add(const Visitor& visitor);
+
+    // 修改在访访客信息（不在表中则忽略）
+    void update(const Visitor& visitor);
+
+    // 访客离开或被删除，返回是否在表中
+    bool remove(const std::string& visitorId);
+
+    // 按访客ID查找在访访客
+    bool find(const std::string& visitorId, Visitor& visitor);
+
+    // 按身份证号查找在访记录
+    std::vector<Visitor> findByIdCard(const std::string& idCard);
+
+    // 分页取在访访客（dormId为空表示全部，按访客ID升序）
+    std::vector<Visitor> getPage(const std::string& dormId, int offset, int limit);
+
+    // 在访总人数
+    int getActiveCount() const { return activeCount.load(); }
+
+    // 某宿舍在访人数
+    int getDormCount(const std::string& dormId);
+
+    // 首次使用时加载
+    bool ensureLoaded();
+
+    // 从visitor表重建
+    bool rebuild();
+
+    // 是否已加载
+    bool isLoaded() const { return loaded.load(); }
+
+private:
+    VisitorRegistry() : activeCount(0), loaded(false) {}
+    VisitorRegistry(const VisitorRegistry&) = delete;
+    VisitorRegistry& operator=(const VisitorRegistry&) = delete;
+
+    std::mutex registryMutex;
+    std::unordered_map<std::string, Visitor> visitors;                   // 访客ID → 记录
+    std::set<std::string> orderedIds;                                    // 与SQL的ORDER BY visitor_id一致
+    std::unordered_map<std::string, std::set<std::string>> byDorm;       // 宿舍号 → 访客ID
+    std::unordered_map<std::string, std::set<std::string>> byIdCard;     // 身份证号 → 访客ID
+    std::atomic<int> activeCount;
+    std::atomic<bool> loaded;
+
+    // 建立/撤销索引（已持有registryMutex）
+    void indexLocked(const Visitor& visitor);
+    void unindexLocked(const Visitor& visitor);
+};
+
+#endif // VISITORREGISTRY_H
@@ -0,0 +1,346 @@
+#include "VisitorTimeIndex.h"
+#include "DBHelper.h"
+#include "ExistenceCache.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <climits>
+
+static const int32_t MINUTES_PER_DAY = 1440;
+static const int32_t OPEN_END = INT32_MAX;
+//停留超过一天的来访单独登记，日段扫描只需回看一天
+static const int32_t LONG_SPAN = MINUTES_PER_DAY;
+
+//日序号（分钟数向下取整到天）
+static int32_t dayOf(int32_t minute) {
+    return minute >= 0 ? minute / MINUTES_PER_DAY : (minute - MINUTES_PER_DAY + 1) / MINUTES_PER_DAY;
+}
+
+static bool readNumber(const std::string& str, size_t pos, size_t len, int& value) {
+    if (pos + len > str.size()) return false;
+    value = 0;
+    for (size_t i = pos; i < pos + len; ++i) {
+        if (str[i] < '0' || str[i] > '9') return false;
+        value = value * 10 + (str[i] - '0');
+    }
+    return true;
+}
+
+bool VisitorTimeIndex::parseMinute(const std::string& dateTime, int32_t& minute) {
+    //YYYY-MM-DD HH:MM[:SS]
+    int year, month, day, hour, min;
+    if (dateTime.size() < 16 || dateTime[4] != '-' || dateTime[7] != '-' || dateTime[13] != ':') return false;
+    if (!readNumber(dateTime, 0, 4, year) || !readNumber(dateTime, 5, 2, month) || !readNumber(dateTime, 8, 2, day) ||
+        !readNumber(dateTime, 11, 2, hour) || !readNumber(dateTime, 14, 2, min)) {
+        return false;
+    }
+    if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || min > 59) return false;
+
+    minute = Common::dateToDays(Date(year, month, day)) * MINUTES_PER_DAY + hour * 60 + min;
+    return true;
+}
+
+std::string VisitorTimeIndex::formatMinute(int32_t minute) {
+    int32_t dayNo = dayOf(minute);
+    int year, month, day;
+    Common::daysToDate(dayNo).toCivil(year, month, day);
+    int rest = minute - dayNo * MINUTES_PER_DAY;
+
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%04d-%02d-%02d %02d:%02d", year, month, day, rest / 60, rest % 60);
+    return buf;
+}
+
+uint32_t VisitorTimeIndex::Dictionary::encode(const std::string& name) {
+    auto it = codes.find(name);
+    if (it != codes.end()) return it->second;
+    uint32_t code = static_cast<uint32_t>(names.size());
+    names.push_back(name);
+    codes.emplace(name, code);
+    return code;
+}
+
+bool VisitorTimeIndex::Dictionary::lookup(const std::string& name, uint32_t& code) const {
+    auto it = codes.find(name);
+    if (it == codes.end()) return false;
+    code = it->second;
+    return true;
+}
+
+VisitorTimeIndex& VisitorTimeIndex::getInstance() {
+    static VisitorTimeIndex instance;
+    return instance;
+}
+
+void VisitorTimeIndex::insertLocked(const Entry& entry) {
+    DaySegment& segment = days[dayOf(entry.start)];
+    auto pos = std::upper_bound(segment.entries.begin(), segment.entries.end(), entry.start,
+        [](int32_t start, const Entry& e) { return start < e.start; });
+    segment.entries.insert(pos, entry);
+    segment.maxEnd = std::max(segment.maxEnd, entry.end);
+
+    auto hourIt = segment.hourly.find(entry.buildingCode);
+    if (hourIt == segment.hourly.end()) {
+        std::array<int, 24> empty;
+        empty.fill(0);
+        hourIt = segment.hourly.emplace(entry.buildingCode, empty).first;
+    }
+    hourIt->second[(entry.start - dayOf(entry.start) * MINUTES_PER_DAY) / 60]++;
+
+    startOf[entry.visitorId] = entry.start;
+    if (entry.end == OPEN_END) {
+        openVisits.emplace(std::make_pair(entry.start, entry.visitorId), entry);
+    }
+    else if (entry.end - entry.start > LONG_SPAN) {
+        longVisits.emplace(std::make_pair(entry.end, entry.visitorId), entry);
+    }
+}
+
+bool VisitorTimeIndex::eraseLocked(int64_t visitorId, Entry& removed) {
+    auto startIt = startOf.find(visitorId);
+    if (startIt == startOf.end()) return false;
+
+    auto dayIt = days.find(dayOf(startIt->second));
+    if (dayIt == days.end()) return false;
+    DaySegment& segment = dayIt->second;
+
+    //同一分钟到访的记录相邻，在该区间内按ID查找
+    auto lower = std::lower_bound(segment.entries.begin(), segment.entries.end(), startIt->second,
+        [](const Entry& e, int32_t start) { return e.start < start; });
+    for (auto it = lower; it != segment.entries.end() && it->start == startIt->second; ++it) {
+        if (it->visitorId != visitorId) continue;
+
+        removed = *it;
+        segment.hourly[removed.buildingCode][(removed.start - dayIt->first * MINUTES_PER_DAY) / 60]--;
+        segment.entries.erase(it);
+        if (segment.entries.empty()) days.erase(dayIt);
+        if (removed.end == OPEN_END) openVisits.erase(std::make_pair(removed.start, visitorId));
+        else longVisits.erase(std::make_pair(removed.end, visitorId));
+        startOf.erase(startIt);
+        return true;
+    }
+    return false;
+}
+
+VisitSpan VisitorTimeIndex::toSpan(const Entry& entry) const {
+    VisitSpan span;
+    span.visitorId = std::to_string(entry.visitorId);
+    span.dormId = dorms.names[entry.dormCode];
+    span.building = buildings.names[entry.buildingCode];
+    span.visitTime = formatMinute(entry.start);
+    if (entry.end != OPEN_END) span.leaveTime = formatMinute(entry.end);
+    return span;
+}
+
+bool VisitorTimeIndex::buildingFilter(const std::string& building, bool& filtered, uint32_t& code) const {
+    std::string trimmed = Common::trim(building);
+    filtered = !trimmed.empty();
+    if (!filtered) return true;
+    return buildings.lookup(trimmed, code);
+}
+
+void VisitorTimeIndex::collectOverlapping(int32_t from, int32_t to, bool filtered, uint32_t code,
+    std::vector<Entry>& out) const {
+    if (from >= to) return;
+
+    //普通来访最早在from前一天到访
+    int32_t firstDay = dayOf(from - LONG_SPAN);
+    int32_t lastDay = dayOf(to - 1);
+    for (auto dayIt = days.lower_bound(firstDay); dayIt != days.end() && dayIt->first <= lastDay; ++dayIt) {
+        const DaySegment& segment = dayIt->second;
+        if (segment.maxEnd <= from) continue;
+        for (const Entry& entry : segment.entries) {
+            if (entry.start >= to) break;
+            if (entry.end <= from) continue;
+            if (filtered && entry.buildingCode != code) continue;
+            out.push_back(entry);
+        }
+    }
+
+    //更早到访的长时间来访：只看from之后才离开的
+    int32_t windowStart = firstDay * MINUTES_PER_DAY;
+    for (auto it = longVisits.upper_bound(std::pair<int32_t, int64_t>(from, INT64_MAX)); it != longVisits.end(); ++it) {
+        const Entry& entry = it->second;
+        if (entry.start >= windowStart) continue;
+        if (filtered && entry.buildingCode != code) continue;
+        out.push_back(entry);
+    }
+
+    //更早到访且仍未离开的
+    for (auto it = openVisits.begin(); it != openVisits.end() && it->first.first < windowStart; ++it) {
+        if (filtered && it->second.buildingCode != code) continue;
+        out.push_back(it->second);
+    }
+}
+
+void VisitorTimeIndex::addVisit(const std::string& visitorId, const std::string& dormId,
+    const std::string& visitTime, const std::string& leaveTime) {
+    int32_t start = 0;
+    if (!parseMinute(visitTime, start)) return;
+    int32_t end = OPEN_END;
+    if (!Common::trim(leaveTime).empty() && parseMinute(leaveTime, end)) {
+        end = std::max(end, start);
+    }
+    //楼栋在加锁前查好，避免持锁访问其他模块
+    std::string trimmedDormId = Common::trim(dormId);
+    std::string building = ExistenceCache::getInstance().getBuildingOfDorm(trimmedDormId);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    Entry entry;
+    entry.start = start;
+    entry.end = end;
+    entry.visitorId = std::strtoll(visitorId.c_str(), nullptr, 10);
+    entry.dormCode = dorms.encode(trimmedDormId);
+    entry.buildingCode = buildings.encode(building);
+
+    Entry old;
+    eraseLocked(entry.visitorId, old);
+    insertLocked(entry);
+}
+
+void VisitorTimeIndex::updateVisit(const std::string& visitorId, const std::string& dormId, const std::string& visitTime) {
+    int32_t start = 0;
+    if (!parseMinute(visitTime, start)) return;
+    std::string trimmedDormId = Common::trim(dormId);
+    std::string building = ExistenceCache::getInstance().getBuildingOfDorm(trimmedDormId);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    Entry entry;
+    if (!eraseLocked(std::strtoll(visitorId.c_str(), nullptr, 10), entry)) return;
+    entry.start = start;
+    if (entry.end != OPEN_END) entry.end = std::max(entry.end, start);
+    entry.dormCode = dorms.encode(trimmedDormId);
+    entry.buildingCode = buildings.encode(building);
+    insertLocked(entry);
+}
+
+void VisitorTimeIndex::closeVisit(const std::string& visitorId, const std::string& leaveTime) {
+    int32_t end = 0;
+    if (!parseMinute(leaveTime, end)) return;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    Entry entry;
+    if (!eraseLocked(std::strtoll(visitorId.c_str(), nullptr, 10), entry)) return;
+    entry.end = std::max(end, entry.start);
+    insertLocked(entry);
+}
+
+void VisitorTimeIndex::removeVisit(const std::string& visitorId) {
+    std::lock_guard<std::mutex> lock(indexMutex);
+    if (!loaded) return;
+    Entry entry;
+    eraseLocked(std::strtoll(visitorId.c_str(), nullptr, 10), entry);
+}
+
+std::vector<VisitSpan> VisitorTimeIndex::findOverlapping(const std::string& from, const std::string& to,
+    const std::string& building) {
+    std::vector<VisitSpan> result;
+    int32_t fromMinute = 0, toMinute = 0;
+    if (!parseMinute(from, fromMinute) || !parseMinute(to, toMinute)) return result;
+    if (!ensureLoaded()) return result;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    bool filtered = false;
+    uint32_t code = 0;
+    if (!buildingFilter(building, filtered, code)) return result;
+
+    std::vector<Entry> entries;
+    collectOverlapping(fromMinute, toMinute, filtered, code, entries);
+    result.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        result.push_back(toSpan(entry));
+    }
+    return result;
+}
+
+int VisitorTimeIndex::countPresentAt(const std::string& when, const std::string& building) {
+    int32_t minute = 0;
+    if (!parseMinute(when, minute)) return 0;
+    if (!ensureLoaded()) return 0;
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    bool filtered = false;
+    uint32_t code = 0;
+    if (!buildingFilter(building, filtered, code)) return 0;
+
+    std::vector<Entry> entries;
+    collectOverlapping(minute, minute + 1, filtered, code, entries);
+    return static_cast<int>(entries.size());
+}
+
+std::array<int, 24> VisitorTimeIndex::getHourlyArrivals(const Date& fromDate, const Date& toDate,
+    const std::string& building) {
+    std::array<int, 24> result;
+    result.fill(0);
+    if (!ensureLoaded()) return result;
+
+    int32_t firstDay = Common::dateToDays(fromDate);
+    int32_t lastDay = Common::dateToDays(toDate);
+
+    std::lock_guard<std::mutex> lock(indexMutex);
+    bool filtered = false;
+    uint32_t code = 0;
+    if (!buildingFilter(building, filtered, code)) return result;
+
+    for (auto dayIt = days.lower_bound(firstDay); dayIt != days.end() && dayIt->first <= lastDay; ++dayIt) {
+        for (const auto& item : dayIt->second.hourly) {
+            if (filtered && item.first != code) continue;
+            for (int h = 0; h < 24; ++h) {
+                result[h] += item.second[h];
+            }
+        }
+    }
+    return result;
+}
+
+bool VisitorTimeIndex::ensureLoaded() {
+    {
+        std::lock_guard<std::mutex> lock(indexMutex);
+        if (loaded) return true;
+    }
+    return rebuild();
+}
+
+bool VisitorTimeIndex::rebuild() {
+    std::lock_guard<std::mutex> lock(indexMutex);
+
+    //只在流式读取时解析一次时间
+    std::vector<Entry> entries;
+    Dictionary newDorms;
+    Dictionary newBuildings;
+    int64_t rows = DBHelper::getInstance().executeQueryStream(
+        "SELECT v.visitor_id, v.dorm_id, IFNULL(d.building, ''), v.visit_time, v.leave_time "
+        "FROM visitor v LEFT JOIN dorm d ON v.dorm_id = d.dorm_id",
+        [&](const DBRowView& row) {
+            Entry entry;
+            if (!parseMinute(row.getString(3), entry.start)) return;
+            entry.end = OPEN_END;
+            if (!row.isNull(4) && parseMinute(row.getString(4), entry.end)) {
+                entry.end = std::max(entry.end, entry.start);
+            }
+            entry.visitorId = std::strtoll(row.getString(0).c_str(), nullptr, 10);
+            entry.dormCode = newDorms.encode(row.getString(1));
+            entry.buildingCode = newBuildings.encode(row.getString(2));
+            entries.push_back(entry);
+        });
+    if (rows < 0) return false;
+
+    //先整体排序，再按日段顺序追加，避免逐条插入
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.start < b.start; });
+
+    days.clear();
+    startOf.clear();
+    longVisits.clear();
+    openVisits.clear();
+    dorms = std::move(newDorms);
+    buildings = std::move(newBuildings);
+    startOf.reserve(entries.size());
+    for (const Entry& entry : entries) {
+        insertLocked(entry);
+    }
+    loaded = true;
+    return true;
+}
@@ -0,0 +1,117 @@
+#ifndef VISITORTIMEINDEX_H
+#define VISITORTIMEINDEX_H
+
+#include "Common.h"
+#include <string>
+#include <vector>
+#include <array>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+// 一次来访的时间段（查询结果）
+struct VisitSpan {
+    std::string visitorId;  // 访客ID
+    std::string dormId;     // 被访宿舍
+    std::string building;   // 宿舍所在楼栋
+    std::string visitTime;  // 到访时间（YYYY-MM-DD HH:MM）
+    std::string leaveTime;  // 离开时间，仍在访为空
+};
+
+// --------------- 访客时间索引（单例）---------------
+// 来访记录按到访日期分段，每段内按到访分钟排序并记录各小时到访人数；
+// 时间在入库时一次性解析为分钟数，查询只做整数比较。
+// 时间段查询只需回看一天内的日段；停留超过一天的来访按离开时间排序单独维护，未离开的另存一份。
+class VisitorTimeIndex {
+public:
+    static VisitorTimeIndex& getInstance();
+
+    // 新增来访（leaveTime为空表示未离开）
+    void addVisit(const std::string& visitorId, const std::string& dormId,
+        const std::string& visitTime, const std::string& leaveTime);
+
+    // 修改来访的宿舍和到访时间（保留离开时间）
+    void updateVisit(const std::string& visitorId, const std::string& dormId, const std::string& visitTime);
+
+    // 登记离开
+    void closeVisit(const std::string& visitorId, const std::string& leaveTime);
+
+    // 删除来访
+    void removeVisit(const std::string& visitorId);
+
+    // 与[from, to)有重叠的来访（时间格式YYYY-MM-DD HH:MM，building为空表示不限）
+    std::vector<VisitSpan> findOverlapping(const std::string& from, const std::string& to,
+        const std::string& building = "");
+
+    // 某一时刻在访人数
+    int countPresentAt(const std::string& when, const std::string& building = "");
+
+    // [fromDate, toDate]内各小时到访人数
+    std::array<int, 24> getHourlyArrivals(const Date& fromDate, const Date& toDate,
+        const std::string& building = "");
+
+    // 首次使用时加载
+    bool ensureLoaded();
+
+    // 从visitor表重建
+    bool rebuild();
+
+    // 解析"YYYY-MM-DD HH:MM[:SS]"为自1970-01-01起的分钟数
+    static bool parseMinute(const std::string& dateTime, int32_t& minute);
+
+    // 分钟数格式化为"YYYY-MM-DD HH:MM"
+    static std::string formatMinute(int32_t minute);
+
+private:
+    VisitorTimeIndex() : loaded(false) {}
+    VisitorTimeIndex(const VisitorTimeIndex&) = delete;
+    VisitorTimeIndex& operator=(const VisitorTimeIndex&) = delete;
+
+    // 一次来访（24字节）
+    struct Entry {
+        int32_t start;          // 到访分钟
+        int32_t end;            // 离开分钟，未离开为OPEN_END
+        int64_t visitorId;
+        uint32_t dormCode;
+        uint32_t buildingCode;
+    };
+
+    // 一天的来访
+    struct DaySegment {
+        std::vector<Entry> entries;                       // 按start排序
+        int32_t maxEnd;                                   // 段内最晚离开时间（只增不减）
+        std::map<uint32_t, std::array<int, 24>> hourly;   // 楼栋 → 各小时到访数
+
+        DaySegment() : maxEnd(0) {}
+    };
+
+    // 字符串字典
+    struct Dictionary {
+        std::vector<std::string> names;
+        std::unordered_map<std::string, uint32_t> codes;
+
+        uint32_t encode(const std::string& name);
+        bool lookup(const std::string& name, uint32_t& code) const;
+    };
+
+    std::mutex indexMutex;
+    std::map<int32_t, DaySegment> days;                  // 日序号 → 日段
+    std::unordered_map<int64_t, int32_t> startOf;        // 访客ID → 到访分钟（定位日段）
+    // 停留超过一天的来访按（离开分钟, 访客ID）排序，查询只需从from之后离开的记录看起
+    std::map<std::pair<int32_t, int64_t>, Entry> longVisits;
+    // 未离开的来访按（到访分钟, 访客ID）单独维护（数量很少）
+    std::map<std::pair<int32_t, int64_t>, Entry> openVisits;
+    Dictionary dorms;
+    Dictionary buildings;
+    bool loaded;
+
+    // 以下均需持有indexMutex
+    void insertLocked(const Entry& entry);
+    bool eraseLocked(int64_t visitorId, Entry& removed);
+    VisitSpan toSpan(const Entry& entry) const;
+    bool buildingFilter(const std::string& building, bool& filtered, uint32_t& code) const;
+    void collectOverlapping(int32_t from, int32_t to, bool filtered, uint32_t code, std::vector<Entry>& out) const;
+};
+
+#endif // VISITORTIMEINDEX_H
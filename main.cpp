@@ -6,6 +6,18 @@
 #include "Common.h"
 #include "DBHelper.h"
 #include "AdminManager.h"
+#include "VisitorRegistry.h"
+#include "VisitorProfileIndex.h"
+#include "VisitorTimeIndex.h"
+#include "StatsService.h"
+#include "FeeRollup.h"
+#include "RepairAnalytics.h"
+#include "PageCache.h"
+#include "ViewModel.h"
+#include "AuditJournal.h"
+#include "ChangeFeed.h"
+#include "ExistenceCache.h"
+#include "RepairDedupIndex.h"
 
 #include "GUI.h"
 #include "MultiTableQueryTypes.h"
@@ -54,7 +66,16 @@ const int LOGIN_BOX_H = 220;
 const int LOGIN_BTN_W = 120;
 const int LOGIN_BTN_H = 40;
 
-AdminManager adminMgr; // 用于登录校验
+// 提示信息自动清除的时间（错误提示显示3秒，由主循环清除，不阻塞界面）
+bool g_tipTimed = false;
+std::chrono::steady_clock::time_point g_tipExpire;
+
+void showTimedTip(const std::string& tip, COLORREF color, int ms) {
+    g_tipMsg = tip;
+    g_tipColor = color;
+    g_tipTimed = true;
+    g_tipExpire = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+}
 
 // 在 Login 界面绘制简单 UI
 void drawLoginScreen(const std::string& tip, COLORREF tipColor);
@@ -104,18 +125,31 @@ bool handleLoginClick(int x, int y, std::string& outTip, COLORREF& outTipColor)
             return true;
         }
 
-        if (adminMgr.verifyLogin(adminId, pwd)) {
-            currentState = UIState::MAIN;
-            outTip = "";
-            outTipColor = BLACK;
-            return true;
-        }
-        else {
-            // 确保设置全局提示变量
-            g_tipMsg = "登录失败: " + adminMgr.getLastError();
-            g_tipColor = RED;
-            return true; // 触发重绘
-        }
+        // 登录校验交给视图模型的工作线程，完成后在主循环中切换界面
+        g_tipMsg = "正在登录...";
+        g_tipColor = BLACK;
+        g_tipTimed = false;
+        outTip = g_tipMsg;
+        outTipColor = g_tipColor;
+        ViewModel::getInstance().post([adminId, pwd]() -> ViewApply {
+            AdminManager adminMgr;
+            bool ok = adminMgr.verifyLogin(adminId, pwd);
+            std::string error = adminMgr.getLastError();
+            return [ok, error, adminId]() {
+                if (currentState != UIState::LOGIN) return;
+                if (ok) {
+                    AuditJournal::getInstance().setAdmin(adminId);
+                    currentState = UIState::MAIN;
+                    g_tipMsg = "";
+                    g_tipColor = BLACK;
+                    g_tipTimed = false;
+                }
+                else {
+                    showTimedTip("登录失败: " + error, RED, 3000);
+                }
+            };
+        });
+        return true; // 触发重绘
     }
 
     if (ptInRect(x, y, btnX2, btnY, LOGIN_BTN_W, LOGIN_BTN_H)) {
@@ -173,12 +207,9 @@ void dispatchMouseClick(int x, int y) {
             // 刷新界面显示
             FlushBatchDraw();
             
-            // 如果是错误提示，保持显示3秒
+            // 如果是错误提示，保持显示3秒后由主循环清除
             if (!g_tipMsg.empty() && g_tipColor == RED) {
-                Common::delay(3000);
-                g_tipMsg = "";
-                g_tipColor = BLACK;
-                drawCurrentScreen("", BLACK); // 清除提示
+                showTimedTip(g_tipMsg, g_tipColor, 3000);
             }
         }
         return;
@@ -211,7 +242,39 @@ void dispatchMouseClick(int x, int y) {
 
 }
 
-int main() {
+// 审计日志查看：DormManagementSystem --dump-audit [文件]，逐条输出后退出
+static int dumpAuditJournal(const std::string& path) {
+    long count = 0;
+    std::string error;
+    bool ok = AuditJournal::readJournal(path, [&count](const AuditRecord& record) {
+        std::cout << AuditJournal::formatRecord(record) << std::endl;
+        count++;
+    }, error);
+    if (!ok) {
+        std::cerr << "读取审计日志失败: " << error << std::endl;
+        return 1;
+    }
+    std::cout << "共" << count << "条记录" << std::endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--dump-audit") {
+        return dumpAuditJournal(argc >= 3 ? argv[2] : AUDIT_DEFAULT_PATH);
+    }
+
+    // 审计日志：增删改记录追加到本地文件，后台线程成组落盘
+    if (!AuditJournal::getInstance().start()) {
+        std::cerr << "审计日志启动失败: " << AuditJournal::getInstance().getLastError() << std::endl;
+    }
+
+    // 数据变更通知：缓存、统计和查重索引订阅各表的增删改，需在任何写操作前完成订阅
+    PageCacheVersion::subscribeChanges();
+    ExistenceCache::getInstance().subscribeChanges();
+    StatsService::getInstance().subscribeChanges();
+    RepairDedupIndex::getInstance().subscribeChanges();
+    ChangeFeed::getInstance().start();
+
     std::string dbHost = "127.0.0.1";
     std::string dbUser = "root";
     std::string dbPwd = "780219";
@@ -224,6 +287,22 @@ int main() {
     }
     else {
         std::cout << "数据库连接成功" << std::endl;
+        // 加载在访访客登记表
+        VisitorRegistry::getInstance().rebuild();
+        // 加载访客黑名单
+        VisitorProfileIndex::getInstance().loadBlacklist();
+        // 加载访客档案（此后来访登记/删除增量同步）
+        VisitorProfileIndex::getInstance().rebuildProfiles();
+        // 加载访客时间索引（时段统计使用，此后来访登记/离开/删除增量同步）
+        VisitorTimeIndex::getInstance().rebuild();
+        // 启动统计快照后台刷新（写操作增量维护，每60秒全量校准）
+        StatsService::getInstance().start(60);
+        // 后台预加载费用汇总和报修统计，统计页不必在界面线程等待全表扫描
+        ViewModel::getInstance().post([]() -> ViewApply {
+            FeeRollup::getInstance().ensureLoaded();
+            RepairAnalytics::getInstance().ensureLoaded();
+            return ViewApply();
+        });
     }
 
     initgraph(APP_WIN_W, APP_WIN_H);
@@ -250,8 +329,22 @@ int main() {
             }
         }
 
+        // 取回工作线程已完成的请求，列表界面只重绘变化的行
+        if (ViewModel::getInstance().pollResults() > 0 && !needRedraw) {
+            if (!refreshCurrentTable()) needRedraw = true;
+        }
+
+        // 到期的提示信息
+        if (g_tipTimed && std::chrono::steady_clock::now() >= g_tipExpire) {
+            g_tipTimed = false;
+            g_tipMsg = "";
+            g_tipColor = BLACK;
+            needRedraw = true;
+        }
+
         if (needRedraw) {
-            drawCurrentScreen("", BLACK);
+            // 提示参数只有登录界面使用，其他界面读取全局提示
+            drawCurrentScreen(currentState == UIState::LOGIN ? g_tipMsg : "", g_tipColor);
         }
 
         if (currentState == UIState::EXIT) break;
@@ -262,6 +355,11 @@ int main() {
     cleardevice();
     closegraph();
 
+    ViewModel::getInstance().stop();
+    PagePrefetcher::getInstance().stop();
+    ChangeFeed::getInstance().stop();
+    StatsService::getInstance().stop();
+    AuditJournal::getInstance().stop();
     if (DBHelper::getInstance().isConnected()) {
         DBHelper::getInstance().disconnect();
     }
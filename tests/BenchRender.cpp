@@ -0,0 +1,192 @@
+#include "TestUtil.h"
+#include "TableRender.h"
+#include <cstring>
+#include <string>
+#include <vector>
+
+//各管理界面表格的命令生成和无界面执行耗时，以及行级差异比较
+//  BenchRender          完整测量
+//  BenchRender --quick  只做正确性检查和少量迭代（make check使用）
+
+//与GUI.cpp中的表格布局一致
+static const int WINDOW_W = 1024;
+static const int WINDOW_H = 768;
+static const int ROW_H = 30;
+static const TableLayout LAYOUT(50, 160 + ROW_H, WINDOW_W - 100, ROW_H, WINDOW_W, WINDOW_H);
+
+static std::string digits(int value, int width) {
+    std::string s = std::to_string(value);
+    return s.size() < static_cast<size_t>(width) ? std::string(width - s.size(), '0') + s : s;
+}
+
+static std::vector<Student> makeStudents(int count) {
+    std::vector<Student> rows(count);
+    for (int i = 0; i < count; ++i) {
+        rows[i].studentId = "2024" + digits(i, 6);
+        rows[i].studentName = "学生" + std::to_string(i);
+        rows[i].gender = i % 2 ? "女" : "男";
+        rows[i].age = 18 + i % 5;
+        rows[i].major = "计算机科学与技术";
+        rows[i].dormId = "A" + digits(101 + i % 40, 3);
+        rows[i].checkInDate = Date(2024, 9, 1 + i % 28);
+        rows[i].studentPhone = "138" + digits(i, 8);
+    }
+    return rows;
+}
+
+static std::vector<Dorm> makeDorms(int count) {
+    std::vector<Dorm> rows(count);
+    for (int i = 0; i < count; ++i) {
+        rows[i].dormId = "A" + digits(101 + i, 3);
+        rows[i].building = "A栋";
+        rows[i].roomType = "四人间";
+        rows[i].maxCapacity = 4;
+        rows[i].currentOccupancy = i % 5;
+        rows[i].dormManager = "139" + digits(i, 8);
+    }
+    return rows;
+}
+
+static std::vector<Fee> makeFees(int count) {
+    std::vector<Fee> rows(count);
+    for (int i = 0; i < count; ++i) {
+        rows[i].feeId = std::to_string(1000 + i);
+        rows[i].studentId = "2024" + digits(i, 6);
+        rows[i].dormId = "A" + digits(101 + i % 40, 3);
+        rows[i].feeMonth = "2024-" + digits(1 + i % 12, 2);
+        rows[i].waterFee = 12.5 + i % 7;
+        rows[i].electricFee = 40.25 + i % 11;
+        rows[i].totalFee = rows[i].waterFee + rows[i].electricFee;
+        rows[i].payStatus = i % 3 ? PayStatus::PAID : PayStatus::UNPAID;
+        rows[i].payDate = rows[i].payStatus == PayStatus::PAID ? Date(2024, 10, 1 + i % 28) : Date();
+    }
+    return rows;
+}
+
+static std::vector<Repair> makeRepairs(int count) {
+    std::vector<Repair> rows(count);
+    for (int i = 0; i < count; ++i) {
+        rows[i].repairId = std::to_string(500 + i);
+        rows[i].studentId = "2024" + digits(i, 6);
+        rows[i].dormId = "A" + digits(101 + i % 40, 3);
+        rows[i].repairContent = "水龙头漏水";
+        rows[i].repairDate = Date(2024, 10, 1 + i % 28);
+        rows[i].handleStatus = static_cast<RepairStatus>(i % 3);
+        rows[i].handleDate = rows[i].handleStatus == RepairStatus::UNHANDLED ? Date() : Date(2024, 11, 1 + i % 28);
+    }
+    return rows;
+}
+
+static std::vector<Visitor> makeVisitors(int count) {
+    std::vector<Visitor> rows(count);
+    for (int i = 0; i < count; ++i) {
+        rows[i].visitorId = std::to_string(800 + i);
+        rows[i].visitorName = "访客" + std::to_string(i);
+        rows[i].gender = i % 2 ? "女" : "男";
+        rows[i].idCard = "11010519900101" + digits(i, 4);
+        rows[i].dormId = "A" + digits(101 + i % 40, 3);
+        rows[i].visitReason = "探望";
+        rows[i].visitTime = "2024-10-01 09:" + digits(i % 60, 2) + ":00";
+        rows[i].leaveTime = i % 2 ? "2024-10-01 11:30:00" : "";
+        rows[i].registerAdmin = "admin";
+    }
+    return rows;
+}
+
+static void report(const char* name, int rows, const RenderBenchResult& r) {
+    std::printf("%-8s %5d rows  %4zu cmds %4zu regions  build %8.2f us  submit %8.2f us  (%d frames)\n",
+        name, rows, r.commandCount, r.regionCount, r.buildMicros, r.submitMicros, r.iterations);
+}
+
+//测量一页表格加页码的生成和执行
+template <typename T>
+static void benchScreen(const char* name, const std::vector<T>& rows, int colCount, int iterations,
+    void (*buildRows)(RenderList&, const TableLayout&, const std::vector<T>&)) {
+    PageParam page;
+    page.pageSize = static_cast<int>(rows.size());
+    page.totalCount = page.pageSize * 7;
+    page.calcTotalPage();
+    RenderBenchResult r = benchmarkRender([&](RenderList& list) {
+        buildRows(list, LAYOUT, rows);
+        buildPageInfo(list, LAYOUT, page, false);
+    }, iterations);
+    report(name, static_cast<int>(rows.size()), r);
+
+    //每行一个区域、每格一条文字命令，外加页码区域
+    CHECK_EQ(r.iterations, iterations);
+    CHECK_EQ(r.regionCount, rows.size() + 1);
+    CHECK_EQ(r.commandCount, rows.size() * colCount + 1);
+}
+
+//改动一行后只有该行区域变化，局部重绘只执行该行的命令
+static void checkDiff() {
+    std::vector<Fee> fees = makeFees(10);
+    PageParam page;
+    page.totalCount = 95;
+    page.calcTotalPage();
+
+    RenderList previous, current;
+    buildFeeRows(previous, LAYOUT, fees);
+    buildPageInfo(previous, LAYOUT, page, false);
+    buildFeeRows(current, LAYOUT, fees);
+    buildPageInfo(current, LAYOUT, page, false);
+    CHECK(current.diffRegions(previous).empty());
+
+    //第4行改为已付
+    fees[3].payStatus = PayStatus::PAID;
+    fees[3].payDate = Date(2024, 10, 20);
+    current.clear();
+    buildFeeRows(current, LAYOUT, fees);
+    buildPageInfo(current, LAYOUT, page, false);
+    std::vector<int> changed = current.diffRegions(previous);
+    CHECK_EQ(changed.size(), 1u);
+    if (!changed.empty()) CHECK_EQ(changed[0], 3);
+
+    HeadlessBackend backend;
+    backend.submitRegions(current, previous, changed);
+    //背景覆盖1次贴图 + 该行9列文字
+    CHECK_EQ(backend.getCount(RenderOp::IMAGE), 1u);
+    CHECK_EQ(backend.getCount(RenderOp::TEXT), 9u);
+
+    //加载状态只影响页码区域
+    current.clear();
+    buildFeeRows(current, LAYOUT, fees);
+    buildPageInfo(current, LAYOUT, page, true);
+    changed = current.diffRegions(previous);
+    CHECK_EQ(changed.size(), 2u);
+    if (changed.size() == 2) {
+        CHECK_EQ(changed[0], 3);
+        CHECK_EQ(changed[1], PAGE_INFO_REGION);
+    }
+
+    //末页行数减少：消失的行也要重绘（用背景覆盖）
+    fees.resize(5);
+    current.clear();
+    buildFeeRows(current, LAYOUT, fees);
+    buildPageInfo(current, LAYOUT, page, false);
+    changed = current.diffRegions(previous);
+    std::vector<int> expected = { 3, 5, 6, 7, 8, 9 };
+    CHECK(changed == expected);
+    backend.reset();
+    backend.submitRegions(current, previous, { 7 });
+    CHECK_EQ(backend.getCount(RenderOp::IMAGE), 1u);
+    CHECK_EQ(backend.getCount(RenderOp::TEXT), 0u);
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+    int iterations = quick ? 10 : 2000;
+
+    checkDiff();
+
+    //每页10行为界面实际页大小，100行用于观察随行数的增长
+    const int sizes[] = { 10, 100 };
+    for (int rows : sizes) {
+        benchScreen("student", makeStudents(rows), 8, iterations, buildStudentRows);
+        benchScreen("dorm", makeDorms(rows), 6, iterations, buildDormRows);
+        benchScreen("fee", makeFees(rows), 9, iterations, buildFeeRows);
+        benchScreen("repair", makeRepairs(rows), 7, iterations, buildRepairRows);
+        benchScreen("visitor", makeVisitors(rows), 9, iterations, buildVisitorRows);
+    }
+    return testResult("BenchRender");
+}
@@ -0,0 +1,267 @@
+#include "TestUtil.h"
+#include "BatchValidation.h"
+#include "Common.h"
+#include <string>
+#include <vector>
+
+//批量校验内核必须与Common::isValidXxx逐行一致（参考实现）
+//字符串只用转义写非ASCII字节，避免源文件编码影响测试数据
+
+static const char SPACES[] = " \t\n\v\f\r";
+
+//随机字节：数字占多数，夹杂空白、字母、X/x、高位字节和'\0'
+static char randomByte(TestRandom& rng) {
+    switch (rng.below(10)) {
+    case 0: return SPACES[rng.below(6)];
+    case 1: return static_cast<char>(0x80 + rng.below(128));
+    case 2: return rng.below(2) ? 'X' : 'x';
+    case 3: return static_cast<char>(rng.below(2) ? 'a' + rng.below(26) : 'A' + rng.below(26));
+    case 4: return static_cast<char>(rng.below(128));
+    default: return static_cast<char>('0' + rng.below(10));
+    }
+}
+
+static std::string randomDigits(TestRandom& rng, size_t len) {
+    std::string s;
+    for (size_t i = 0; i < len; ++i) s += static_cast<char>('0' + rng.below(10));
+    return s;
+}
+
+//首尾随机加空白
+static std::string pad(TestRandom& rng, const std::string& s) {
+    std::string out;
+    for (uint32_t n = rng.below(3); n > 0; --n) out += SPACES[rng.below(6)];
+    out += s;
+    for (uint32_t n = rng.below(3); n > 0; --n) out += SPACES[rng.below(6)];
+    return out;
+}
+
+//对合法样本做一处小改动：替换、插入或删除一个字节
+static std::string mutate(TestRandom& rng, std::string s) {
+    switch (rng.below(4)) {
+    case 0:
+        if (!s.empty()) s[rng.below(static_cast<uint32_t>(s.size()))] = randomByte(rng);
+        break;
+    case 1:
+        s.insert(s.begin() + rng.below(static_cast<uint32_t>(s.size() + 1)), randomByte(rng));
+        break;
+    case 2:
+        if (!s.empty()) s.erase(s.begin() + rng.below(static_cast<uint32_t>(s.size())));
+        break;
+    default:
+        break;
+    }
+    return s;
+}
+
+static std::string randomNoise(TestRandom& rng) {
+    //长度集中在7/10/11/18附近
+    static const size_t lens[] = { 0, 1, 6, 7, 8, 9, 10, 11, 12, 16, 17, 18, 19, 20, 21, 40 };
+    size_t len = lens[rng.below(sizeof(lens) / sizeof(lens[0]))];
+    std::string s;
+    for (size_t i = 0; i < len; ++i) s += randomByte(rng);
+    return s;
+}
+
+static std::string makeStudentId(TestRandom& rng) {
+    std::string s = std::to_string(2017 + rng.below(16)) + randomDigits(rng, 3);
+    return rng.below(3) == 0 ? mutate(rng, s) : s;
+}
+
+static std::string makePhone(TestRandom& rng) {
+    static const char* prefixes[] = { "13", "14", "15", "16", "17", "18", "19", "12", "10" };
+    std::string s = prefixes[rng.below(9)] + randomDigits(rng, 9);
+    if (rng.below(8) == 0) return std::string(rng.below(4), ' ');   //空白串（选填）
+    return rng.below(3) == 0 ? mutate(rng, s) : s;
+}
+
+//生成带正确或错误校验码的18位身份证号
+static std::string makeIdCard(TestRandom& rng) {
+    static const int weights[17] = { 7, 9, 10, 5, 8, 4, 2, 1, 6, 3, 7, 9, 10, 5, 8, 4, 2 };
+    static const char checkCodes[] = "10X98765432";
+    std::string s = randomDigits(rng, 17);
+    int sum = 0;
+    for (int i = 0; i < 17; ++i) sum += (s[i] - '0') * weights[i];
+    char check = checkCodes[sum % 11];
+    if (check == 'X' && rng.below(2)) check = 'x';
+    if (rng.below(3) == 0) check = "0123456789Xx"[rng.below(12)];
+    s += check;
+    return rng.below(3) == 0 ? mutate(rng, s) : s;
+}
+
+//GB2312汉字（两字节都在0xA1以上）和字母的组合，含区间边界字节
+static std::string makeName(TestRandom& rng) {
+    static const unsigned char leads[] = { 0xA0, 0xA1, 0xB0, 0xD7, 0xF7, 0xF8, 0xFE, 0xFF };
+    static const unsigned char trails[] = { 0xA0, 0xA1, 0xC0, 0xFE, 0xFF, 0x40, 0x7E };
+    std::string s;
+    uint32_t parts = 1 + rng.below(11);
+    for (uint32_t i = 0; i < parts; ++i) {
+        uint32_t kind = rng.below(5);
+        if (kind <= 1) {
+            s += static_cast<char>(0xA1 + rng.below(0xF7 - 0xA1 + 1));
+            s += static_cast<char>(0xA1 + rng.below(0xFE - 0xA1 + 1));
+        }
+        else if (kind == 2) {
+            s += static_cast<char>(leads[rng.below(sizeof(leads))]);
+            if (rng.below(4) != 0) s += static_cast<char>(trails[rng.below(sizeof(trails))]);
+        }
+        else {
+            s += static_cast<char>(rng.below(2) ? 'a' + rng.below(26) : 'A' + rng.below(26));
+        }
+    }
+    return rng.below(4) == 0 ? mutate(rng, s) : s;
+}
+
+static std::string makeDate(TestRandom& rng) {
+    int year = 1995 + static_cast<int>(rng.below(110));
+    int month = static_cast<int>(rng.below(14));
+    int day = static_cast<int>(rng.below(33));
+    char buf[32];
+    if (rng.below(6) == 0) std::snprintf(buf, sizeof(buf), "%d-%d-%d", year, month, day);   //未补0
+    else std::snprintf(buf, sizeof(buf), "%04d-%02d-%02d", year, month, day);
+    std::string s = buf;
+    //2月29日和大小月边界
+    if (rng.below(8) == 0) s = std::to_string(1996 + rng.below(110)) + "-02-29";
+    return rng.below(4) == 0 ? mutate(rng, s) : s;
+}
+
+typedef std::string (*Generator)(TestRandom&);
+
+static std::vector<std::string> makeColumn(TestRandom& rng, size_t count, Generator generate) {
+    std::vector<std::string> column;
+    column.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t kind = rng.below(10);
+        if (kind == 0) column.push_back(randomNoise(rng));
+        else if (kind <= 3) column.push_back(pad(rng, generate(rng)));
+        else column.push_back(generate(rng));
+    }
+    return column;
+}
+
+//逐行比较位图与参考实现，并核对计数和首个非法行
+template <typename Scalar>
+static void compare(const char* name, const std::vector<std::string>& column, const RowBitmap& bitmap, Scalar scalar) {
+    CHECK_EQ(bitmap.size(), (column.size() + 63) / 64);
+    size_t expectedValid = 0;
+    size_t expectedFirst = column.size();
+    int reported = 0;
+    for (size_t i = 0; i < column.size(); ++i) {
+        bool expected = scalar(column[i]);
+        bool actual = i / 64 < bitmap.size() && BatchValidation::isValid(bitmap, i);
+        CHECK_EQ(actual, expected);
+        if (actual != expected && reported++ < 5) {
+            std::string hex;
+            for (unsigned char c : column[i]) {
+                char buf[4];
+                std::snprintf(buf, sizeof(buf), "%02X ", c);
+                hex += buf;
+            }
+            std::fprintf(stderr, "  %s row %zu: expected %d [%s]\n", name, i, expected ? 1 : 0, hex.c_str());
+        }
+        if (expected) expectedValid++;
+        else if (expectedFirst == column.size()) expectedFirst = i;
+    }
+    if (bitmap.size() != (column.size() + 63) / 64) return;
+    CHECK_EQ(BatchValidation::countValid(bitmap, column.size()), expectedValid);
+    CHECK_EQ(BatchValidation::firstInvalid(bitmap, column.size()), expectedFirst);
+}
+
+static std::vector<StrRef> refsOf(const std::vector<std::string>& column) {
+    return std::vector<StrRef>(column.begin(), column.end());
+}
+
+int main() {
+    //包含不是64整数倍的行数
+    const size_t sizes[] = { 0, 1, 2, 15, 16, 17, 63, 64, 65, 127, 128, 129, 1000, 4097 };
+    uint64_t seed = 1;
+    for (size_t count : sizes) {
+        TestRandom rng(++seed * 7919);
+        RowBitmap bitmap;
+
+        std::vector<std::string> ids = makeColumn(rng, count, makeStudentId);
+        std::vector<StrRef> idRefs = refsOf(ids);
+        BatchValidation::validateStudentIds(idRefs.data(), count, bitmap);
+        compare("studentId", ids, bitmap, [](const std::string& s) { return Common::isValidStudentID(s); });
+
+        std::vector<std::string> phones = makeColumn(rng, count, makePhone);
+        std::vector<StrRef> phoneRefs = refsOf(phones);
+        BatchValidation::validatePhones(phoneRefs.data(), count, bitmap);
+        compare("phone", phones, bitmap, [](const std::string& s) { return Common::isValidPhone(s); });
+        RowBitmap optionalPhones;
+        BatchValidation::validatePhones(phoneRefs.data(), count, optionalPhones, true);
+        compare("phone(allowEmpty)", phones, optionalPhones, [](const std::string& s) {
+            return Common::trim(s).empty() || Common::isValidPhone(s);
+        });
+
+        std::vector<std::string> cards = makeColumn(rng, count, makeIdCard);
+        std::vector<StrRef> cardRefs = refsOf(cards);
+        BatchValidation::validateIDCards(cardRefs.data(), count, bitmap);
+        compare("idCard", cards, bitmap, [](const std::string& s) { return Common::isValidIDCard(s); });
+        RowBitmap checksumBitmap;
+        BatchValidation::validateIDCards(cardRefs.data(), count, checksumBitmap, true);
+        compare("idCard(checksum)", cards, checksumBitmap, [](const std::string& s) {
+            return Common::isValidIDCardChecksum(s);
+        });
+
+        std::vector<std::string> names = makeColumn(rng, count, makeName);
+        std::vector<StrRef> nameRefs = refsOf(names);
+        BatchValidation::validateNames(nameRefs.data(), count, bitmap);
+        compare("name", names, bitmap, [](const std::string& s) { return Common::isValidName(s); });
+
+        std::vector<std::string> dates = makeColumn(rng, count, makeDate);
+        std::vector<StrRef> dateRefs = refsOf(dates);
+        BatchValidation::validateDates(dateRefs.data(), count, bitmap);
+        compare("date", dates, bitmap, [](const std::string& s) { return Common::isValidDate(s); });
+
+        //两列位图求交
+        RowBitmap both = optionalPhones;
+        BatchValidation::intersect(both, checksumBitmap);
+        size_t expectedBoth = 0;
+        for (size_t i = 0; i < count; ++i) {
+            bool expected = (Common::trim(phones[i]).empty() || Common::isValidPhone(phones[i]))
+                && Common::isValidIDCardChecksum(cards[i]);
+            CHECK_EQ(BatchValidation::isValid(both, i), expected);
+            if (expected) expectedBoth++;
+        }
+        CHECK_EQ(BatchValidation::countValid(both, count), expectedBoth);
+    }
+
+    //固定样例：空白裁剪、长度边界和高位字节
+    struct Case { const char* text; size_t len; };
+    const Case fixed[] = {
+        { "2024001", 7 }, { " 2024001\t", 9 }, { "2019001", 7 }, { "2031001", 7 }, { "202400", 6 }, { "20240011", 8 },
+        { "13800138000", 11 }, { "\r\n13800138000 ", 14 }, { "12800138000", 11 }, { "1380013800", 10 },
+        { "138001380001", 12 }, { "1380013800\xB0", 11 },
+        { "11010519491231002X", 18 }, { "11010519491231002x", 18 }, { "110105194912310021", 18 },
+        { "1101051949123100X2", 18 }, { "11010519491231002", 17 }, { " 11010519491231002X ", 20 },
+        { "\xD5\xC5\xC8\xFD", 4 }, { "\xD5\xC5", 2 }, { "\xD5", 1 }, { "\xD5\xC5\xC8", 3 }, { "Tom", 3 },
+        { "\xA0\xA1\xA1\xA1", 4 }, { "\xF8\xA1\xA1\xA1", 4 }, { "\xA1\xFF\xA1\xA1", 4 }, { "Li\xD5\xC5", 4 },
+        { "2024-02-29", 10 }, { "2023-02-29", 10 }, { "2024-13-01", 10 }, { " 2024-01-01", 11 }, { "2024-1-01", 9 },
+        { "1999-12-31", 10 }, { "2100-12-31", 10 }, { "2101-01-01", 10 }, { "2024-01-01\0", 11 }, { "", 0 },
+        { "   ", 3 }, { "\x80\x81\x82\x83\x84\x85\x86", 7 },
+    };
+    std::vector<std::string> column;
+    for (const auto& c : fixed) column.push_back(std::string(c.text, c.len));
+    std::vector<StrRef> refs = refsOf(column);
+    RowBitmap bitmap;
+    BatchValidation::validateStudentIds(refs.data(), column.size(), bitmap);
+    compare("fixed studentId", column, bitmap, [](const std::string& s) { return Common::isValidStudentID(s); });
+    BatchValidation::validatePhones(refs.data(), column.size(), bitmap);
+    compare("fixed phone", column, bitmap, [](const std::string& s) { return Common::isValidPhone(s); });
+    BatchValidation::validateIDCards(refs.data(), column.size(), bitmap);
+    compare("fixed idCard", column, bitmap, [](const std::string& s) { return Common::isValidIDCard(s); });
+    BatchValidation::validateIDCards(refs.data(), column.size(), bitmap, true);
+    compare("fixed idCard(checksum)", column, bitmap, [](const std::string& s) { return Common::isValidIDCardChecksum(s); });
+    BatchValidation::validateNames(refs.data(), column.size(), bitmap);
+    compare("fixed name", column, bitmap, [](const std::string& s) { return Common::isValidName(s); });
+    BatchValidation::validateDates(refs.data(), column.size(), bitmap);
+    compare("fixed date", column, bitmap, [](const std::string& s) { return Common::isValidDate(s); });
+
+    //固定样例中确定合法的几项
+    CHECK(Common::isValidStudentID(" 2024001\t"));
+    CHECK(Common::isValidIDCardChecksum("11010519491231002X"));
+    CHECK(Common::isValidName("\xD5\xC5\xC8\xFD"));
+    CHECK(!Common::isValidDate(" 2024-01-01"));
+    return testResult("TestBatchValidation");
+}
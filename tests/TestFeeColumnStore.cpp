@@ -0,0 +1,117 @@
+#include "TestUtil.h"
+#include "FeeColumnStore.h"
+#include <map>
+#include <string>
+#include <vector>
+
+//FeeColumnStore的AVX2内核与标量内核、以及逐行计算的参考结果必须一致
+
+struct Row {
+    std::string month;
+    std::string dorm;
+    std::string building;
+    int64_t cents;
+    bool paid;
+};
+
+//逐行累加的参考实现
+static void addRow(FeeGroupTotals& t, const Row& row) {
+    t.totalCents += row.cents;
+    if (row.paid) {
+        t.paidCents += row.cents;
+        t.paidCount++;
+    }
+    else {
+        t.unpaidCents += row.cents;
+        t.unpaidCount++;
+    }
+}
+
+static bool sameTotals(const FeeGroupTotals& a, const FeeGroupTotals& b) {
+    return a.totalCents == b.totalCents && a.paidCents == b.paidCents && a.unpaidCents == b.unpaidCents
+        && a.paidCount == b.paidCount && a.unpaidCount == b.unpaidCount;
+}
+
+static void checkGroups(const std::vector<FeeGroupTotals>& actual, const std::map<std::string, FeeGroupTotals>& expected) {
+    CHECK_EQ(actual.size(), expected.size());
+    for (const auto& group : actual) {
+        auto it = expected.find(group.key);
+        CHECK(it != expected.end());
+        if (it != expected.end()) CHECK(sameTotals(group, it->second));
+    }
+}
+
+static std::vector<Row> makeRows(size_t count, uint64_t seed) {
+    TestRandom rng(seed);
+    std::vector<Row> rows;
+    rows.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        Row row;
+        int month = static_cast<int>(rng.below(18));
+        row.month = std::to_string(2023 + month / 12) + "-" + (month % 12 < 9 ? "0" : "") + std::to_string(month % 12 + 1);
+        uint32_t dorm = rng.below(60);
+        row.dorm = "D" + std::to_string(100 + dorm);
+        row.building = "B" + std::to_string(dorm % 7);
+        //含0和大金额，检查64位累加
+        row.cents = rng.below(10) == 0 ? 0 : static_cast<int64_t>(rng.next() % 5000000000ull);
+        row.paid = rng.below(3) != 0;
+        rows.push_back(row);
+    }
+    return rows;
+}
+
+static void checkStore(const FeeColumnStore& store, const std::vector<Row>& rows) {
+    FeeGroupTotals all;
+    std::map<std::string, FeeGroupTotals> byMonth, byBuilding;
+    std::map<std::string, std::map<std::string, FeeGroupTotals>> buildingOfMonth, dormOfMonth;
+    for (const auto& row : rows) {
+        addRow(all, row);
+        addRow(byMonth[row.month], row);
+        addRow(byBuilding[row.building], row);
+        addRow(buildingOfMonth[row.month][row.building], row);
+        addRow(dormOfMonth[row.month][row.dorm], row);
+    }
+
+    CHECK_EQ(store.size(), rows.size());
+    CHECK(sameTotals(store.totals(), all));
+    checkGroups(store.groupByMonth(), byMonth);
+    checkGroups(store.groupByBuilding(), byBuilding);
+    for (const auto& item : buildingOfMonth) checkGroups(store.groupByBuilding(item.first), item.second);
+    for (const auto& item : dormOfMonth) checkGroups(store.groupByDorm(item.first), item.second);
+    CHECK(store.groupByBuilding("1999-01").empty());
+    CHECK(store.groupByDorm("1999-01").empty());
+}
+
+int main() {
+    bool hasAvx2 = FeeColumnStore::isSimdEnabled();
+    std::printf("AVX2 kernel: %s\n", hasAvx2 ? "available" : "not available, scalar only");
+
+    //覆盖位图字边界（63/64/65）和4行对齐边界
+    const size_t sizes[] = { 0, 1, 3, 4, 5, 63, 64, 65, 127, 129, 1000, 4099, 200003 };
+    for (size_t count : sizes) {
+        std::vector<Row> rows = makeRows(count, 1000 + count);
+        FeeColumnStore store;
+        for (const auto& row : rows) store.append(row.month, row.dorm, row.building, row.cents, row.paid);
+        store.finalize();
+
+        FeeColumnStore::setSimdEnabled(true);
+        checkStore(store, rows);
+        FeeColumnStore::setSimdEnabled(false);
+        checkStore(store, rows);
+        FeeColumnStore::setSimdEnabled(true);
+
+        //finalize之后追加：已有行重新编码后结果不变
+        std::vector<Row> more = makeRows(count / 3 + 1, 7 + count);
+        for (const auto& row : more) store.append(row.month, row.dorm, row.building, row.cents, row.paid);
+        store.finalize();
+        rows.insert(rows.end(), more.begin(), more.end());
+        checkStore(store, rows);
+        FeeColumnStore::setSimdEnabled(false);
+        checkStore(store, rows);
+        FeeColumnStore::setSimdEnabled(true);
+    }
+
+    //没有AVX2时开关不生效
+    if (!hasAvx2) CHECK(!FeeColumnStore::isSimdEnabled());
+    return testResult("TestFeeColumnStore");
+}
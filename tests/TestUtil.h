@@ -0,0 +1,46 @@
+// 测试程序共用的检查宏：失败时打印位置并计数，main最后返回testResult()
+#ifndef TESTS_TESTUTIL_H
+#define TESTS_TESTUTIL_H
+
+#include <cstdio>
+#include <cstdint>
+
+static int g_checks = 0;
+static int g_failures = 0;
+
+#define CHECK(cond) do { \
+    ++g_checks; \
+    if (!(cond)) { \
+        ++g_failures; \
+        if (g_failures <= 50) std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+    } \
+} while (0)
+
+#define CHECK_EQ(a, b) CHECK((a) == (b))
+
+// 打印汇总，返回进程退出码
+static int testResult(const char* name) {
+    std::printf("%s: %d checks, %d failures\n", name, g_checks, g_failures);
+    return g_failures == 0 ? 0 : 1;
+}
+
+// 可复现的伪随机数（xorshift64*）
+class TestRandom {
+public:
+    explicit TestRandom(uint64_t seed) : state(seed ? seed : 0x9E3779B97F4A7C15ull) {}
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // [0, n)
+    uint32_t below(uint32_t n) { return n == 0 ? 0 : static_cast<uint32_t>(next() % n); }
+
+private:
+    uint64_t state;
+};
+
+#endif // TESTS_TESTUTIL_H
@@ -0,0 +1,194 @@
+#include "TestUtil.h"
+#include "ViewModel.h"
+#include "PageCache.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//ViewModel请求队列和结果信箱的顺序、满队列处理，以及ListViewModel丢弃过期结果
+
+//界面线程轮询直到没有未取回的请求（最多等5秒）
+static bool pollUntilIdle() {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (ViewModel::getInstance().isLoading()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        if (ViewModel::getInstance().pollResults() == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+//等待工作线程进入某个任务
+static bool waitFor(const std::atomic<bool>& flag) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!flag.load()) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+static void testOrderAndQueueFull() {
+    ViewModel& vm = ViewModel::getInstance();
+    CHECK_EQ(vm.pollResults(), 0);
+    CHECK(!vm.isLoading());
+
+    //第一个任务阻塞工作线程，其余请求留在队列中
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::atomic<bool> blocked(false);
+    std::vector<int> workOrder;     //只在工作线程写
+    std::vector<int> applyOrder;    //只在界面线程写
+    uint64_t firstId = vm.post([&, opened]() -> ViewApply {
+        blocked.store(true);
+        opened.wait();
+        workOrder.push_back(0);
+        return [&applyOrder]() { applyOrder.push_back(0); };
+    });
+    CHECK(firstId != 0);
+    CHECK(waitFor(blocked));
+    CHECK(vm.isLoading());
+
+    //请求队列容量64，满后post返回0且不占用请求号
+    std::vector<uint64_t> ids;
+    for (int i = 1; i <= 100; ++i) {
+        uint64_t id = vm.post([&workOrder, &applyOrder, i]() -> ViewApply {
+            workOrder.push_back(i);
+            return [&applyOrder, i]() { applyOrder.push_back(i); };
+        });
+        if (id == 0) break;
+        ids.push_back(id);
+    }
+    CHECK_EQ(ids.size(), 64u);
+    for (size_t i = 0; i < ids.size(); ++i) CHECK_EQ(ids[i], firstId + 1 + i);
+    CHECK_EQ(vm.post([]() -> ViewApply { return ViewApply(); }), 0u);
+
+    //未放行前没有结果可取
+    CHECK_EQ(vm.pollResults(), 0);
+
+    gate.set_value();
+    //信箱容量同为64，工作线程在信箱满时等待界面线程取走
+    CHECK(pollUntilIdle());
+    CHECK_EQ(workOrder.size(), 65u);
+    CHECK_EQ(applyOrder.size(), 65u);
+    for (size_t i = 0; i < applyOrder.size(); ++i) {
+        CHECK_EQ(applyOrder[i], static_cast<int>(i));
+        if (i < workOrder.size()) CHECK_EQ(workOrder[i], static_cast<int>(i));
+    }
+
+    //队列腾空后恢复投递，请求号接着满队列之前的编号
+    uint64_t nextId = vm.post([]() -> ViewApply { return ViewApply(); });
+    CHECK_EQ(nextId, ids.back() + 1);
+    CHECK(pollUntilIdle());
+
+    //pollResults遵守maxCount，空收尾操作也计数
+    std::atomic<bool> started(false);
+    std::promise<void> gate2;
+    std::shared_future<void> opened2 = gate2.get_future().share();
+    vm.post([&started, opened2]() -> ViewApply {
+        started.store(true);
+        opened2.wait();
+        return ViewApply();
+    });
+    for (int i = 0; i < 3; ++i) vm.post([]() -> ViewApply { return ViewApply(); });
+    CHECK(waitFor(started));
+    gate2.set_value();
+    while (vm.isLoading()) {
+        int handled = vm.pollResults(1);
+        CHECK(handled <= 1);
+        if (handled == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static void testListDropsStaleResult() {
+    //第1页的加载阻塞，期间请求第2页；第1页结果晚到时必须被丢弃
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::atomic<bool> page1Loading(false);
+    PageCache<int> cache(PageScreen::STUDENT,
+        [opened, &page1Loading](const PageParam& param) {
+            if (param.pageIndex == 1) {
+                page1Loading.store(true);
+                opened.wait();
+            }
+            std::vector<int> rows;
+            //共95行，末页不满
+            for (int i = 0; i < param.pageSize && (param.pageIndex - 1) * param.pageSize + i < 95; ++i) {
+                rows.push_back(param.pageIndex * 100 + i);
+            }
+            return rows;
+        },
+        []() { return 95; });
+
+    ListViewModel<int> list(cache);
+    PageParam page1;
+    page1.pageIndex = 1;
+    PageParam page2;
+    page2.pageIndex = 2;
+
+    list.request("", page1);
+    CHECK(list.isLoading());
+    CHECK(waitFor(page1Loading));
+    list.request("", page2);
+    //同一请求未返回时不重复投递
+    list.request("", page2);
+    CHECK(list.getRows().empty());
+
+    gate.set_value();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    int applied = 0;
+    while (applied < 2 && std::chrono::steady_clock::now() < deadline) {
+        int handled = ViewModel::getInstance().pollResults(1);
+        if (handled == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        applied++;
+        if (applied == 1) {
+            //第1页结果已过期：不替换数据，仍在等待第2页
+            CHECK(list.getRows().empty());
+            CHECK(list.isLoading());
+        }
+    }
+    CHECK_EQ(applied, 2);
+    CHECK(!ViewModel::getInstance().isLoading());
+    CHECK(!list.isLoading());
+    CHECK_EQ(list.getPageIndex(), 2);
+    CHECK_EQ(list.getTotalCount(), 95);
+    CHECK_EQ(list.getRows().size(), 10u);
+    if (!list.getRows().empty()) CHECK_EQ(list.getRows().front(), 200);
+
+    //已加载的页再次请求不投递
+    list.request("", page2);
+    CHECK(!list.isLoading());
+    CHECK(!ViewModel::getInstance().isLoading());
+
+    //页码超出范围时按修正后的末页加载，原页码也视为已加载
+    PageParam page99;
+    page99.pageIndex = 99;
+    list.request("", page99);
+    CHECK(pollUntilIdle());
+    CHECK_EQ(list.getPageIndex(), 10);
+    CHECK_EQ(list.getRows().size(), 5u);
+    list.request("", page99);
+    CHECK(!list.isLoading());
+
+    //缓存版本变化后同一页重新加载
+    PageCacheVersion::invalidate(PageScreen::STUDENT);
+    list.request("", page99);
+    CHECK(list.isLoading());
+    CHECK(pollUntilIdle());
+    CHECK(!list.isLoading());
+
+    //程序中的分页缓存是全局对象；这里缓存是局部的，预取任务持有其指针，返回前停掉预取线程
+    PagePrefetcher::getInstance().stop();
+}
+
+int main() {
+    testOrderAndQueueFull();
+    testListDropsStaleResult();
+    ViewModel::getInstance().stop();
+    return testResult("TestViewModel");
+}
@@ -0,0 +1,36 @@
+#include "mysql.h"
+
+//离线实现：连接总是失败，其余调用返回错误或空结果
+static const unsigned int CR_CONN_HOST_ERROR = 2003;
+
+MYSQL* mysql_init(MYSQL* mysql) {
+    static MYSQL shared;
+    return mysql != nullptr ? mysql : &shared;
+}
+
+int mysql_options(MYSQL*, mysql_option, const void*) { return 0; }
+
+MYSQL* mysql_real_connect(MYSQL*, const char*, const char*, const char*, const char*, unsigned int,
+    const char*, unsigned long) {
+    return nullptr;
+}
+
+unsigned int mysql_errno(MYSQL*) { return CR_CONN_HOST_ERROR; }
+const char* mysql_error(MYSQL*) { return "offline test build: no MySQL server"; }
+int mysql_set_character_set(MYSQL*, const char*) { return 1; }
+bool mysql_autocommit(MYSQL*, bool) { return true; }
+void mysql_close(MYSQL*) {}
+int mysql_query(MYSQL*, const char*) { return 1; }
+my_ulonglong mysql_affected_rows(MYSQL*) { return static_cast<my_ulonglong>(-1); }
+my_ulonglong mysql_insert_id(MYSQL*) { return 0; }
+bool mysql_commit(MYSQL*) { return true; }
+bool mysql_rollback(MYSQL*) { return true; }
+MYSQL_RES* mysql_store_result(MYSQL*) { return nullptr; }
+MYSQL_RES* mysql_use_result(MYSQL*) { return nullptr; }
+unsigned int mysql_field_count(MYSQL*) { return 0; }
+unsigned int mysql_num_fields(MYSQL_RES*) { return 0; }
+MYSQL_FIELD* mysql_fetch_fields(MYSQL_RES*) { return nullptr; }
+MYSQL_ROW mysql_fetch_row(MYSQL_RES*) { return nullptr; }
+unsigned long* mysql_fetch_lengths(MYSQL_RES*) { return nullptr; }
+my_ulonglong mysql_num_rows(MYSQL_RES*) { return 0; }
+void mysql_free_result(MYSQL_RES*) {}
@@ -0,0 +1,46 @@
+// 测试用的MySQL客户端接口（只声明DBHelper用到的部分）。
+// 实现见MysqlOffline.cpp：所有连接都失败，相当于数据库不可用时的离线模式。
+#ifndef TESTS_STUB_MYSQL_H
+#define TESTS_STUB_MYSQL_H
+
+#include <chrono>
+#include <thread>
+
+typedef struct MYSQL { int unused; } MYSQL;
+typedef struct MYSQL_RES { int unused; } MYSQL_RES;
+typedef char** MYSQL_ROW;
+typedef struct MYSQL_FIELD { char* name; } MYSQL_FIELD;
+typedef unsigned long long my_ulonglong;
+
+enum mysql_option { MYSQL_OPT_CONNECT_TIMEOUT, MYSQL_OPT_SSL_CA };
+
+MYSQL* mysql_init(MYSQL* mysql);
+int mysql_options(MYSQL* mysql, mysql_option option, const void* arg);
+MYSQL* mysql_real_connect(MYSQL* mysql, const char* host, const char* user, const char* passwd,
+    const char* db, unsigned int port, const char* unixSocket, unsigned long clientFlag);
+unsigned int mysql_errno(MYSQL* mysql);
+const char* mysql_error(MYSQL* mysql);
+int mysql_set_character_set(MYSQL* mysql, const char* charset);
+bool mysql_autocommit(MYSQL* mysql, bool mode);
+void mysql_close(MYSQL* mysql);
+int mysql_query(MYSQL* mysql, const char* query);
+my_ulonglong mysql_affected_rows(MYSQL* mysql);
+my_ulonglong mysql_insert_id(MYSQL* mysql);
+bool mysql_commit(MYSQL* mysql);
+bool mysql_rollback(MYSQL* mysql);
+MYSQL_RES* mysql_store_result(MYSQL* mysql);
+MYSQL_RES* mysql_use_result(MYSQL* mysql);
+unsigned int mysql_field_count(MYSQL* mysql);
+unsigned int mysql_num_fields(MYSQL_RES* result);
+MYSQL_FIELD* mysql_fetch_fields(MYSQL_RES* result);
+MYSQL_ROW mysql_fetch_row(MYSQL_RES* result);
+unsigned long* mysql_fetch_lengths(MYSQL_RES* result);
+my_ulonglong mysql_num_rows(MYSQL_RES* result);
+void mysql_free_result(MYSQL_RES* result);
+
+// Windows下由mysql.h间接引入
+inline void Sleep(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+#endif // TESTS_STUB_MYSQL_H